@@ -0,0 +1,54 @@
+#pragma once
+#include <Arduino.h>
+
+// Hardware layer: the RP2040 pieces the firmware needs beyond the Arduino API.
+//   hal_rp2040.cpp  Pico (pico-sdk, pico-bidir-dshot, linker flash region)
+//   lib/host        PlatformIO "native" env: same calls on a virtual clock
+// Clock, serial, GPIO and I2C keep their Arduino names (millis/micros, Serial, pinMode /
+// digitalRead / attachInterrupt, Wire): on the host lib/host supplies those too, so
+// modules stay unchanged and only talk to hal:: for what Arduino does not cover.
+namespace hal {
+
+// --- interrupts (short critical sections against the send alarm) ---
+uint32_t irqSave();
+void irqRestore(uint32_t saved);
+
+// --- repeating alarm: fn(arg) every period_us at a fixed rate (start to start) ---
+// returns a handle, -1 if no alarm is free; fn returns false to stop
+typedef bool (*AlarmFn)(void* arg);
+int alarmStart(uint32_t period_us, AlarmFn fn, void* arg);
+void alarmStop(int h);
+
+// --- bidirectional DShot, one output per pin ---
+enum DshotTel : uint8_t {
+  DSHOT_TEL_NONE = 0,   // no reply
+  DSHOT_TEL_CRC,        // reply failed its checksum
+  DSHOT_TEL_ERPM,       // value = eRPM
+  DSHOT_TEL_TEMP,       // EDT temperature, value = deg C
+  DSHOT_TEL_OTHER,      // other EDT frame (voltage, current, debug, status)
+};
+int dshotOpen(uint8_t pin, uint16_t speed);        // DShot150/300/600; handle, -1 on failure
+void dshotSend(int h, uint16_t value);             // 0 = motor stop, 1..2000 throttle
+void dshotCommand(int h, uint8_t cmd);             // special command 1..47, telemetry bit set
+DshotTel dshotTelemetry(int h, uint32_t* value);   // reply to the last send
+
+// --- flash region reserved for the key/value store (board_build.filesystem_size) ---
+static constexpr uint32_t FLASH_SECTOR = 4096;   // erase unit
+static constexpr uint32_t FLASH_PAGE = 256;      // program unit
+uint32_t flashSize();                            // bytes, 0 = no region
+const uint8_t* flashData();                      // memory-mapped read access
+// offsets are relative to the region; both stall XIP and interrupts on the Pico
+void flashErase(uint32_t off, uint32_t len);     // sector aligned
+void flashProgram(uint32_t off, const uint8_t* data, uint32_t len);   // page aligned
+
+// --- watchdog ---
+void wdtBegin(uint32_t timeout_ms);
+void wdtFeed();
+bool wdtCausedReboot();
+
+// --- benchmark clock (BENCH): free running, ns ---
+// Pico: the 1 MHz system timer (1 us steps); host: the monotonic wall clock, as the virtual
+// clock only moves when something advances it
+uint64_t benchClockNs();
+
+}  // namespace hal
@@ -0,0 +1,9 @@
+#pragma once
+
+// Host log replay (native build, src/replay.cpp): streams a recorded session back through the
+// firmware's frame code, prints the regenerated CSV lines on Serial (stdout) and a per-column
+// diff against the recording on stderr.
+//   path: monitor .csv (with header) or raw .txt capture (CSV + RPMSTREAM lines, "hh:mm:ss.mmm >"
+//   prefixes allowed)
+// Returns 0 = no differences, 1 = differences, 2 = unreadable / no frames.
+int replayRun(const char* path);
@@ -0,0 +1,13 @@
+#pragma once
+#include <Arduino.h>
+
+// Legacy EEPROM emulation: always blank on the host (nothing for CalStorage to migrate).
+class EEPROMClass {
+public:
+  void begin(size_t) {}
+  uint8_t read(int) { return 0xFF; }
+  void write(int, uint8_t) {}
+  bool commit() { return true; }
+  bool end() { return true; }
+};
+extern EEPROMClass EEPROM;
@@ -0,0 +1,32 @@
+#pragma once
+#include <Arduino.h>
+
+// Host I2C bus: transactions go to the device attached at the address (host.h), anything else
+// NACKs like an empty bus.
+class TwoWire {
+public:
+  void begin() {}
+  void end() {}
+  void setClock(uint32_t) {}
+  void setTimeout(uint32_t, bool = false) {}
+
+  void beginTransmission(uint8_t addr);
+  size_t write(uint8_t b);
+  size_t write(const uint8_t* buf, size_t n);
+  uint8_t endTransmission(bool stop = true);   // 0 = ACK, 2 = address NACK
+
+  size_t requestFrom(uint8_t addr, size_t n, bool stop);
+  size_t requestFrom(uint8_t addr, size_t n) { return requestFrom(addr, n, true); }
+  int available() { return (int)(rx_len_ - rx_pos_); }
+  int read() { return (rx_pos_ < rx_len_) ? rx_[rx_pos_++] : -1; }
+
+private:
+  static constexpr size_t BUF = 32;
+  uint8_t addr_ = 0;
+  uint8_t tx_[BUF]{};
+  size_t tx_len_ = 0;
+  uint8_t rx_[BUF]{};
+  size_t rx_len_ = 0;
+  size_t rx_pos_ = 0;
+};
+extern TwoWire Wire;
@@ -0,0 +1,395 @@
+#include "host.h"
+#include <Wire.h>
+#include <EEPROM.h>
+#include <time.h>
+
+SerialHost Serial;
+TwoWire Wire;
+EEPROMClass EEPROM;
+
+static constexpr uint8_t PINS = 30;   // RP2040 GPIO count
+
+// ---------------- clock + alarms ----------------
+
+struct HostAlarm {
+  hal::AlarmFn fn;
+  void* arg;
+  uint32_t period_us;
+  uint64_t due_us;
+  bool on;
+};
+static constexpr uint8_t ALARMS_MAX = 2;
+static HostAlarm alarms[ALARMS_MAX];
+
+static uint64_t now_us = 0;
+static uint32_t irq_masked = 0;   // nesting depth
+static bool in_alarm = false;
+
+static uint32_t wdt_timeout_ms = 0;
+static uint64_t wdt_fed_us = 0;
+
+// earliest alarm due at or before t, nullptr if none
+static HostAlarm* nextAlarm(uint64_t t) {
+  HostAlarm* next = nullptr;
+  for (uint8_t i = 0; i < ALARMS_MAX; i++) {
+    HostAlarm& a = alarms[i];
+    if (a.on && a.due_us <= t && (!next || a.due_us < next->due_us)) next = &a;
+  }
+  return next;
+}
+
+static void fire(HostAlarm* a) {
+  in_alarm = true;
+  a->due_us += a->period_us;   // fixed rate, start to start
+  if (!a->fn(a->arg)) a->on = false;
+  in_alarm = false;
+}
+
+// alarms held back by a masked section run late, at the current time (like the hardware)
+static void runAlarms() {
+  if (irq_masked || in_alarm) return;
+  while (HostAlarm* a = nextAlarm(now_us)) fire(a);
+}
+
+static void checkWatchdog() {
+  if (!wdt_timeout_ms || now_us - wdt_fed_us <= (uint64_t)wdt_timeout_ms * 1000ULL) return;
+  fflush(stdout);
+  fprintf(stderr, "HOST watchdog reset at t=%.3f s\n", (double)now_us * 1e-6);
+  exit(HOST_EXIT_WATCHDOG);
+}
+
+uint64_t hostNowUs() { return now_us; }
+
+void hostAdvanceUs(uint64_t us) {
+  runAlarms();
+  const uint64_t end = now_us + us;
+  // step to each due alarm so it runs on time, as the timer IRQ would preempt
+  if (!irq_masked && !in_alarm) {
+    while (HostAlarm* a = nextAlarm(end)) {
+      if (a->due_us > now_us) now_us = a->due_us;
+      checkWatchdog();
+      fire(a);
+    }
+  }
+  if (now_us < end) now_us = end;   // alarm callbacks read the clock too
+  checkWatchdog();
+}
+
+unsigned long micros() {
+  hostAdvanceUs(HOST_CLOCK_READ_US);
+  return (unsigned long)(uint32_t)now_us;
+}
+
+unsigned long millis() {
+  hostAdvanceUs(HOST_CLOCK_READ_US);
+  return (unsigned long)(uint32_t)(now_us / 1000ULL);
+}
+
+void delay(unsigned long ms) { hostAdvanceUs((uint64_t)ms * 1000ULL); }
+void delayMicroseconds(unsigned int us) { hostAdvanceUs(us); }
+void yield() {}
+
+void noInterrupts() { irq_masked++; }
+
+void interrupts() {
+  if (irq_masked) irq_masked--;
+  runAlarms();
+}
+
+namespace hal {
+
+uint32_t irqSave() {
+  noInterrupts();
+  return 0;
+}
+
+void irqRestore(uint32_t) { interrupts(); }
+
+int alarmStart(uint32_t period_us, AlarmFn fn, void* arg) {
+  if (period_us == 0) return -1;
+  for (uint8_t i = 0; i < ALARMS_MAX; i++) {
+    HostAlarm& a = alarms[i];
+    if (a.on) continue;
+    a.fn = fn;
+    a.arg = arg;
+    a.period_us = period_us;
+    a.due_us = now_us + period_us;
+    a.on = true;
+    return i;
+  }
+  return -1;
+}
+
+void alarmStop(int h) {
+  if (h >= 0 && h < ALARMS_MAX) alarms[h].on = false;
+}
+
+void wdtBegin(uint32_t timeout_ms) {
+  wdt_timeout_ms = timeout_ms;
+  wdt_fed_us = now_us;
+}
+
+void wdtFeed() { wdt_fed_us = now_us; }
+bool wdtCausedReboot() { return false; }
+
+uint64_t benchClockNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+}  // namespace hal
+
+// ---------------- GPIO ----------------
+
+static HostPin* pin_dev[PINS];
+static uint8_t pin_level[PINS];
+static void (*pin_isr[PINS])();
+static int pin_isr_mode[PINS];
+
+static void pinInit() {
+  static bool done = false;
+  if (done) return;
+  // inputs with nothing attached idle high (an absent HX711 never reports data ready)
+  memset(pin_level, HIGH, sizeof(pin_level));
+  done = true;
+}
+
+void pinMode(uint8_t, uint8_t) { pinInit(); }
+
+int digitalRead(uint8_t pin) {
+  pinInit();
+  if (pin >= PINS) return LOW;
+  return pin_dev[pin] ? pin_dev[pin]->read(pin) : pin_level[pin];
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+  pinInit();
+  if (pin >= PINS) return;
+  pin_level[pin] = level ? HIGH : LOW;
+  if (pin_dev[pin]) pin_dev[pin]->write(pin, pin_level[pin]);
+}
+
+void attachInterrupt(uint8_t pin, void (*fn)(), int mode) {
+  if (pin >= PINS) return;
+  pin_isr[pin] = fn;
+  pin_isr_mode[pin] = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin < PINS) pin_isr[pin] = nullptr;
+}
+
+void hostPinAttach(uint8_t pin, HostPin* dev) {
+  if (pin < PINS) pin_dev[pin] = dev;
+}
+
+void hostPinSet(uint8_t pin, int level) {
+  pinInit();
+  if (pin >= PINS) return;
+  const uint8_t old = pin_level[pin];
+  pin_level[pin] = level ? HIGH : LOW;
+  if (!pin_isr[pin] || old == pin_level[pin]) return;
+  const int m = pin_isr_mode[pin];
+  if (m == CHANGE || (m == FALLING && !pin_level[pin]) || (m == RISING && pin_level[pin])) pin_isr[pin]();
+}
+
+// ---------------- I2C ----------------
+
+static HostI2c* i2c_dev[128];
+
+void hostI2cAttach(uint8_t addr, HostI2c* dev) { i2c_dev[addr & 0x7F] = dev; }
+HostI2c* hostI2cDevice(uint8_t addr) { return i2c_dev[addr & 0x7F]; }
+
+void TwoWire::beginTransmission(uint8_t addr) {
+  addr_ = addr;
+  tx_len_ = 0;
+}
+
+size_t TwoWire::write(uint8_t b) {
+  if (tx_len_ >= BUF) return 0;
+  tx_[tx_len_++] = b;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* buf, size_t n) {
+  size_t k = 0;
+  while (k < n && write(buf[k])) k++;
+  return k;
+}
+
+uint8_t TwoWire::endTransmission(bool) {
+  HostI2c* d = hostI2cDevice(addr_);
+  if (!d) return 2;
+  d->write(tx_, tx_len_);
+  return 0;
+}
+
+size_t TwoWire::requestFrom(uint8_t addr, size_t n, bool) {
+  rx_len_ = 0;
+  rx_pos_ = 0;
+  HostI2c* d = hostI2cDevice(addr);
+  if (!d) return 0;
+  if (n > BUF) n = BUF;
+  rx_len_ = d->read(rx_, n);
+  return rx_len_;
+}
+
+// ---------------- DShot ----------------
+
+struct HostDshotOut {
+  uint8_t pin;
+  uint16_t last;
+};
+static HostDshotOut dshot_out[8];
+static uint8_t ndshot = 0;
+static HostEsc* esc_dev[PINS];
+
+void hostEscAttach(uint8_t pin, HostEsc* esc) {
+  if (pin < PINS) esc_dev[pin] = esc;
+}
+
+uint16_t hostEscLastValue(uint8_t pin) {
+  for (uint8_t i = 0; i < ndshot; i++) {
+    if (dshot_out[i].pin == pin) return dshot_out[i].last;
+  }
+  return 0;
+}
+
+namespace hal {
+
+int dshotOpen(uint8_t pin, uint16_t) {
+  if (pin >= PINS || ndshot >= sizeof(dshot_out) / sizeof(dshot_out[0])) return -1;
+  dshot_out[ndshot] = HostDshotOut{ pin, 0 };
+  return ndshot++;
+}
+
+void dshotSend(int h, uint16_t value) {
+  HostDshotOut& o = dshot_out[h];
+  o.last = value;
+  if (esc_dev[o.pin]) esc_dev[o.pin]->send(value);
+}
+
+void dshotCommand(int h, uint8_t cmd) {
+  HostDshotOut& o = dshot_out[h];
+  o.last = 0;   // a command frame carries no throttle
+  if (esc_dev[o.pin]) esc_dev[o.pin]->command(cmd);
+}
+
+DshotTel dshotTelemetry(int h, uint32_t* value) {
+  HostEsc* e = esc_dev[dshot_out[h].pin];
+  if (!e) return DSHOT_TEL_NONE;
+  return e->telemetry(value);
+}
+
+}  // namespace hal
+
+// ---------------- flash ----------------
+
+static uint8_t flash[HOST_FLASH_SIZE];
+static bool flash_init = false;
+
+static void flashInit() {
+  if (flash_init) return;
+  memset(flash, 0xFF, sizeof(flash));
+  flash_init = true;
+}
+
+bool hostFlashLoad(const char* path) {
+  flashInit();
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  const size_t n = fread(flash, 1, sizeof(flash), f);
+  fclose(f);
+  return n == sizeof(flash);
+}
+
+bool hostFlashSave(const char* path) {
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+  flashInit();
+  const size_t n = fwrite(flash, 1, sizeof(flash), f);
+  fclose(f);
+  return n == sizeof(flash);
+}
+
+namespace hal {
+
+uint32_t flashSize() { return HOST_FLASH_SIZE; }
+
+const uint8_t* flashData() {
+  flashInit();
+  return flash;
+}
+
+void flashErase(uint32_t off, uint32_t len) {
+  flashInit();
+  if (off % FLASH_SECTOR || len % FLASH_SECTOR || off + len > HOST_FLASH_SIZE) return;
+  memset(flash + off, 0xFF, len);
+}
+
+void flashProgram(uint32_t off, const uint8_t* data, uint32_t len) {
+  flashInit();
+  if (off % FLASH_PAGE || len % FLASH_PAGE || off + len > HOST_FLASH_SIZE) return;
+  // NOR flash: programming only clears bits
+  for (uint32_t i = 0; i < len; i++) flash[off + i] &= data[i];
+}
+
+}  // namespace hal
+
+// ---------------- Print / Serial ----------------
+
+size_t Print::write(const uint8_t* buf, size_t n) {
+  size_t k = 0;
+  while (k < n && write(buf[k])) k++;
+  return k;
+}
+
+static size_t printUnsigned(Print& p, unsigned long long v, int base) {
+  if (base < 2) base = DEC;
+  char buf[66];
+  char* s = buf + sizeof(buf) - 1;
+  *s = '\0';
+  do {
+    const unsigned d = (unsigned)(v % (unsigned)base);
+    *--s = (char)(d < 10 ? '0' + d : 'A' + d - 10);
+    v /= (unsigned)base;
+  } while (v);
+  return p.write(s);
+}
+
+size_t Print::print(long v, int base) { return print((long long)v, base); }
+size_t Print::print(unsigned long v, int base) { return printUnsigned(*this, v, base); }
+size_t Print::print(unsigned long long v, int base) { return printUnsigned(*this, v, base); }
+
+size_t Print::print(long long v, int base) {
+  // like the Arduino core: only base 10 is signed
+  if (base != DEC || v >= 0) return printUnsigned(*this, (unsigned long long)v, base);
+  return write('-') + printUnsigned(*this, 0ULL - (unsigned long long)v, base);
+}
+
+size_t Print::print(double v, int digits) {
+  if (isnan(v)) return write("nan");
+  if (isinf(v)) return write("inf");
+  if (digits < 0) digits = 2;
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", digits, v);
+  return write(buf);
+}
+
+static std::string rx;
+static size_t rx_pos = 0;
+
+void hostSerialFeed(const char* data, size_t n) {
+  if (rx_pos == rx.size()) { rx.clear(); rx_pos = 0; }
+  rx.append(data, n);
+}
+
+size_t hostSerialPending() { return rx.size() - rx_pos; }
+
+int SerialHost::available() { return (int)hostSerialPending(); }
+int SerialHost::read() { return (rx_pos < rx.size()) ? (uint8_t)rx[rx_pos++] : -1; }
+int SerialHost::peek() { return (rx_pos < rx.size()) ? (uint8_t)rx[rx_pos] : -1; }
+void SerialHost::flush() { fflush(stdout); }
+size_t SerialHost::write(uint8_t c) { return (fputc(c, stdout) == EOF) ? 0 : 1; }
+size_t SerialHost::write(const uint8_t* buf, size_t n) { return fwrite(buf, 1, n, stdout); }
@@ -0,0 +1,58 @@
+#pragma once
+#include <Arduino.h>
+#include "hal.h"
+
+// Host runtime behind lib/host: the virtual clock plus hooks a simulated rig plugs into.
+//
+// Time only moves when something advances it: host_main.cpp after every loop() pass, delay(),
+// delayMicroseconds(), and every clock read (HOST_CLOCK_READ_US, so busy-wait loops end).
+// Due alarms (the ESC send alarm) run inside those advances unless interrupts are masked, in
+// which case they run at the matching interrupts() / hal::irqRestore(). Same input, same
+// output: runs are fully deterministic.
+
+static constexpr uint32_t HOST_CLOCK_READ_US = 1;
+static constexpr uint32_t HOST_FLASH_SIZE = 64 * 1024;   // = board_build.filesystem_size
+
+// --- clock ---
+uint64_t hostNowUs();
+void hostAdvanceUs(uint64_t us);
+
+// --- serial: bytes the firmware reads next ---
+void hostSerialFeed(const char* data, size_t n);
+size_t hostSerialPending();
+
+// --- GPIO: a device on a pin answers digitalRead() and sees digitalWrite() ---
+struct HostPin {
+  virtual ~HostPin() {}
+  virtual int read(uint8_t pin) = 0;
+  virtual void write(uint8_t pin, int level) { (void)pin; (void)level; }
+};
+void hostPinAttach(uint8_t pin, HostPin* dev);
+// drive an input with no device attached (fires attachInterrupt() handlers on edges)
+void hostPinSet(uint8_t pin, int level);
+
+// --- I2C: register-level device at a 7-bit address ---
+struct HostI2c {
+  virtual ~HostI2c() {}
+  virtual void write(const uint8_t* data, size_t n) = 0;   // one transmission
+  virtual size_t read(uint8_t* data, size_t n) = 0;        // one requestFrom()
+};
+void hostI2cAttach(uint8_t addr, HostI2c* dev);
+HostI2c* hostI2cDevice(uint8_t addr);
+
+// --- DShot: the ESC behind an output (none attached = no telemetry replies) ---
+struct HostEsc {
+  virtual ~HostEsc() {}
+  virtual void send(uint16_t value) = 0;
+  virtual void command(uint8_t cmd) { (void)cmd; }   // DShot special command frame
+  virtual hal::DshotTel telemetry(uint32_t* value) = 0;
+};
+void hostEscAttach(uint8_t pin, HostEsc* esc);
+uint16_t hostEscLastValue(uint8_t pin);   // last DShot value sent on the pin
+
+// --- flash image: optional file kept across runs (like the real store across reboots) ---
+bool hostFlashLoad(const char* path);
+bool hostFlashSave(const char* path);
+
+// --- watchdog: expiry ends the run (exit code HOST_EXIT_WATCHDOG) ---
+static constexpr int HOST_EXIT_WATCHDOG = 3;
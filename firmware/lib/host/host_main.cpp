@@ -0,0 +1,149 @@
+// Host entry point: runs the firmware's setup() / loop() on the virtual clock.
+//
+//   rotorrig [-t seconds] [-l loop_us] [-f flash.bin] [-r] [-s | -p rig.txt] [-S seed] < commands.txt
+//
+// -s attaches the simulated rig (rig.h) with its default parameters, -p with parameters from a
+// file; -S seeds its noise.
+//
+//   rotorrig -R session.csv > regenerated.csv
+//
+// -R replays a recorded log instead of running the firmware (replay.h): regenerated CSV on
+// stdout, the diff against the recording on stderr, exit code 1 if they differ.
+//
+//   rotorrig -B all [-n reps] > bench.csv
+//
+// -B runs the BENCH microbenchmarks (bench.h; a case name or prefix instead of "all") on the
+// wall clock and exits, -n sets the timed batches per case.
+// stdin lines are the serial console; "~wait <s>" holds the rest of the input back for s
+// virtual seconds. The run ends at -t, or 2 s after the input ends when -t is not given.
+#include "host.h"
+#include "rig.h"
+#include "replay.h"
+#include "bench.h"
+#include "cli.h"
+#include "cfg.h"
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+
+void setup();
+void loop();
+
+static constexpr uint32_t LOOP_US_DEFAULT = 200;   // virtual time per loop() pass
+static constexpr double LINGER_S = 2.0;            // after end of input (no -t)
+
+static uint64_t hold_until_us = 0;   // "~wait" in progress
+static bool in_eof = false;
+static std::string in_line;
+
+// One stdin line: host directive or serial input.
+static void inputLine(const std::string& l) {
+  if (l.compare(0, 5, "~wait") == 0) {
+    const double s = atof(l.c_str() + 5);
+    if (s > 0.0) hold_until_us = hostNowUs() + (uint64_t)(s * 1e6);
+    return;
+  }
+  hostSerialFeed(l.data(), l.size());
+  hostSerialFeed("\n", 1);
+}
+
+// Pull stdin without blocking; a file or pipe gives the same lines at the same virtual times.
+static void pollInput() {
+  while (!in_eof && hostNowUs() >= hold_until_us) {
+    pollfd p{ STDIN_FILENO, POLLIN, 0 };
+    if (poll(&p, 1, 0) <= 0) return;
+    char c;
+    const ssize_t n = read(STDIN_FILENO, &c, 1);
+    if (n <= 0) { in_eof = true; return; }
+    if (c == '\r') continue;
+    if (c != '\n') { in_line += c; continue; }
+    inputLine(in_line);
+    in_line.clear();
+  }
+}
+
+static double wallS() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char** argv) {
+  double run_s = 0.0;
+  uint32_t loop_us = LOOP_US_DEFAULT;
+  const char* flash_path = nullptr;
+  bool realtime = false;
+  bool sim = false;
+  HostRigParams rig;
+  uint64_t seed = 1;
+  const char* bench = nullptr;
+  long bench_reps = BENCH_REPS_DEFAULT;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "t:l:f:rsp:S:R:B:n:")) != -1) {
+    switch (opt) {
+      case 't': run_s = atof(optarg); break;
+      case 'l': loop_us = (uint32_t)atol(optarg); break;
+      case 'f': flash_path = optarg; break;
+      case 'r': realtime = true; break;
+      case 's': sim = true; break;
+      case 'p':
+        if (!hostRigLoad(rig, optarg)) return 2;
+        sim = true;
+        break;
+      case 'S': seed = strtoull(optarg, nullptr, 0); break;
+      case 'R': return replayRun(optarg);
+      case 'B': bench = optarg; break;
+      case 'n': bench_reps = atol(optarg); break;
+      default:
+        fprintf(stderr, "usage: %s [-t seconds] [-l loop_us] [-f flash.bin] [-r] [-s | -p rig.txt] [-S seed]\n"
+                        "       %s -R session.csv\n"
+                        "       %s -B <case|all> [-n reps]\n", argv[0], argv[0], argv[0]);
+        return 2;
+    }
+  }
+  if (bench) {
+    if (bench_reps < 1 || bench_reps > BENCH_REPS_MAX) {
+      fprintf(stderr, "-n: 1..%u\n", (unsigned)BENCH_REPS_MAX);
+      return 2;
+    }
+    static CLI cli;   // unbound: cli_get answers from its null-safe query paths
+    const uint8_t cases = benchRun(bench, (uint8_t)bench_reps, cli);
+    fflush(stdout);
+    if (cases == 0) {
+      fprintf(stderr, "no benchmark case matches \"%s\"; cases:", bench);
+      for (uint8_t i = 0; benchCaseName(i); i++) fprintf(stderr, " %s", benchCaseName(i));
+      fprintf(stderr, "\n");
+      return 2;
+    }
+    return 0;
+  }
+  if (flash_path) hostFlashLoad(flash_path);
+  if (sim) hostRigAttach(rig, seed);
+
+  const double wall0 = wallS();
+  setup();
+
+  uint64_t end_us = run_s > 0.0 ? (uint64_t)(run_s * 1e6) : 0;
+  for (;;) {
+    pollInput();
+    loop();
+    hostAdvanceUs(loop_us);
+
+    if (!end_us && in_eof && hostSerialPending() == 0) end_us = hostNowUs() + (uint64_t)(LINGER_S * 1e6);
+    if (end_us && hostNowUs() >= end_us) break;
+
+    // -r: pace the virtual clock to the wall clock (interactive use)
+    if (realtime) {
+      const double ahead = (double)hostNowUs() * 1e-6 - (wallS() - wall0);
+      if (ahead > 0.001) usleep((useconds_t)(ahead * 1e6));
+    }
+  }
+
+  fflush(stdout);
+  if (flash_path && !hostFlashSave(flash_path)) {
+    fprintf(stderr, "HOST cannot write %s\n", flash_path);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,632 @@
+#include "rig.h"
+#include <stddef.h>
+
+namespace {
+
+// xorshift64* + Box-Muller: cheap and the same on every host
+class Rng {
+public:
+  explicit Rng(uint64_t seed) : s_(seed ? seed : 0x9E3779B97F4A7C15ULL) {}
+
+  double uniform() {   // [0, 1)
+    s_ ^= s_ >> 12;
+    s_ ^= s_ << 25;
+    s_ ^= s_ >> 27;
+    return (double)((s_ * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  double gauss() {
+    if (have_spare_) {
+      have_spare_ = false;
+      return spare_;
+    }
+    double u = uniform();
+    if (u < 1e-300) u = 1e-300;
+    const double r = sqrt(-2.0 * log(u));
+    const double a = 2.0 * M_PI * uniform();
+    spare_ = r * sin(a);
+    have_spare_ = true;
+    return r * cos(a);
+  }
+
+private:
+  uint64_t s_;
+  double spare_ = 0.0;
+  bool have_spare_ = false;
+};
+
+static constexpr double RAD_S_PER_RPM = 2.0 * M_PI / 60.0;
+
+// DShot command 13 turns EDT on once it arrives 6 times in a row (the ESC's side of cfg.h)
+static constexpr uint8_t ESC_CMD_EDT_ENABLE = 13;
+static constexpr uint8_t ESC_CMD_REPEAT = 6;
+
+// BDShot eRPM reply: period in µs as 9-bit mantissa << 3-bit exponent (the ESC truncates)
+static uint32_t erpmQuantise(double erpm) {
+  if (erpm < 1.0) return 0;
+  uint32_t period = (uint32_t)(60e6 / erpm);
+  uint8_t e = 0;
+  while (period > 0x1FF && e < 7) {
+    period >>= 1;
+    e++;
+  }
+  if (period > 0x1FF || period == 0) return 0;   // slower than the code reaches: "stopped"
+  return (uint32_t)lround(60e6 / (double)(period << e));
+}
+
+static int32_t clampi(double v, int32_t lo, int32_t hi) {
+  if (!(v > lo)) return lo;   // also NaN
+  if (v > hi) return hi;
+  return (int32_t)lround(v);
+}
+
+struct Motor {
+  uint16_t dshot = 0;       // last throttle value (0 = stop, 1..2000)
+  double w = 0.0;           // rad/s
+  double i_m = 0.0;         // motor current, A
+  double esc_temp_c = 0.0;
+  uint32_t replies = 0;
+  uint8_t edt_cmds = 0;     // EDT-enable frames in a row
+  bool edt_on = false;      // EDT enabled: temperature frames mixed into the replies
+  hal::DshotTel tel = hal::DSHOT_TEL_NONE;   // reply to the last send, read once
+  uint32_t tel_value = 0;
+};
+
+class Rig;
+
+class SimEsc : public HostEsc {
+public:
+  void send(uint16_t value) override;
+  void command(uint8_t cmd) override;
+  hal::DshotTel telemetry(uint32_t* value) override;
+  Rig* rig = nullptr;
+  uint8_t m = 0;
+};
+
+class SimHx711 : public HostPin {
+public:
+  int read(uint8_t pin) override;
+  void write(uint8_t pin, int level) override;
+  Rig* rig = nullptr;
+  uint8_t sck = 0;
+};
+
+class SimIna226 : public HostI2c {
+public:
+  void write(const uint8_t* data, size_t n) override;
+  size_t read(uint8_t* data, size_t n) override;
+  Rig* rig = nullptr;
+};
+
+class Rig {
+public:
+  Rig(const HostRigParams& p, uint64_t seed);
+  void advance();   // physics + conversions up to hostNowUs()
+
+  // ESC
+  void escSend(uint8_t m, uint16_t value);
+  void escCommand(uint8_t m, uint8_t cmd);
+  hal::DshotTel escTelemetry(uint8_t m, uint32_t* value);
+
+  // HX711
+  int hxDout();
+  void hxSck(int level);
+
+  // INA226
+  void inaWrite(const uint8_t* data, size_t n);
+  size_t inaRead(uint8_t* data, size_t n);
+
+private:
+  void step();
+  double duty(const Motor& mo) const;
+  void escReply(Motor& mo);
+
+  void hxLatch();
+  void hxWake();
+
+  void inaReset();
+  void inaRestart();
+  uint32_t inaCycleUs() const;
+  void inaLatch();
+  void inaAlertUpdate(bool conversion);
+
+  HostRigParams p_;
+  Rng rng_;
+  uint64_t t_us_ = 0;       // physics time, RIG_STEP_US grid
+  uint8_t nm_ = 1;
+
+  // derived constants
+  double ke_ = 0.0;         // V/(rad/s) = Nm/A
+  double ct_ = 0.0;         // g/rpm^2
+  double cq_ = 0.0;         // Nm/rpm^2
+
+  Motor mo_[RIG_MOTORS_MAX];
+  SimEsc esc_[RIG_MOTORS_MAX];
+  double soc_ = 1.0;        // battery charge, fraction
+  double v_bus_ = 0.0;
+  double i_bat_ = 0.0;
+  double thrust_g_ = 0.0;
+  double rpm_sum_sq_ = 0.0; // sum of (rpm/1000)^2 over motors (vibration)
+
+  // HX711: continuous conversions, readout by SCK pulses
+  SimHx711 hx_;
+  uint32_t hx_period_us_ = 12500;
+  uint64_t hx_due_us_ = 0;
+  double hx_acc_ = 0.0;
+  double hx_vib_acc_ = 0.0;
+  uint32_t hx_n_ = 0;
+  uint32_t hx_latched_ = 0;  // 24-bit two's complement
+  bool hx_ready_ = false;    // DOUT low: unread conversion
+  bool hx_shifting_ = false;
+  uint32_t hx_word_ = 0;
+  uint8_t hx_bit_ = 0;
+  uint8_t hx_out_ = 1;
+  bool hx_sck_ = false;
+  uint64_t hx_sck_high_us_ = 0;
+  bool hx_down_ = false;
+
+  // INA226: register file + conversion cycle
+  SimIna226 ina_;
+  uint8_t ina_ptr_ = 0;
+  uint16_t ina_cfg_ = 0, ina_cal_ = 0, ina_mask_ = 0, ina_limit_ = 0;
+  int16_t ina_shunt_ = 0;
+  uint16_t ina_bus_ = 0, ina_power_ = 0;
+  int16_t ina_current_ = 0;
+  bool ina_cvrf_ = false, ina_aff_ = false;
+  uint64_t ina_due_us_ = 0;
+  double ina_acc_i_ = 0.0, ina_acc_v_ = 0.0;
+  uint32_t ina_n_ = 0;
+};
+
+// ---------------- ESC + motor + supply ----------------
+
+Rig::Rig(const HostRigParams& p, uint64_t seed) : p_(p), rng_(seed) {
+  nm_ = (uint8_t)(p_.motors < 1 ? 1 : (p_.motors > RIG_MOTORS_MAX ? RIG_MOTORS_MAX : p_.motors));
+  ke_ = 60.0 / (2.0 * M_PI * p_.kv);
+  ct_ = p_.ct_g_per_krpm2 * 1e-6;
+  cq_ = p_.cq_nmm_per_krpm2 * 1e-9;
+  t_us_ = hostNowUs() / RIG_STEP_US * RIG_STEP_US;
+  v_bus_ = p_.supply_v;
+
+  const double pins[RIG_MOTORS_MAX] = { p_.pin_esc1, p_.pin_esc2, p_.pin_esc3, p_.pin_esc4 };
+  for (uint8_t m = 0; m < nm_; m++) {
+    mo_[m].esc_temp_c = p_.ambient_c;
+    esc_[m].rig = this;
+    esc_[m].m = m;
+    hostEscAttach((uint8_t)pins[m], &esc_[m]);
+  }
+
+  hx_.rig = this;
+  hx_.sck = (uint8_t)p_.pin_hx_sck;
+  hx_period_us_ = (uint32_t)lround(1e6 / p_.hx_sps);
+  hx_due_us_ = t_us_ + hx_period_us_;
+  hostPinAttach((uint8_t)p_.pin_hx_dout, &hx_);
+  hostPinAttach((uint8_t)p_.pin_hx_sck, &hx_);
+
+  ina_.rig = this;
+  inaReset();
+  hostI2cAttach((uint8_t)p_.ina_addr, &ina_);
+}
+
+void Rig::advance() {
+  const uint64_t now = hostNowUs();
+  while (t_us_ + RIG_STEP_US <= now) {
+    t_us_ += RIG_STEP_US;
+    step();
+  }
+  // SCK held high > 60 µs powers the HX711 down
+  if (hx_sck_ && !hx_down_ && now - hx_sck_high_us_ > 60) {
+    hx_down_ = true;
+    hx_ready_ = false;
+    hx_shifting_ = false;
+  }
+}
+
+double Rig::duty(const Motor& mo) const {
+  if (mo.dshot == 0) return 0.0;   // motor stop: outputs off, the motor coasts
+  const double x = (double)(mo.dshot > 2000 ? 2000 : mo.dshot) / 2000.0;
+  return p_.duty_min + (1.0 - p_.duty_min) * x;
+}
+
+void Rig::step() {
+  const double dt = (double)RIG_STEP_US * 1e-6;
+
+  // supply: open-circuit voltage minus source drop, solved with the motor currents
+  //   I_m = (d V - ke w) / R,  I_bat = sum(d I_m) + idle,  V = Voc - Rs I_bat
+  const double voc = p_.battery_mah > 0.0 ? p_.supply_v_empty + (p_.supply_v - p_.supply_v_empty) * soc_
+                                          : p_.supply_v;
+  double num = voc - p_.supply_r_ohm * p_.esc_idle_a;
+  double den = 1.0;
+  for (uint8_t m = 0; m < nm_; m++) {
+    const double d = duty(mo_[m]);
+    num += p_.supply_r_ohm * d * ke_ * mo_[m].w / p_.r_ohm;
+    den += p_.supply_r_ohm * d * d / p_.r_ohm;
+  }
+  const double v = num / den;
+
+  double i_bat = p_.esc_idle_a;
+  double thrust = 0.0;
+  double rpm_sq = 0.0;
+  for (uint8_t m = 0; m < nm_; m++) {
+    Motor& mo = mo_[m];
+    const double d = duty(mo);
+    mo.i_m = d > 0.0 ? (d * v - ke_ * mo.w) / p_.r_ohm : 0.0;
+    i_bat += d * mo.i_m;
+
+    // J dw/dt = Kt I - friction - prop torque; friction holds a stopped rotor
+    const double rpm = mo.w / RAD_S_PER_RPM;
+    const double drive = ke_ * mo.i_m;
+    const double fric = ke_ * p_.i0_a;
+    const double load = cq_ * rpm * rpm;
+    if (mo.w > 0.0 || drive > fric) {
+      mo.w += dt * (drive - fric - load) / p_.inertia_kgm2;
+      if (mo.w < 0.0) mo.w = 0.0;
+    }
+
+    const double loss = mo.i_m * mo.i_m * p_.esc_r_ohm;
+    mo.esc_temp_c += dt * (loss - (mo.esc_temp_c - p_.ambient_c) / p_.esc_rth_k_per_w) / p_.esc_cth_j_per_k;
+
+    const double rpm_new = mo.w / RAD_S_PER_RPM;
+    thrust += ct_ * rpm_new * rpm_new;
+    rpm_sq += (rpm_new * 1e-3) * (rpm_new * 1e-3);
+  }
+
+  if (p_.battery_mah > 0.0) {
+    soc_ -= i_bat * dt / 3.6 / p_.battery_mah;
+    if (soc_ < 0.0) soc_ = 0.0;
+    if (soc_ > 1.0) soc_ = 1.0;
+  }
+  v_bus_ = v;
+  i_bat_ = i_bat;
+  thrust_g_ = thrust;
+  rpm_sum_sq_ = rpm_sq;
+
+  // sensors integrate over their conversion windows
+  if (!hx_down_) {
+    hx_acc_ += thrust_g_;
+    hx_vib_acc_ += rpm_sum_sq_;
+    hx_n_++;
+    if (t_us_ >= hx_due_us_) {
+      hxLatch();
+      hx_due_us_ += hx_period_us_;
+    }
+  }
+  if (ina_due_us_) {
+    ina_acc_i_ += i_bat_;
+    ina_acc_v_ += v_bus_;
+    ina_n_++;
+    if (t_us_ >= ina_due_us_) inaLatch();
+  }
+}
+
+void Rig::escSend(uint8_t m, uint16_t value) {
+  advance();
+  Motor& mo = mo_[m];
+  mo.dshot = value;
+  mo.edt_cmds = 0;
+  escReply(mo);
+}
+
+void Rig::escCommand(uint8_t m, uint8_t cmd) {
+  advance();
+  Motor& mo = mo_[m];
+  mo.dshot = 0;   // commands only act on a stopped motor
+  if (cmd == ESC_CMD_EDT_ENABLE) {
+    if (++mo.edt_cmds >= ESC_CMD_REPEAT && p_.edt_every >= 1.0) mo.edt_on = true;
+  } else {
+    mo.edt_cmds = 0;
+  }
+  escReply(mo);
+}
+
+void Rig::escReply(Motor& mo) {
+  // the reply carries the state at this frame
+  const double u = rng_.uniform();
+  if (u < p_.tel_drop) {
+    mo.tel = hal::DSHOT_TEL_NONE;
+  } else if (u < p_.tel_drop + p_.tel_crc_err) {
+    mo.tel = hal::DSHOT_TEL_CRC;
+  } else if (mo.edt_on && ++mo.replies % (uint32_t)p_.edt_every == 0) {
+    mo.tel = hal::DSHOT_TEL_TEMP;
+    mo.tel_value = (uint32_t)clampi(mo.esc_temp_c, 0, 255);
+  } else {
+    const double erpm = mo.w / RAD_S_PER_RPM * p_.pole_pairs * (1.0 + p_.tel_jitter * rng_.gauss());
+    mo.tel = hal::DSHOT_TEL_ERPM;
+    mo.tel_value = erpmQuantise(erpm);
+  }
+}
+
+hal::DshotTel Rig::escTelemetry(uint8_t m, uint32_t* value) {
+  Motor& mo = mo_[m];
+  const hal::DshotTel t = mo.tel;
+  if (t != hal::DSHOT_TEL_NONE && value) *value = mo.tel_value;
+  mo.tel = hal::DSHOT_TEL_NONE;
+  return t;
+}
+
+void SimEsc::send(uint16_t value) { rig->escSend(m, value); }
+void SimEsc::command(uint8_t cmd) { rig->escCommand(m, cmd); }
+hal::DshotTel SimEsc::telemetry(uint32_t* value) { return rig->escTelemetry(m, value); }
+
+// ---------------- HX711 ----------------
+
+void Rig::hxLatch() {
+  const double n = hx_n_ ? (double)hx_n_ : 1.0;
+  const double vib = p_.hx_vib_g_per_krpm2 * hx_vib_acc_ / n;
+  const double g = hx_acc_ / n + vib * rng_.gauss();
+  const double counts = p_.hx_offset_counts + p_.hx_counts_per_g * g + p_.hx_noise_counts * rng_.gauss();
+  hx_latched_ = (uint32_t)clampi(counts, -0x800000, 0x7FFFFF) & 0xFFFFFF;
+  hx_ready_ = true;
+  hx_acc_ = 0.0;
+  hx_vib_acc_ = 0.0;
+  hx_n_ = 0;
+}
+
+// power-up: conversions restart and the first one is ready after the settling time
+void Rig::hxWake() {
+  hx_down_ = false;
+  hx_acc_ = 0.0;
+  hx_vib_acc_ = 0.0;
+  hx_n_ = 0;
+  hx_due_us_ = t_us_ + 4 * hx_period_us_;
+}
+
+int Rig::hxDout() {
+  advance();
+  if (hx_shifting_) return hx_out_;
+  return hx_ready_ ? LOW : HIGH;
+}
+
+void Rig::hxSck(int level) {
+  advance();
+  const bool high = level != LOW;
+  if (high && !hx_sck_) {
+    hx_sck_high_us_ = hostNowUs();
+    // rising edge: the next bit (MSB first) appears on DOUT; the 25th edge ends the readout
+    if (!hx_shifting_ && hx_ready_) {
+      hx_shifting_ = true;
+      hx_word_ = hx_latched_;
+      hx_bit_ = 0;
+      hx_out_ = (hx_word_ >> 23) & 1;
+    } else if (hx_shifting_) {
+      hx_bit_++;
+      if (hx_bit_ < 24) {
+        hx_out_ = (hx_word_ >> (23 - hx_bit_)) & 1;
+      } else {
+        hx_shifting_ = false;
+        hx_ready_ = false;
+      }
+    }
+  }
+  if (!high && hx_sck_ && hx_down_) hxWake();
+  hx_sck_ = high;
+}
+
+int SimHx711::read(uint8_t) { return rig->hxDout(); }
+
+void SimHx711::write(uint8_t pin, int level) {
+  // DOUT is an output of the HX711: only SCK writes matter
+  if (pin == sck) rig->hxSck(level);
+}
+
+// ---------------- INA226 ----------------
+
+static constexpr uint16_t INA_CFG_DEFAULT = 0x4127;
+static constexpr uint16_t INA_CT_US[8] = { 140, 204, 332, 588, 1100, 2116, 4156, 8244 };
+static constexpr uint16_t INA_AVG[8] = { 1, 4, 16, 64, 128, 256, 512, 1024 };
+
+enum : uint16_t {
+  INA_SOL = 0x8000, INA_SUL = 0x4000, INA_BOL = 0x2000, INA_BUL = 0x1000, INA_POL = 0x0800,
+  INA_CNVR = 0x0400, INA_AFF = 0x0010, INA_CVRF = 0x0008, INA_APOL = 0x0002, INA_LEN = 0x0001,
+};
+
+void Rig::inaReset() {
+  ina_cfg_ = INA_CFG_DEFAULT;
+  ina_cal_ = 0;
+  ina_mask_ = 0;
+  ina_limit_ = 0;
+  ina_shunt_ = 0;
+  ina_bus_ = 0;
+  ina_power_ = 0;
+  ina_current_ = 0;
+  ina_cvrf_ = false;
+  ina_aff_ = false;
+  inaRestart();
+  inaAlertUpdate(false);
+}
+
+uint32_t Rig::inaCycleUs() const {
+  const uint8_t mode = ina_cfg_ & 7;
+  const uint32_t sh = (mode & 1) ? INA_CT_US[(ina_cfg_ >> 3) & 7] : 0;
+  const uint32_t bus = (mode & 2) ? INA_CT_US[(ina_cfg_ >> 6) & 7] : 0;
+  return (sh + bus) * INA_AVG[(ina_cfg_ >> 9) & 7];
+}
+
+// a config write starts a new conversion cycle (modes 0 / 4 = power-down)
+void Rig::inaRestart() {
+  ina_acc_i_ = 0.0;
+  ina_acc_v_ = 0.0;
+  ina_n_ = 0;
+  const uint32_t cycle = inaCycleUs();
+  ina_due_us_ = cycle ? t_us_ + cycle : 0;
+}
+
+void Rig::inaLatch() {
+  const uint8_t mode = ina_cfg_ & 7;
+  const double n = ina_n_ ? (double)ina_n_ : 1.0;
+  const double avg_sqrt = sqrt((double)INA_AVG[(ina_cfg_ >> 9) & 7]);
+  if (mode & 1) {
+    const double lsb = ina_acc_i_ / n * p_.shunt_ohm / 2.5e-6;
+    ina_shunt_ = (int16_t)clampi(lsb + p_.ina_noise_shunt_lsb / avg_sqrt * rng_.gauss(), -32768, 32767);
+  }
+  if (mode & 2) {
+    const double lsb = ina_acc_v_ / n / 1.25e-3;
+    ina_bus_ = (uint16_t)clampi(lsb + p_.ina_noise_bus_lsb / avg_sqrt * rng_.gauss(), 0, 0x7FFF);
+  }
+  // current / power registers follow the calibration register (datasheet eq. 3 / 4)
+  ina_current_ = (int16_t)clampi((double)ina_shunt_ * ina_cal_ / 2048.0, -32768, 32767);
+  ina_power_ = (uint16_t)clampi(fabs((double)ina_current_) * ina_bus_ / 20000.0, 0, 0xFFFF);
+  ina_cvrf_ = true;
+
+  ina_acc_i_ = 0.0;
+  ina_acc_v_ = 0.0;
+  ina_n_ = 0;
+  if (mode & 4) {
+    ina_due_us_ += inaCycleUs();
+  } else {
+    ina_due_us_ = 0;   // triggered: one cycle per config write
+  }
+  inaAlertUpdate(true);
+}
+
+// ALERT: the highest-priority enabled function, open drain (low = active unless APOL)
+void Rig::inaAlertUpdate(bool conversion) {
+  bool hit = false;
+  if (ina_mask_ & INA_SOL) hit = ina_shunt_ > (int16_t)ina_limit_;
+  else if (ina_mask_ & INA_SUL) hit = ina_shunt_ < (int16_t)ina_limit_;
+  else if (ina_mask_ & INA_BOL) hit = ina_bus_ > ina_limit_;
+  else if (ina_mask_ & INA_BUL) hit = ina_bus_ < ina_limit_;
+  else if (ina_mask_ & INA_POL) hit = ina_power_ > ina_limit_;
+  else if (ina_mask_ & INA_CNVR) hit = ina_cvrf_;
+
+  if (conversion || !(ina_mask_ & INA_LEN)) {
+    ina_aff_ = (ina_mask_ & INA_LEN) ? (ina_aff_ || hit) : hit;
+  }
+  const bool apol = ina_mask_ & INA_APOL;
+  hostPinSet((uint8_t)p_.pin_ina_alert, ina_aff_ ? (apol ? HIGH : LOW) : (apol ? LOW : HIGH));
+}
+
+void Rig::inaWrite(const uint8_t* data, size_t n) {
+  advance();
+  if (n == 0) return;
+  ina_ptr_ = data[0];
+  if (n < 3) return;   // pointer only: a read follows
+  const uint16_t v = (uint16_t)((data[1] << 8) | data[2]);
+  switch (ina_ptr_) {
+    case 0x00:
+      if (v & 0x8000) {
+        inaReset();
+      } else {
+        ina_cfg_ = v;
+        inaRestart();
+      }
+      break;
+    case 0x05: ina_cal_ = v & 0x7FFF; break;
+    case 0x06:
+      ina_mask_ = v & 0xFC03;
+      inaAlertUpdate(false);
+      break;
+    case 0x07:
+      ina_limit_ = v;
+      inaAlertUpdate(false);
+      break;
+    default: break;   // read-only
+  }
+}
+
+size_t Rig::inaRead(uint8_t* data, size_t n) {
+  advance();
+  uint16_t v = 0;
+  switch (ina_ptr_) {
+    case 0x00: v = ina_cfg_; break;
+    case 0x01: v = (uint16_t)ina_shunt_; break;
+    case 0x02: v = ina_bus_; break;
+    case 0x03: v = ina_power_; break;
+    case 0x04: v = (uint16_t)ina_current_; break;
+    case 0x05: v = ina_cal_; break;
+    case 0x06:
+      v = ina_mask_ | (ina_aff_ ? INA_AFF : 0) | (ina_cvrf_ ? INA_CVRF : 0);
+      // reading the mask register clears the flags (a latched alert re-arms)
+      ina_cvrf_ = false;
+      if (ina_mask_ & INA_LEN) ina_aff_ = false;
+      inaAlertUpdate(false);
+      break;
+    case 0x07: v = ina_limit_; break;
+    case 0xFE: v = 0x5449; break;   // manufacturer "TI"
+    case 0xFF: v = 0x2260; break;   // die ID
+    default: break;
+  }
+  // the register repeats for longer reads
+  for (size_t i = 0; i < n; i++) data[i] = (i & 1) ? (uint8_t)(v & 0xFF) : (uint8_t)(v >> 8);
+  return n;
+}
+
+void SimIna226::write(const uint8_t* data, size_t n) { rig->inaWrite(data, n); }
+size_t SimIna226::read(uint8_t* data, size_t n) { return rig->inaRead(data, n); }
+
+static Rig* g_rig = nullptr;
+
+}  // namespace
+
+// ---------------- parameters ----------------
+
+struct RigField {
+  const char* key;
+  double HostRigParams::*p;
+};
+
+#define RIG_FIELD(k) { #k, &HostRigParams::k }
+static const RigField RIG_FIELDS[] = {
+  RIG_FIELD(motors), RIG_FIELD(pin_esc1), RIG_FIELD(pin_esc2), RIG_FIELD(pin_esc3), RIG_FIELD(pin_esc4),
+  RIG_FIELD(pin_hx_dout), RIG_FIELD(pin_hx_sck), RIG_FIELD(pin_ina_alert), RIG_FIELD(ina_addr),
+  RIG_FIELD(duty_min), RIG_FIELD(tel_jitter), RIG_FIELD(tel_crc_err), RIG_FIELD(tel_drop),
+  RIG_FIELD(edt_every), RIG_FIELD(esc_r_ohm), RIG_FIELD(esc_rth_k_per_w), RIG_FIELD(esc_cth_j_per_k),
+  RIG_FIELD(ambient_c), RIG_FIELD(pole_pairs), RIG_FIELD(kv), RIG_FIELD(r_ohm), RIG_FIELD(i0_a),
+  RIG_FIELD(inertia_kgm2), RIG_FIELD(ct_g_per_krpm2), RIG_FIELD(cq_nmm_per_krpm2), RIG_FIELD(supply_v),
+  RIG_FIELD(supply_r_ohm), RIG_FIELD(battery_mah), RIG_FIELD(supply_v_empty), RIG_FIELD(esc_idle_a),
+  RIG_FIELD(hx_sps), RIG_FIELD(hx_counts_per_g), RIG_FIELD(hx_offset_counts), RIG_FIELD(hx_noise_counts),
+  RIG_FIELD(hx_vib_g_per_krpm2), RIG_FIELD(shunt_ohm), RIG_FIELD(ina_noise_shunt_lsb),
+  RIG_FIELD(ina_noise_bus_lsb),
+};
+#undef RIG_FIELD
+
+bool hostRigLoad(HostRigParams& p, const char* path) {
+  FILE* f = fopen(path, "r");
+  if (!f) {
+    fprintf(stderr, "HOST cannot read %s\n", path);
+    return false;
+  }
+  char line[160];
+  unsigned ln = 0;
+  bool ok = true;
+  while (ok && fgets(line, sizeof(line), f)) {
+    ln++;
+    char* hash = strchr(line, '#');
+    if (hash) *hash = '\0';
+    char key[48];
+    double v;
+    char extra;
+    if (sscanf(line, " %47[a-z0-9_] = %lf %c", key, &v, &extra) != 2) {
+      char blank;
+      if (sscanf(line, " %c", &blank) == 1) {
+        fprintf(stderr, "HOST %s:%u: expected key = value\n", path, ln);
+        ok = false;
+      }
+      continue;
+    }
+    const RigField* fld = nullptr;
+    for (const RigField& r : RIG_FIELDS) {
+      if (strcmp(r.key, key) == 0) fld = &r;
+    }
+    if (!fld) {
+      fprintf(stderr, "HOST %s:%u: unknown key %s\n", path, ln, key);
+      ok = false;
+      continue;
+    }
+    p.*(fld->p) = v;
+  }
+  fclose(f);
+  if (!ok) return false;
+
+  if (p.motors < 1 || p.motors > RIG_MOTORS_MAX || p.kv <= 0 || p.r_ohm <= 0 || p.inertia_kgm2 <= 0 ||
+      p.pole_pairs < 1 || p.hx_sps <= 0 || p.shunt_ohm <= 0 || p.esc_rth_k_per_w <= 0 ||
+      p.esc_cth_j_per_k <= 0 || p.duty_min < 0 || p.duty_min >= 1) {
+    fprintf(stderr, "HOST %s: value out of range\n", path);
+    return false;
+  }
+  return true;
+}
+
+void hostRigAttach(const HostRigParams& p, uint64_t seed) {
+  if (!g_rig) g_rig = new Rig(p, seed);
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "host.h"
+
+// Simulated test rig for the host build: motors + props on one load cell, fed from one supply
+// through the INA226 shunt. It plugs into the host.h hooks, so the firmware's own drivers
+// (EscBdshot, HX711_ADC, INA226) talk to it unchanged:
+//   - ESC:    DShot throttle -> duty; eRPM replies quantised like the BDShot period code, with
+//             jitter and CRC errors; EDT temperature frames once DShot command 13 enabled them
+//   - motor:  DC model from Kv / R / no-load current, J dw/dt = Kt (I - I0) - Cq rpm^2
+//   - prop:   thrust = Ct rpm^2 (all motors on one load cell)
+//   - supply: source resistance sag, optional battery discharge
+//   - HX711:  continuous 80 SPS conversions (mean over the conversion), DOUT/SCK bit-bang,
+//             noise + vibration, 24-bit saturation, SCK-high power-down
+//   - INA226: register file (config, shunt, bus, power, current, calibration, alert),
+//             conversion/averaging timing from the config register, noise, ALERT pin
+//
+// The physics runs lazily in RIG_STEP_US steps up to hostNowUs() whenever the firmware touches
+// a device. Noise comes from a seeded generator: same seed + same input = same run.
+
+static constexpr uint32_t RIG_STEP_US = 50;
+static constexpr uint8_t  RIG_MOTORS_MAX = 4;
+
+// Defaults fit logs/examples (7 pole pairs, 5" prop, 14.8 V server PSU, TAL220 10 kg).
+struct HostRigParams {
+  // wiring (= cfg.h)
+  double motors = 1;                  // simulated ESCs, on pin_esc1..4
+  double pin_esc1 = 2, pin_esc2 = 3, pin_esc3 = 8, pin_esc4 = 9;
+  double pin_hx_dout = 6, pin_hx_sck = 7;
+  double pin_ina_alert = 10;
+  double ina_addr = 0x40;
+
+  // ESC
+  double duty_min = 0.04;             // duty at the first throttle step
+  double tel_jitter = 0.003;          // eRPM noise, fraction (1 sigma)
+  double tel_crc_err = 0.001;         // probability per reply
+  double tel_drop = 0.0;              // probability of no reply
+  double edt_every = 0;               // EDT temperature every Nth reply once enabled (0 = ESC without EDT)
+  double esc_r_ohm = 0.01;            // ESC conduction loss -> temperature
+  double esc_rth_k_per_w = 8.0;
+  double esc_cth_j_per_k = 15.0;
+  double ambient_c = 25.0;
+
+  // motor + prop
+  double pole_pairs = 7;
+  double kv = 2400;                   // RPM/V
+  double r_ohm = 0.25;                // phase resistance incl. ESC
+  double i0_a = 0.8;                  // no-load current (friction torque)
+  double inertia_kgm2 = 1.5e-5;       // rotor + prop
+  double ct_g_per_krpm2 = 2.0;        // thrust [g] per (1000 RPM)^2
+  double cq_nmm_per_krpm2 = 0.14;     // prop torque [N*mm] per (1000 RPM)^2
+
+  // supply
+  double supply_v = 14.8;             // open circuit (full battery)
+  double supply_r_ohm = 0.005;        // source + wiring
+  double battery_mah = 0;             // 0 = bench supply, no discharge
+  double supply_v_empty = 13.2;       // open circuit at 0 % charge
+  double esc_idle_a = 0.05;           // ESC + BEC draw with the motor off
+
+  // HX711 + load cell
+  double hx_sps = 80;
+  double hx_counts_per_g = 215;       // negative = cell mounted the other way round
+  double hx_offset_counts = 48000;    // reading with no thrust
+  double hx_noise_counts = 40;        // 1 sigma per conversion
+  double hx_vib_g_per_krpm2 = 0.01;   // vibration on the cell, 1 sigma [g] per (1000 RPM)^2
+
+  // INA226
+  double shunt_ohm = 0.001;
+  double ina_noise_shunt_lsb = 2.0;   // 1 sigma per conversion, 2.5 uV LSB
+  double ina_noise_bus_lsb = 1.0;     // 1 sigma per conversion, 1.25 mV LSB
+};
+
+// "key = value" lines, '#' comments; false (with a message on stderr) on an unknown key
+bool hostRigLoad(HostRigParams& p, const char* path);
+// build the rig and attach it to the pins / I2C address / DShot outputs in p
+void hostRigAttach(const HostRigParams& p, uint64_t seed);
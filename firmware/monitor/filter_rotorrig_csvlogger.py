@@ -7,6 +7,9 @@ from datetime import datetime
 # "17:18:12.035 > " oraz czasem samo "> "
 _TS_PREFIX = re.compile(r"^\d{2}:\d{2}:\d{2}\.\d{3}\s*>\s*")
 
+# "OK BATCH RUN 2/5 hover5 T12" -> następna sesja CSV dostaje tag b02_T12
+_BATCH_RUN_RE = re.compile(r"^OK BATCH RUN (\d+)/(\d+) (\S+) (\S+)$")
+
 _FLOAT_RE = re.compile(r"""
 ^
 [+-]?
@@ -18,7 +21,7 @@ _FLOAT_RE = re.compile(r"""
 $
 """, re.VERBOSE)
 
-# Dokładnie wg src/csv.cpp (24 kolumn):
+# Dokładnie wg src/csv.cpp (38 kolumn):
 CSV_HEADER = [
     "t_ms",            # 0
     "test_id",         # 1
@@ -43,9 +46,38 @@ CSV_HEADER = [
     "eff_N_per_W",     # 20
     "eff_g_per_A",     # 21
     "bdshot_err_pct",  # 22
-    "notes",           # 23
+    "RPM_mean",        # 23
+    "RPM_min",         # 24
+    "RPM_max",         # 25
+    "RPM_sp",          # 26
+    "RPM_err",         # 27
+    "m2_throttle_pct", # 28
+    "m2_RPM",          # 29
+    "m2_bdshot_err_pct",  # 30
+    "m3_throttle_pct", # 31
+    "m3_RPM",          # 32
+    "m3_bdshot_err_pct",  # 33
+    "m4_throttle_pct", # 34
+    "m4_RPM",          # 35
+    "m4_bdshot_err_pct",  # 36
+    "notes",           # 37
 ]
 
+# Typy kolumn (po nazwie, żeby nowe kolumny nie psuły indeksów)
+_INT_COLS = ("t_ms", "kv", "battery_s", "pole_pairs", "step_id", "is_steady",
+             "eRPM", "RPM", "RPM_min", "RPM_max")
+_FLOAT_COLS = ("throttle_pct", "step_time_s", "V_bus_V", "I_A", "P_in_W", "thrust_N", "thrust_g",
+               "eff_g_per_W", "eff_N_per_W", "eff_g_per_A", "bdshot_err_pct", "RPM_mean",
+               "RPM_sp", "RPM_err",
+               "m2_throttle_pct", "m2_RPM", "m2_bdshot_err_pct",
+               "m3_throttle_pct", "m3_RPM", "m3_bdshot_err_pct",
+               "m4_throttle_pct", "m4_RPM", "m4_bdshot_err_pct")
+_STR_COLS = ("test_id", "motor_id", "prop", "esc_fw", "notes")
+
+INT_IDX = tuple(CSV_HEADER.index(c) for c in _INT_COLS)
+FLOAT_IDX = tuple(CSV_HEADER.index(c) for c in _FLOAT_COLS)
+STR_IDX = tuple(CSV_HEADER.index(c) for c in _STR_COLS)
+
 def strip_prefix(line: str) -> str:
     line = _TS_PREFIX.sub("", line)
     if line.startswith(">"):
@@ -66,7 +98,7 @@ def is_float_or_special(s: str) -> bool:
 
 class RotorRigCsvLogger(DeviceMonitorFilterBase):
     """
-    - zapisuje tylko prawdziwe linie CSV do .csv (24 pola wg csv.cpp)
+    - zapisuje tylko prawdziwe linie CSV do .csv (pola wg CSV_HEADER / csv.cpp)
     - rotuje plik po markerach RX:
         OK LOG 1 -> start nowego pliku (z nagłówkiem)
         OK LOG 0 -> stop (flush+fsync)
@@ -79,7 +111,7 @@ class RotorRigCsvLogger(DeviceMonitorFilterBase):
         super().__init__(*args, **kwargs)
 
         # Konfiguracja przez zmienne środowiskowe (opcjonalnie):
-        self.fields = int(os.getenv("ROTORRIG_CSV_FIELDS", "24"))
+        self.fields = int(os.getenv("ROTORRIG_CSV_FIELDS", str(len(CSV_HEADER))))
         self.delim = os.getenv("ROTORRIG_CSV_DELIM", ",")
         self.log_root = os.getenv("ROTORRIG_LOG_DIR", os.path.join(os.getcwd(), "logs", "rotorrig"))
         self.tag = os.getenv("ROTORRIG_TAG", "").strip()
@@ -89,9 +121,13 @@ class RotorRigCsvLogger(DeviceMonitorFilterBase):
 
         self._rx_buf = ""
         self._csv_f = None
+        self._steps_f = None
+        self._steps_path = None
+        self._bench_f = None
         self._raw_f = None
         self._csv_lines = 0
         self._session_idx = 0
+        self._batch_tag = ""  # ustawiany przez OK BATCH RUN, zużywany przez najbliższe OK LOG 1
         self._logging = False
 
         if self.write_raw:
@@ -107,6 +143,9 @@ class RotorRigCsvLogger(DeviceMonitorFilterBase):
         self._session_idx += 1
         t = datetime.now().strftime("%H%M%S")
         s = f"s{self._session_idx:03d}"
+        if self._batch_tag:
+            s = f"{s}_{self._batch_tag}"
+            self._batch_tag = ""
         if self.tag:
             return f"{t}_{self.tag}_{s}"
         return f"{t}_{s}"
@@ -144,6 +183,7 @@ class RotorRigCsvLogger(DeviceMonitorFilterBase):
         self._csv_stop(reason="rotate")
 
         self._csv_f = open(csv_path, "a", encoding="utf-8", newline="\n", buffering=1)
+        self._steps_path = os.path.join(self._today_dir(), f"{base}_steps.csv")  # otwierany przy 1. STEP
         self._csv_lines = 0
         self._logging = True
 
@@ -162,6 +202,13 @@ class RotorRigCsvLogger(DeviceMonitorFilterBase):
             self._sync_file(self._raw_f)
 
         self._logging = False
+        if self._steps_f:
+            self._sync_file(self._steps_f)
+            try:
+                self._steps_f.close()
+            except Exception:
+                pass
+            self._steps_f = None
         if self._csv_f:
             self._sync_file(self._csv_f)
             try:
@@ -172,32 +219,10 @@ class RotorRigCsvLogger(DeviceMonitorFilterBase):
 
     def _looks_like_csv(self, line: str) -> bool:
         """
-        Dokładnie wg src/csv.cpp:
-        24 kolumn:
-        0 t_ms (int)
-        1 test_id (str)
-        2 motor_id (str)
-        3 kv (int)
-        4 prop (str)
-        5 battery_s (int)
-        6 esc_fw (str)
-        7 pole_pairs (int)
-        8 step_id (int)
-        9 throttle_pct (float/NaN)
-        10 step_time_s (float/NaN)
-        11 is_steady (int)
-        12 eRPM (int)
-        13 RPM (int)
-        14 V_bus_V (float/NaN)
-        15 I_A (float/NaN)
-        16 P_in_W (float/NaN)
-        17 thrust_N (float/NaN)
-        18 thrust_g (float/NaN)
-        19 eff_g_per_W (float/NaN)
-        20 eff_N_per_W (float/NaN)
-        21 eff_g_per_A (float/NaN)
-        22 bdshot_err_pct (float/NaN)
-        23 notes (str)
+        Dokładnie wg src/csv.cpp (typy kolumn wg CSV_HEADER):
+        - inty:    _INT_COLS
+        - floaty:  _FLOAT_COLS (float/NaN)
+        - stringi: _STR_COLS (nie mogą być puste; mogą być "NA")
         """
         line = strip_prefix(line).strip()
         if not line:
@@ -207,17 +232,15 @@ class RotorRigCsvLogger(DeviceMonitorFilterBase):
         if len(parts) != self.fields:
             return False
 
-        # 0: t_ms
-        if not is_int_token(parts[0]):
-            return False
+        # gdy ktoś nadpisze ROTORRIG_CSV_FIELDS, sprawdzamy tylko liczbę pól
+        if self.fields != len(CSV_HEADER):
+            return True
 
-        # inty: 3,5,7,8,11,12,13
-        for idx in (3, 5, 7, 8, 11, 12, 13):
+        for idx in INT_IDX:
             if not is_int_token(parts[idx]):
                 return False
 
-        # floaty: 9,10,14..22
-        for idx in (9, 10, 14, 15, 16, 17, 18, 19, 20, 21, 22):
+        for idx in FLOAT_IDX:
             tok = parts[idx]
             # firmware drukuje NaN; NA też tolerujemy awaryjnie
             if tok.upper() == "NA":
@@ -225,8 +248,7 @@ class RotorRigCsvLogger(DeviceMonitorFilterBase):
             if not is_float_or_special(tok):
                 return False
 
-        # stringi: 1,2,4,6,23 (nie mogą być puste; mogą być "NA")
-        for idx in (1, 2, 4, 6, 23):
+        for idx in STR_IDX:
             if parts[idx] == "":
                 return False
 
@@ -242,6 +264,38 @@ class RotorRigCsvLogger(DeviceMonitorFilterBase):
         if (self._csv_lines % self.fsync_every) == 0:
             self._sync_file(self._csv_f)
 
+    def _write_step(self, line: str):
+        """Podsumowania kroków (STEPHDR/STEP z firmware) -> <plik>_steps.csv obok CSV."""
+        if not (self._logging and self._steps_path):
+            return
+        if self._steps_f is None:
+            self._steps_f = open(self._steps_path, "a", encoding="utf-8", newline="\n", buffering=1)
+        # bez prefiksu "STEPHDR," / "STEP,"
+        self._steps_f.write(line.split(",", 1)[1] + "\n")
+        self._sync_file(self._steps_f)
+
+    def _write_bench(self, line: str):
+        """Wyniki BENCH (BENCHHDR/BENCH z firmware) -> <HHMMSS>_bench.csv, jeden plik na przebieg,
+        niezależnie od LOG (porównania między wersjami firmware)."""
+        if line.startswith("BENCHHDR,"):
+            self._bench_close()
+            self._ensure_dir(self._today_dir())
+            path = os.path.join(self._today_dir(), f"{datetime.now().strftime('%H%M%S')}_bench.csv")
+            self._bench_f = open(path, "a", encoding="utf-8", newline="\n", buffering=1)
+        if self._bench_f is None:
+            return
+        # bez prefiksu "BENCHHDR," / "BENCH,"
+        self._bench_f.write(line.split(",", 1)[1] + "\n")
+
+    def _bench_close(self):
+        if self._bench_f:
+            self._sync_file(self._bench_f)
+            try:
+                self._bench_f.close()
+            except Exception:
+                pass
+            self._bench_f = None
+
     def rx(self, text):
         # zapis RAW (wszystko)
         if self._raw_f:
@@ -263,6 +317,24 @@ class RotorRigCsvLogger(DeviceMonitorFilterBase):
                 self._csv_stop(reason="rx:OK LOG 0")
                 continue
 
+            # kolejka BATCH: każdy przebieg to osobna sesja, nazwana numerem i test_id
+            m = _BATCH_RUN_RE.match(s)
+            if m:
+                tid = re.sub(r"[^A-Za-z0-9_-]", "_", m.group(4))
+                self._batch_tag = f"b{int(m.group(1)):02d}_{tid}"
+                continue
+
+            if s.startswith("STEPHDR,") or s.startswith("STEP,"):
+                self._write_step(s)
+                continue
+
+            if s.startswith("BENCHHDR,") or s.startswith("BENCH,"):
+                self._write_bench(s)
+                continue
+            if s.startswith("OK BENCH"):
+                self._bench_close()
+                continue
+
             # same CSV
             if self._looks_like_csv(line):
                 self._write_csv(line)
@@ -4,44 +4,84 @@
 static inline uint32_t ms_now() { return (uint32_t)millis(); }
 static inline uint32_t ms_age(uint32_t t0) { return (uint32_t)(ms_now() - t0); } // wrap-safe
 
-void AutoTest::start(const float* steps, int n, float step_time_s, float ramp_s) {
-  st_ = AutoTestState{};
-  st_.active = true;
-  st_.step_time_s = step_time_s;
-  st_.ramp_s = ramp_s;
-  st_.step_time_list_en = false;
-
-  if (n > AutoTestState::MAX_STEPS) n = AutoTestState::MAX_STEPS;
-  st_.count = n;
-  for (int i = 0; i < n; i++) st_.steps_pct[i] = steps[i];
-
-  st_.step_id = 0;
+// ramp back to 0 after the last step if that step has no ramp of its own
+static constexpr float AT_END_RAMP_S = 3.0f;
+
+// sweep: approach/settle at the start value, then margin so each leg's ramp completes
+static constexpr float SWEEP_APPROACH_RAMP_S = 3.0f;
+static constexpr float SWEEP_SETTLE_S = 2.0f;
+static constexpr float SWEEP_LEG_MARGIN_S = 0.2f;
+
+void AutoTest::begin_() {
+  st_.active = (st_.prog.count > 0);
+  st_.step_id = st_.active ? 0 : -1;
   st_.step_start_ms = ms_now();
   st_.steady = false;
+  st_.ramp_done = false;
+  det_.reset();
+  sum_count_ = 0;
+  for (uint8_t c = 0; c < AT_SUM_COUNT; c++) { acc_steady_[c].reset(); acc_post_[c].reset(); }
+}
+
+void AutoTest::start(const float* steps, int n, float step_time_s, float ramp_s, RampProfile prof) {
+  if (n > AtProgram::MAX_STEPS) n = AtProgram::MAX_STEPS;
+  float durs[AtProgram::MAX_STEPS];
+  for (int i = 0; i < n; i++) durs[i] = step_time_s;
+  startProgram(steps, durs, n, ramp_s, prof);
+}
+
+void AutoTest::startProgram(const float* steps, const float* step_time_s_list, int n, float ramp_s,
+                            RampProfile prof) {
+  st_ = AutoTestState();   // () not {}: GCC 12 crashes (ICE) on {} for this aggregate
+  atProgramFromTable(st_.prog, "adhoc", steps, step_time_s_list, n, ramp_s, prof, AT_STEP_THROTTLE);
+  begin_();
+}
+
+void AutoTest::startRpmProgram(const float* rpm_steps, const float* step_time_s_list, int n, float ramp_s) {
+  st_ = AutoTestState();
+  atProgramFromTable(st_.prog, "rpm", rpm_steps, step_time_s_list, n, ramp_s, RAMP_LINEAR, AT_STEP_RPM);
+  begin_();
+}
+
+bool AutoTest::startProgram(const AtProgram& p) {
+  if (atProgramValidate(p) != nullptr) return false;
+  st_ = AutoTestState();
+  st_.prog = p;
+  begin_();
+  return true;
 }
 
-void AutoTest::startProgram(const float* steps, const float* step_time_s_list, int n, float ramp_s) {
-  st_ = AutoTestState{};
-  st_.active = true;
-  st_.ramp_s = ramp_s;
+bool AutoTest::startSweep(float from_pct, float to_pct, float seconds, bool updown) {
+  if (!isfinite(from_pct) || !isfinite(to_pct) || !isfinite(seconds)) return false;
+  if (from_pct < 0.0f || from_pct > 100.0f || to_pct < 0.0f || to_pct > 100.0f) return false;
+  const float span = fabsf(to_pct - from_pct);
+  if (span < 1.0f || seconds <= 0.0f) return false;
+
+  st_ = AutoTestState();
+  AtProgram& p = st_.prog;
+  atProgramSetName(p, updown ? "sweep_updown" : "sweep");
 
-  if (n > AutoTestState::MAX_STEPS) n = AutoTestState::MAX_STEPS;
-  st_.count = n;
-  for (int i = 0; i < n; i++) {
-    st_.steps_pct[i] = steps[i];
-    st_.step_time_s_list[i] = step_time_s_list ? step_time_s_list[i] : 0.0f;
+  // ramp_s is a full 0..100 % swing time: scale so the leg takes exactly `seconds`
+  const float leg_ramp_s = seconds * 100.0f / span;
+  p.count = updown ? 3 : 2;
+  p.steps[0] = AtStep{ from_pct, SWEEP_APPROACH_RAMP_S,
+                       SWEEP_APPROACH_RAMP_S * from_pct / 100.0f + SWEEP_SETTLE_S,
+                       AT_STEP_THROTTLE, RAMP_LINEAR };
+  p.steps[1] = AtStep{ to_pct, leg_ramp_s, seconds + SWEEP_LEG_MARGIN_S, AT_STEP_THROTTLE, RAMP_LINEAR };
+  if (updown) {
+    p.steps[2] = AtStep{ from_pct, leg_ramp_s, seconds + SWEEP_LEG_MARGIN_S, AT_STEP_THROTTLE, RAMP_LINEAR };
   }
-  st_.step_time_list_en = (step_time_s_list != nullptr);
 
-  st_.step_id = 0;
-  st_.step_start_ms = ms_now();
-  st_.steady = false;
+  begin_();
+  st_.sweep = true;
+  st_.sweep_updown = updown;
+  hyst_.reset();
+  return true;
 }
 
 float AutoTest::stepTimeS() const {
-  if (!st_.active || st_.step_id < 0 || st_.step_id >= st_.count) return NAN;
-  if (st_.step_time_list_en) return st_.step_time_s_list[st_.step_id];
-  return st_.step_time_s;
+  if (!st_.active || st_.step_id < 0 || st_.step_id >= st_.prog.count) return NAN;
+  return st_.prog.steps[st_.step_id].hold_s;
 }
 
 void AutoTest::stop() {
@@ -49,28 +89,95 @@ void AutoTest::stop() {
   st_.step_id = -1;
 }
 
-void AutoTest::tick(EscBdshot& esc) {
+void AutoTest::feed(const Frame& f) {
   if (!st_.active) return;
+  const float rpm = isfinite(f.rpm_mean) ? f.rpm_mean : (float)f.rpm;
 
+  // sweep legs are one long ramp: bin every frame
+  if (st_.sweep && st_.step_id >= 1) {
+    hyst_.push((uint8_t)(st_.step_id - 1), f.throttle_pct, f.thrust_g, rpm, f.i_A);
+  }
+
+  if (!st_.ramp_done) return;
+  det_.push(f.thrust_g, rpm, f.i_A);
+
+  const float v[AT_SUM_COUNT] = { f.thrust_g, f.i_A, f.v_bus_V, f.p_in_W, rpm, f.eff_g_per_W };
+  for (uint8_t c = 0; c < AT_SUM_COUNT; c++) {
+    acc_post_[c].push(v[c]);
+    if (st_.steady) acc_steady_[c].push(v[c]);
+  }
+}
+
+void AutoTest::closeStep_() {
+  if (sum_count_ >= AtProgram::MAX_STEPS) return;
+  const AtStep& s = st_.prog.steps[st_.step_id];
+  AtStepSummary& r = sums_[sum_count_++];
+  r.step_id = (int16_t)st_.step_id;
+  r.type = s.type;
+  r.value = s.value;
+  r.step_s = (float)ms_age(st_.step_start_ms) * 0.001f;
+  r.ended_steady = st_.ended_steady;
+
+  const bool have_steady = acc_steady_[AT_SUM_THRUST_G].n > 0 || acc_steady_[AT_SUM_RPM].n > 0;
+  const bool have_post = acc_post_[AT_SUM_THRUST_G].n > 0 || acc_post_[AT_SUM_RPM].n > 0;
+  r.basis = have_steady ? AT_BASIS_STEADY : (have_post ? AT_BASIS_POSTRAMP : AT_BASIS_NONE);
+  r.frames = 0;
+  for (uint8_t c = 0; c < AT_SUM_COUNT; c++) {
+    r.st[c] = have_steady ? acc_steady_[c] : acc_post_[c];
+    if (r.st[c].n > r.frames) r.frames = (uint16_t)r.st[c].n;
+    acc_steady_[c].reset();
+    acc_post_[c].reset();
+  }
+}
+
+void AutoTest::nextStep_(EscGroup& esc) {
+  closeStep_();
+  st_.step_id++;
+  if (st_.step_id >= st_.prog.count) {
+    st_.active = false;
+    st_.step_id = -1;
+    const AtStep& last = st_.prog.steps[st_.prog.count - 1];
+    esc.setTargetThrottlePct(0.0f, (last.ramp_s > 0.0f) ? last.ramp_s : AT_END_RAMP_S,
+                             (RampProfile)last.prof);
+    return;
+  }
+  st_.step_start_ms = ms_now();
+  st_.steady = false;
+  st_.ended_steady = false;
+  st_.ramp_done = false;
+  det_.reset();
+}
+
+void AutoTest::tick(EscGroup& esc) {
+  if (!st_.active) return;
+
+  const AtStep& s = st_.prog.steps[st_.step_id];
   const uint32_t elapsed = ms_age(st_.step_start_ms);
-  const float step_s = st_.step_time_list_en ? st_.step_time_s_list[st_.step_id] : st_.step_time_s;
-  const float step_ms = step_s * 1000.0f;
-
-  // steady after ramp
-  st_.steady = (elapsed >= (uint32_t)(st_.ramp_s * 1000.0f));
-
-  // apply target throttle for current step
-  const float pct = st_.steps_pct[st_.step_id];
-  esc.setTargetThrottlePct(pct, st_.ramp_s);
-
-  if (elapsed >= (uint32_t)step_ms) {
-    st_.step_id++;
-    if (st_.step_id >= st_.count) {
-      st_.active = false;
-      st_.step_id = -1;
-      esc.setTargetThrottlePct(0.0f, st_.ramp_s);
-      return;
-    }
-    st_.step_start_ms = ms_now();
+  const float step_ms = s.hold_s * 1000.0f;
+
+  // apply target (throttle % or RPM setpoint) for current step
+  if (s.type == AT_STEP_RPM) {
+    esc.setTargetRpm((s.value > 0.0f) ? (uint32_t)lrintf(s.value) : 0u, s.ramp_s);
+  } else {
+    esc.setTargetThrottlePct(s.value, s.ramp_s, (RampProfile)s.prof);
+  }
+
+  // steady = ramp finished and thrust/RPM/current settled over the detector window
+  if (!st_.ramp_done && esc.rampDone()) {
+    st_.ramp_done = true;
+    det_.reset();
+  }
+  const bool steady = st_.ramp_done && det_.steady();
+  if (steady && !st_.steady) st_.steady_since_ms = ms_now();
+  st_.steady = steady;
+
+  // sweeps keep their fixed timing (the detector window assumes 10 Hz frames); 0 % / 0 RPM
+  // steps are cooldowns, which are steady at once but must run their full hold
+  const bool cooldown = s.value <= 0.0f;
+  const bool dwell_done = adaptive_ && !st_.sweep && !cooldown && steady &&
+                          ms_age(st_.steady_since_ms) >= STEADY_MIN_DWELL_MS;
+  if (dwell_done || elapsed >= (uint32_t)step_ms) {
+    st_.ended_steady = dwell_done;
+    nextStep_(esc);
   }
 }
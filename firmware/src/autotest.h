@@ -1,40 +1,109 @@
 #pragma once
 #include <Arduino.h>
-#include "esc_bdshot.h"
+#include "esc_group.h"
+#include "program.h"
+#include "frame.h"
+#include "steady.h"
+#include "stats.h"
+#include "sweep.h"
+
+// Per-step summary channels (order = STEP line / table order).
+enum AtSumChannel : uint8_t {
+  AT_SUM_THRUST_G = 0,
+  AT_SUM_I_A,
+  AT_SUM_V_BUS_V,
+  AT_SUM_P_IN_W,
+  AT_SUM_RPM,
+  AT_SUM_EFF_G_PER_W,
+  AT_SUM_COUNT
+};
+
+// What the step statistics were taken over.
+enum AtSumBasis : uint8_t {
+  AT_BASIS_NONE     = 0,   // no frame after the ramp
+  AT_BASIS_POSTRAMP = 1,   // never steady: all frames after the ramp
+  AT_BASIS_STEADY   = 2,   // frames flagged steady
+};
+
+struct AtStepSummary {
+  int16_t step_id = -1;
+  uint8_t type = AT_STEP_THROTTLE;
+  uint8_t basis = AT_BASIS_NONE;
+  bool    ended_steady = false;   // left on steady+dwell (else hold timeout)
+  float   value = NAN;
+  float   step_s = NAN;           // actual step duration
+  uint16_t frames = 0;            // log frames in the basis
+  RunningStat st[AT_SUM_COUNT];
+};
 
 struct AutoTestState {
   bool active = false;
   int step_id = -1;
-  // Default (uniform) step time. If step_time_list_en==true,
-  // then each step has its own duration in step_time_s_list[].
-  float step_time_s = 0;
-  float ramp_s = 0;
   uint32_t step_start_ms = 0;
   bool steady = false;
+  bool ended_steady = false;
+  bool ramp_done = false;          // detector only sees post-ramp frames
+  bool sweep = false;              // AUTOTEST SWEEP: fixed timing, legs 1..2 binned for hysteresis
+  bool sweep_updown = false;
+  uint32_t steady_since_ms = 0;
 
-  // steps list
-  static constexpr int MAX_STEPS = 32;
-  int count = 0;
-  float steps_pct[MAX_STEPS]{};
-
-  // Optional per-step durations.
-  bool step_time_list_en = false;
-  float step_time_s_list[MAX_STEPS]{};
+  // running program (copied in, each step has its own value/type/ramp/hold)
+  AtProgram prog;
 };
 
 class AutoTest {
 public:
-  void start(const float* steps, int n, float step_time_s, float ramp_s);
-  void startProgram(const float* steps, const float* step_time_s_list, int n, float ramp_s);
+  void start(const float* steps, int n, float step_time_s, float ramp_s,
+             RampProfile prof = RAMP_LINEAR);
+  void startProgram(const float* steps, const float* step_time_s_list, int n, float ramp_s,
+                    RampProfile prof = RAMP_LINEAR);
+  void startRpmProgram(const float* rpm_steps, const float* step_time_s_list, int n, float ramp_s);
+  // false (and not started) if p does not validate
+  bool startProgram(const AtProgram& p);
+  // Continuous linear throttle sweep from -> to over seconds (optionally back to from).
+  // Step 0 settles at from, each leg is one ramp segment. False on bad arguments.
+  bool startSweep(float from_pct, float to_pct, float seconds, bool updown);
   void stop();
 
-  void tick(EscBdshot& esc);
+  void tick(EscGroup& esc);
+  // one log frame (10 Hz) for steady-state detection
+  void feed(const Frame& f);
+
+  // Adaptive: leave a step after STEADY_MIN_DWELL_MS of detected steady state;
+  // the step's hold time becomes a timeout. Off = fixed hold times. 0 % / 0 RPM steps
+  // (cooldowns) always run their full hold.
+  void setAdaptive(bool en) { adaptive_ = en; }
+  bool adaptive() const { return adaptive_; }
 
   bool active() const { return st_.active; }
   int stepId() const { return st_.step_id; }
   float stepTimeS() const;
   bool isSteady() const { return st_.steady; }
+  const char* programName() const { return st_.prog.name; }
+  bool sweepActive() const { return st_.active && st_.sweep; }
+  // last sweep (valid after it finished, until the next start)
+  bool lastWasSweep() const { return st_.sweep; }
+  bool lastSweepUpDown() const { return st_.sweep_updown; }
+  const SweepHysteresis& sweepHysteresis() const { return hyst_; }
+
+  // one summary per finished step of the current/last program (kept until the next start)
+  uint8_t summaryCount() const { return sum_count_; }
+  const AtStepSummary& summary(uint8_t i) const { return sums_[i < AtProgram::MAX_STEPS ? i : 0]; }
+
+private:
+  void begin_();
+  void nextStep_(EscGroup& esc);
+  void closeStep_();
 
 private:
   AutoTestState st_;
+  SteadyDetector det_;
+  bool adaptive_ = true;
+
+  // running step statistics: steady frames, and all post-ramp frames as fallback
+  RunningStat acc_steady_[AT_SUM_COUNT];
+  RunningStat acc_post_[AT_SUM_COUNT];
+  AtStepSummary sums_[AtProgram::MAX_STEPS];
+  SweepHysteresis hyst_;
+  uint8_t sum_count_ = 0;
 };
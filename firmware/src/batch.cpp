@@ -0,0 +1,59 @@
+#include "batch.h"
+#include "stats.h"
+#include <math.h>
+
+void CooldownGate::reset() {
+  head_ = 0;
+  count_ = 0;
+  temp_C_ = NAN;
+  blocking_ = 0;
+  for (uint8_t c = 0; c < CH_COUNT; c++) { mean_[c] = NAN; drift_[c] = NAN; }
+}
+
+void CooldownGate::push(float esc_temp_C, float i_A, float v_bus_V, float thrust_g) {
+  temp_C_ = esc_temp_C;
+  buf_[CH_I][head_] = i_A;
+  buf_[CH_VBUS][head_] = v_bus_V;
+  buf_[CH_THRUST][head_] = thrust_g;
+  head_ = (uint8_t)((head_ + 1) % BATCH_GATE_WIN);
+  if (count_ < BATCH_GATE_WIN) count_++;
+
+  if (full()) evaluate_();
+}
+
+void CooldownGate::evaluate_() {
+  static const uint8_t COND[CH_COUNT] = { C_CURRENT, C_VBUS, C_ZERO };
+
+  blocking_ = 0;
+  // EDT temperature is a slow channel: the latest value is enough
+  if (isfinite(temp_C_) && temp_C_ > BATCH_ESC_TEMP_MAX_C) blocking_ |= C_TEMP;
+
+  for (uint8_t c = 0; c < CH_COUNT; c++) {
+    uint8_t finite = 0;
+    for (uint8_t k = 0; k < BATCH_GATE_WIN; k++) {
+      if (isfinite(buf_[c][k])) finite++;
+    }
+    mean_[c] = NAN;
+    drift_[c] = NAN;
+    if (finite == 0) continue;                                 // sensor absent: skip
+    if (finite < BATCH_GATE_WIN) { blocking_ |= COND[c]; continue; }
+
+    const WindowFit w = windowFit(buf_[c], BATCH_GATE_WIN, head_);
+    mean_[c] = w.mean;
+    drift_[c] = w.drift;
+
+    bool ok = true;
+    if (c == CH_I) ok = fabsf(w.mean) <= BATCH_IDLE_I_MAX_A;
+    else if (c == CH_VBUS) ok = w.drift <= BATCH_VBUS_DRIFT_V;
+    else ok = fabsf(w.mean) <= BATCH_ZERO_TOL_G && w.std <= BATCH_ZERO_STD_G && w.drift <= BATCH_ZERO_STD_G;
+    if (!ok) blocking_ |= COND[c];
+  }
+}
+
+const char* CooldownGate::condName(uint8_t mask) {
+  if (mask & C_TEMP) return "TEMP";
+  if (mask & C_CURRENT) return "CURRENT";
+  if (mask & C_VBUS) return "VBUS";
+  if (mask & C_ZERO) return "ZERO";
+  return "";
+}
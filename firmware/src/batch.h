@@ -0,0 +1,50 @@
+#pragma once
+#include <Arduino.h>
+#include "cfg.h"
+#include "program.h"
+#include "meta.h"
+
+// One queued run: program name plus the meta fields that change between runs.
+// Empty test_id / prop = keep the current SETMETA value.
+struct BatchEntry {
+  char prog[AtProgram::NAME_LEN]{};
+  char test_id[Meta::FIELD_LEN]{};
+  char prop[Meta::FIELD_LEN]{};
+};
+
+// Decides when the gap between two batch runs may end: ESC cool (EDT), idle current,
+// supply voltage recovered and load cell back at a stable zero. Fed one sample per log
+// frame. A channel that is NaN for the whole window (sensor or EDT missing) is skipped;
+// a partly-NaN channel blocks.
+class CooldownGate {
+public:
+  enum Cond : uint8_t { C_TEMP = 1, C_CURRENT = 2, C_VBUS = 4, C_ZERO = 8 };
+  enum Channel : uint8_t { CH_I = 0, CH_VBUS = 1, CH_THRUST = 2, CH_COUNT = 3 };
+
+  void reset();
+  void push(float esc_temp_C, float i_A, float v_bus_V, float thrust_g);
+
+  bool full() const { return count_ >= BATCH_GATE_WIN; }
+  // conditions still blocking (Cond bits); everything blocks until the window is full
+  uint8_t blocking() const { return full() ? blocking_ : (uint8_t)(C_TEMP | C_CURRENT | C_VBUS | C_ZERO); }
+  bool ready() const { return full() && blocking_ == 0; }
+  static const char* condName(uint8_t mask);   // first blocking condition, "" if none
+
+  // diagnostics (last evaluation)
+  float tempC() const { return temp_C_; }
+  float meanOf(Channel c) const { return mean_[c]; }
+  float driftOf(Channel c) const { return drift_[c]; }
+
+private:
+  void evaluate_();
+
+private:
+  float buf_[CH_COUNT][BATCH_GATE_WIN]{};
+  uint8_t head_ = 0;
+  uint8_t count_ = 0;
+  float temp_C_ = NAN;
+
+  float mean_[CH_COUNT]{};
+  float drift_[CH_COUNT]{};
+  uint8_t blocking_ = 0;
+};
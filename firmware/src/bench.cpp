@@ -0,0 +1,260 @@
+#include "bench.h"
+#include "hal.h"
+#include "cfg.h"
+#include "cli.h"
+#include "crc.h"
+#include "csv.h"
+#include "frame.h"
+#include "meta.h"
+#include "ramp.h"
+#include "sensors_hx711.h"
+#include "sensors_ina226.h"
+
+// results land here so the compiler cannot drop the timed work
+static volatile uint32_t bench_sink = 0;
+
+// fixed inputs: same numbers on every run and every build
+static uint32_t bench_rng = 0x2545F491u;
+static uint32_t benchRand() {
+  bench_rng ^= bench_rng << 13;
+  bench_rng ^= bench_rng >> 17;
+  bench_rng ^= bench_rng << 5;
+  return bench_rng;
+}
+// load-cell reading near the no-thrust offset, +-noise counts
+static int32_t benchRaw(int32_t noise) {
+  return 48000 + (int32_t)(benchRand() % (uint32_t)(2 * noise + 1)) - noise;
+}
+
+// Print that only counts: formatting cost without the USB / stdout write
+class BenchNullPrint : public Print {
+public:
+  size_t write(uint8_t) override { n++; return 1; }
+  size_t write(const uint8_t* buf, size_t len) override { (void)buf; n += len; return len; }
+  uint32_t n = 0;
+};
+
+// smoothedData() is protected: reached through a subclass, with the sample set filled directly
+class BenchHx711Lib : public HX711_ADC {
+public:
+  BenchHx711Lib() : HX711_ADC(PIN_HX_DOUT, PIN_HX_SCK) {}
+  void fill() {
+    for (uint8_t r = 0; r < DATA_SET + 1; r++) dataSampleSet[r] = benchRaw(400);
+  }
+  using HX711_ADC::smoothedData;
+};
+
+static constexpr size_t BENCH_CRC_LEN = 256;        // one flash page
+static constexpr uint8_t BENCH_HX_TRIM_PCT = 20;    // = main.cpp
+static constexpr uint32_t BENCH_RAMP_US = 2000000;  // segment length; ticks step 1 ms
+
+static SensorsHx711 bench_hx;
+static BenchHx711Lib bench_hxlib;
+static Frame bench_frame;
+static Meta bench_meta;
+static BenchNullPrint bench_null;
+static CLI* bench_cli = nullptr;
+static uint8_t bench_buf[BENCH_CRC_LEN];
+static RampGen bench_ramp;
+static uint32_t bench_ramp_t = 0;
+
+static void benchPrepare() {
+  bench_rng = 0x2545F491u;
+
+  bench_hx.windowReset();
+  for (uint8_t i = 0; i < HX_SAMPLES_PER_LOG; i++) bench_hx.windowPush(benchRaw(400));
+  bench_hxlib.fill();
+
+  // a 30 % hover frame as in logs/examples
+  Frame& f = bench_frame;
+  f = Frame{};
+  f.t_ms = 123456;
+  f.step_id = 3;
+  f.throttle_pct = 30.0f;
+  f.step_time_s = 2.5f;
+  f.is_steady = 1;
+  f.erpm = 65499;
+  f.rpm = 9357;
+  f.bdshot_err_pct = 0.2f;
+  f.rpm_mean = 9356.4f;
+  f.rpm_min = 9301;
+  f.rpm_max = 9410;
+  f.v_bus_V = 14.79f;
+  f.i_A = 1.318f;
+  f.p_in_W = f.v_bus_V * f.i_A;
+  f.thrust_g = 175.1f;
+  f.thrust_N = f.thrust_g * 0.00980665f;
+  frameDeriveEfficiency(f);
+  metaSet(bench_meta.test_id, "T12");
+  metaSet(bench_meta.motor_id, "M2207");
+  bench_meta.kv = 2400;
+  metaSet(bench_meta.prop, "5x4.3x3");
+  bench_meta.battery_s = 4;
+  metaSet(bench_meta.esc_fw, "BLHeli32");
+
+  for (size_t i = 0; i < BENCH_CRC_LEN; i++) bench_buf[i] = (uint8_t)benchRand();
+
+  bench_ramp.reset(0);
+  bench_ramp_t = 0;
+}
+
+// === Cases: run(calls) makes `calls` calls of the measured path ===
+static void benchHxMean(uint32_t calls) {
+  int32_t acc = 0;
+  for (uint32_t k = 0; k < calls; k++) acc += bench_hx.windowTrimmedMean(BENCH_HX_TRIM_PCT);
+  bench_sink = (uint32_t)acc;
+}
+
+static void benchHxNoise(uint32_t calls) {
+  int32_t acc = 0;
+  for (uint32_t k = 0; k < calls; k++) acc += bench_hx.windowNoise().raw_pp;
+  bench_sink = (uint32_t)acc;
+}
+
+static void benchHxSmooth(uint32_t calls) {
+  long acc = 0;
+  for (uint32_t k = 0; k < calls; k++) acc += bench_hxlib.smoothedData();
+  bench_sink = (uint32_t)acc;
+}
+
+static void benchCsvFrame(uint32_t calls) {
+  for (uint32_t k = 0; k < calls; k++) printCsvFrame(bench_frame, bench_meta, "NA", bench_null);
+  bench_sink = bench_null.n;
+}
+
+// the host monitor's poll; the GET reply is formatted in full but written to the null sink
+static void benchCliLine(uint32_t calls) {
+  static const char LINE[] = "get rpm,thrust_g";
+  char line[sizeof(LINE)];
+  bench_cli->setQueryOut(&bench_null);
+  for (uint32_t k = 0; k < calls; k++) {
+    memcpy(line, LINE, sizeof(LINE));   // tokenized in place
+    bench_cli->handleLine(line);
+  }
+  bench_cli->setQueryOut(nullptr);
+  bench_sink = bench_null.n;
+}
+
+static void benchCrc(uint32_t calls) {
+  uint32_t acc = 0;
+  for (uint32_t k = 0; k < calls; k++) acc ^= crc32Ieee(bench_buf, BENCH_CRC_LEN);
+  bench_sink = acc;
+}
+
+static void benchCrcTable(uint32_t calls) {
+  uint32_t acc = 0;
+  for (uint32_t k = 0; k < calls; k++) acc ^= crc32IeeeTable(bench_buf, BENCH_CRC_LEN);
+  bench_sink = acc;
+}
+
+static void benchRamp(uint32_t calls, RampProfile prof) {
+  int32_t acc = 0;
+  for (uint32_t k = 0; k < calls; k++) {
+    if (bench_ramp.done() || bench_ramp.profile() != prof) {
+      bench_ramp.reset(0);
+      bench_ramp.start(10000, BENCH_RAMP_US, prof, bench_ramp_t);
+    }
+    bench_ramp_t += 1000;
+    acc += bench_ramp.tick(bench_ramp_t);
+  }
+  bench_sink = (uint32_t)acc;
+}
+static void benchRampLin(uint32_t calls) { benchRamp(calls, RAMP_LINEAR); }
+static void benchRampScurve(uint32_t calls) { benchRamp(calls, RAMP_SCURVE); }
+static void benchRampExp(uint32_t calls) { benchRamp(calls, RAMP_EXP); }
+
+static void benchInaMath(uint32_t calls) {
+  float acc = 0.0f;
+  float v = 14.8f;
+  float vsh = 0.0013f;
+  for (uint32_t k = 0; k < calls; k++) {
+    const InaSample s = inaSampleFrom(v, vsh, SHUNT_OHMS);
+    acc += s.p_W;
+    v -= 0.0001f;
+    vsh += 0.0000025f;
+  }
+  bench_sink = (uint32_t)acc;
+}
+
+struct BenchCase {
+  const char* name;
+  uint32_t calls_min;   // first batch (then doubled up to BENCH_CALLS_MAX)
+  void (*run)(uint32_t calls);
+};
+
+static const BenchCase CASES[] = {
+  { "hx_mean",     1, benchHxMean },
+  { "hx_noise",    1, benchHxNoise },
+  { "hx_smooth",   1, benchHxSmooth },
+  { "csv_frame",   1, benchCsvFrame },
+  { "cli_get",     BENCH_CLI_CALLS_MIN, benchCliLine },
+  { "crc32",       1, benchCrc },
+  { "crc32_table", 1, benchCrcTable },
+  { "ramp_lin",    1, benchRampLin },
+  { "ramp_scurve", 1, benchRampScurve },
+  { "ramp_exp",    1, benchRampExp },
+  { "ina_math",    1, benchInaMath },
+};
+static constexpr uint8_t CASE_COUNT = sizeof(CASES) / sizeof(CASES[0]);
+
+const char* benchCaseName(uint8_t i) {
+  return i < CASE_COUNT ? CASES[i].name : nullptr;
+}
+
+static bool benchMatch(const char* name, const char* filter) {
+  if (!filter || strcmp(filter, "all") == 0) return true;
+  return strncmp(name, filter, strlen(filter)) == 0;
+}
+
+static uint64_t benchTimeNs(const BenchCase& c, uint32_t calls) {
+  const uint64_t t0 = hal::benchClockNs();
+  c.run(calls);
+  return hal::benchClockNs() - t0;
+}
+
+static void benchCase(const BenchCase& c, uint8_t reps) {
+  // warm caches / first-call paths, then grow the batch
+  c.run(1);
+  uint32_t calls = c.calls_min;
+  while (calls < BENCH_CALLS_MAX && benchTimeNs(c, calls) < (uint64_t)BENCH_BATCH_US * 1000ULL) {
+    calls = (calls > BENCH_CALLS_MAX / 2) ? BENCH_CALLS_MAX : calls * 2;
+    hal::wdtFeed();
+  }
+
+  float us[BENCH_REPS_MAX];
+  for (uint8_t r = 0; r < reps; r++) {
+    us[r] = (float)benchTimeNs(c, calls) / 1000.0f / (float)calls;
+    hal::wdtFeed();
+  }
+  // insertion sort: min / median / max
+  for (uint8_t i = 1; i < reps; i++) {
+    const float v = us[i];
+    uint8_t j = i;
+    for (; j > 0 && us[j - 1] > v; j--) us[j] = us[j - 1];
+    us[j] = v;
+  }
+
+  Serial.print("BENCH,"); Serial.print(c.name);
+  Serial.print(','); Serial.print((unsigned long)calls);
+  Serial.print(','); Serial.print(reps);
+  Serial.print(','); Serial.print(us[0], 4);
+  Serial.print(','); Serial.print(us[reps / 2], 4);
+  Serial.print(','); Serial.println(us[reps - 1], 4);
+}
+
+uint8_t benchRun(const char* filter, uint8_t reps, CLI& cli) {
+  bench_cli = &cli;
+  if (reps < 1) reps = 1;
+  if (reps > BENCH_REPS_MAX) reps = BENCH_REPS_MAX;
+
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < CASE_COUNT; i++) {
+    if (!benchMatch(CASES[i].name, filter)) continue;
+    if (n++ == 0) {
+      benchPrepare();
+      Serial.println("BENCHHDR,name,calls,reps,min_us,med_us,max_us");
+    }
+    benchCase(CASES[i], reps);
+  }
+  return n;
+}
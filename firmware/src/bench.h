@@ -0,0 +1,18 @@
+#pragma once
+#include <Arduino.h>
+
+class CLI;
+
+// Microbenchmarks of the per-frame hot paths: BENCH on the Pico, "rotorrig -B" on the host.
+// Every case runs on fixed, seeded inputs except cli_get, a host poll through `cli` (its replies
+// go to a null sink). The call count per batch doubles until a batch takes BENCH_BATCH_US, then
+// `reps` batches are timed on hal::benchClockNs(). Output, one line per case after the header
+// (us per call):
+//   BENCHHDR,name,calls,reps,min_us,med_us,max_us
+//   BENCH,<name>,<calls per batch>,<reps>,<min>,<median>,<max>
+// filter: case name or name prefix; nullptr / "all" = every case. Returns the cases run
+// (0 = no match, nothing printed).
+uint8_t benchRun(const char* filter, uint8_t reps, CLI& cli);
+
+// i-th case name, nullptr past the end (HELP / error replies)
+const char* benchCaseName(uint8_t i);
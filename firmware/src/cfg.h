@@ -2,20 +2,89 @@
 #include <Arduino.h>
 
 // --- Pins ---
-static constexpr uint8_t PIN_DSHOT = 2;     // GP2
+static constexpr uint8_t PIN_DSHOT = 2;     // GP2 (motor 1)
 static constexpr uint8_t PIN_HX_DOUT = 6;   // GP6
 static constexpr uint8_t PIN_HX_SCK  = 7;   // GP7
 
 // --- Serial / logging ---
 static constexpr uint32_t SERIAL_BAUD = 115200;
+static constexpr uint16_t CLI_LINE_MAX = 200;       // command line buffer (chars, excl. terminator)
+static constexpr uint8_t  CLI_MAX_TOK = 16;         // tokens per line
+static constexpr uint8_t  CLI_HASH_SLOTS = 128;     // command lookup slots (power of 2, > 2x commands)
+static constexpr uint16_t QUERY_LINE_MAX = 512;     // STAT? / GET reply line (incl. newline)
 static constexpr uint32_t LOG_PERIOD_MS = 100;     // 10 Hz
+static constexpr uint32_t SWEEP_LOG_PERIOD_MS = 20; // 50 Hz while AUTOTEST SWEEP runs
 static constexpr uint32_t ESC_SEND_PERIOD_US = 1000; // 1 kHz sendThrottle (>=500Hz recommended) :contentReference[oaicite:5]{index=5}
+static constexpr uint32_t ESC_SEND_LATE_US = 100;    // jitter stats: period > PERIOD + this counts as late
 
 // --- ESC / Motor ---
 static constexpr uint16_t DSHOT_SPEED = 300; // DShot300
+
+// Multi-ESC (coaxial / multi-motor). Each ESC gets its own PIO state machine.
+// GP4/GP5 are Wire (INA226), GP6/GP7 are HX711.
+static constexpr uint8_t ESC_COUNT_MAX = 4;
+static constexpr uint8_t ESC_COUNT_DEFAULT = 1;
+static constexpr uint8_t PIN_DSHOT_LIST[ESC_COUNT_MAX] = { PIN_DSHOT, 3, 8, 9 };
 static constexpr uint16_t DSHOT_MIN = 0;
 static constexpr uint16_t DSHOT_MAX = 2000; // library convention
 static constexpr uint32_t TELEMETRY_TIMEOUT_MS = 500; // if no RPM updates -> failsafe
+static constexpr uint16_t BDSHOT_ERR_WINDOW = 500;    // sends in the error-rate window (0.5 s @ 1 kHz)
+static constexpr uint16_t ERPM_HIST_LEN = 256;        // accepted eRPM history ring (~256 ms @ 1 kHz)
+static constexpr uint8_t  ERPM_HAMPEL_WIN = 7;        // Hampel window (previous raw decodes, odd)
+static constexpr uint8_t  RPM_STREAM_MAX_PER_LOOP = 16; // bound serial work per loop for RPMSTREAM
+static constexpr uint32_t EDT_TEMP_STALE_MS = 5000;   // EDT temperature older than this -> NaN
+static constexpr uint8_t  DSHOT_CMD_EDT_ENABLE = 13;  // DShot command: extended telemetry on (until power-off)
+static constexpr uint8_t  DSHOT_CMD_REPEAT = 6;       // settings commands count only after 6 frames in a row
+
+// --- Closed-loop RPM mode (PI(D) on filtered eRPM, runs at send rate) ---
+static constexpr float RPM_CTRL_KP_DEFAULT = 0.005f;  // % throttle per RPM error
+static constexpr float RPM_CTRL_KI_DEFAULT = 0.05f;   // % throttle per RPM*s
+static constexpr float RPM_CTRL_KD_DEFAULT = 0.0f;    // % throttle per RPM/s (on measurement)
+// RPMPID clamps its gains to these: with any int32 RPM error / step the Q24 products of the
+// send-rate controller (esc_bdshot.cpp) then stay inside int64
+static constexpr float RPM_CTRL_KP_MAX = 1.0f;
+static constexpr float RPM_CTRL_KI_MAX = 10.0f;
+static constexpr float RPM_CTRL_KD_MAX = 0.0001f;
+static constexpr float RPM_CTRL_MAX_SLEW_PCT_PER_S = 50.0f; // controller output rate limit
+static constexpr float RPM_CTRL_NO_TEL_MAX_PCT = 15.0f;     // no eRPM seen yet -> failsafe above this
+static constexpr uint8_t RPM_CTRL_FILT_SHIFT = 3;           // eRPM IIR alpha = 1/8 per accepted sample
+
+// --- Throttle calibration sweep (THRCAL) ---
+static constexpr float    THRCAL_SWEEP_PCT_PER_S = 2.0f;  // slow enough for RPM to follow throttle
+static constexpr uint32_t THRCAL_SPIN_RPM = 300;          // filtered RPM that counts as "spinning"
+static constexpr uint32_t THRCAL_SPIN_HOLD_MS = 100;      // ...sustained this long
+
+// --- Autotest steady-state detection (rolling window over log frames) ---
+static constexpr uint8_t  STEADY_WIN = 20;              // frames (2 s @ 10 Hz)
+static constexpr uint32_t STEADY_MIN_DWELL_MS = 3000;   // steady this long -> next step
+static constexpr float STEADY_THRUST_TOL_G = 2.0f;      // std and drift over window, absolute floor
+static constexpr float STEADY_THRUST_TOL_REL = 0.01f;   // ...or fraction of mean
+static constexpr float STEADY_RPM_TOL = 50.0f;
+static constexpr float STEADY_RPM_TOL_REL = 0.01f;
+static constexpr float STEADY_CURRENT_TOL_A = 0.05f;
+static constexpr float STEADY_CURRENT_TOL_REL = 0.02f;
+
+// --- Batch queue (BATCH): gaps end when the rig is back at rest ---
+static constexpr uint8_t  BATCH_MAX = 16;               // queued runs
+static constexpr uint8_t  BATCH_GATE_WIN = 50;          // frames (5 s @ 10 Hz)
+static constexpr uint16_t BATCH_GAP_MIN_S_DEFAULT = 30; // gap never shorter than this (BATCH GAP)
+static constexpr uint32_t BATCH_GAP_MAX_S = 1800;       // gate timeout
+static constexpr float BATCH_ESC_TEMP_MAX_C = 40.0f;    // EDT temperature (skipped without EDT)
+static constexpr float BATCH_IDLE_I_MAX_A = 0.5f;       // mean current at idle
+static constexpr float BATCH_VBUS_DRIFT_V = 0.02f;      // supply recovered: drift over the window
+static constexpr float BATCH_ZERO_TOL_G = 2.0f;         // load cell back at zero: |mean|
+static constexpr float BATCH_ZERO_STD_G = 1.0f;         // ...and std / drift over the window
+
+// --- Step response capture (STEPRESP) ---
+static constexpr uint32_t STEPRESP_PRE_MS = 200;        // kept before the step
+static constexpr uint32_t STEPRESP_POST_MS = 1000;      // captured after the step
+static constexpr uint32_t STEPRESP_SETTLE_MS = 1500;    // hold at <from> before triggering
+static constexpr uint32_t STEPRESP_INA_PERIOD_US = 1000; // current sampling (INA226 in fast mode)
+static constexpr float    STEPRESP_SETTLE_BAND = 0.05f; // settling band, fraction of the step
+static constexpr uint16_t STEPRESP_RPM_LEN = 1280;      // ring sizes cover PRE+POST at the source rate
+static constexpr uint16_t STEPRESP_I_LEN = 1280;
+static constexpr uint16_t STEPRESP_THRUST_LEN = 128;
+static constexpr uint8_t  STEPRESP_STREAM_PER_LOOP = 32;
 
 // --- INA226 ---
 static constexpr uint8_t INA226_ADDR_DEFAULT = 0x40; // change if needed
@@ -26,6 +95,38 @@ static constexpr float INA_EXPECTED_MAX_CURRENT_A = 60.0f; // safe default; twea
 static constexpr uint8_t HX711_SPS_TARGET = 80; // requirement
 static constexpr uint8_t HX_SAMPLES_PER_LOG = 8; // ~80 SPS / 10 Hz
 
+// --- Trip limits (LIMIT): checked at sensor rate, a trip latches a failsafe ---
+static constexpr uint8_t  PIN_INA_ALERT = 10;            // INA226 ALERT (open drain, active low), pulled up
+static constexpr float    LIMIT_I_MAX_A_DEFAULT = 50.0f; // also the hardware ALERT threshold
+static constexpr uint32_t LIMIT_POLL_US = 2000;          // shunt read while a motor is spinning
+static constexpr uint8_t  LIMIT_VBUS_EVERY = 16;         // bus voltage every Nth poll (power limit)
+static constexpr uint8_t  LIMIT_CONFIRM = 2;             // consecutive samples over a software limit
+static constexpr float    LIMIT_TRIP_RAMP_S = 0.3f;      // LIMIT ACTION RAMP: full-swing ramp to zero
+
+// --- Flash key/value store (calibrations, programs, presets) ---
+static constexpr uint8_t  KV_SECTORS_MAX = 16;       // 4 KB sectors used from the reserved flash region
+static constexpr uint8_t  KV_KEYS_MAX = 64;          // distinct keys
+static constexpr uint8_t  KV_PENDING_MAX = 8;        // writes queued until the motor stops
+static constexpr uint16_t KV_PENDING_BYTES = 2048;
+
+// --- CRC-32 ---
+static constexpr size_t CRC_DMA_MIN_LEN = 64;        // shorter buffers: table CRC beats the DMA setup
+
+// --- Loop supervision ---
+static constexpr uint32_t LOOP_OVERRUN_US = 20000;   // loop() pass longer than this counts as an overrun
+static constexpr uint32_t LOOP_STALL_MS = 250;       // no loop() pass for this long -> LOOP_STALL soft stop
+static constexpr float    LOOP_STALL_RAMP_S = 1.0f;  // ...ramp time for a full 100 % -> 0 swing
+static constexpr uint32_t WDT_TIMEOUT_MS = 2000;     // hardware watchdog (reboot), fed once per pass
+static_assert(WDT_TIMEOUT_MS > LOOP_STALL_MS + (uint32_t)(LOOP_STALL_RAMP_S * 1000.0f),
+              "watchdog must leave time for the stall ramp-down");
+
+// --- BENCH microbenchmarks (motor stopped: the loop waits while they run) ---
+static constexpr uint32_t BENCH_BATCH_US = 2000;     // calls per batch double until one batch takes this long
+static constexpr uint32_t BENCH_CALLS_MAX = 1UL << 20; // ...or reach this
+static constexpr uint32_t BENCH_CLI_CALLS_MIN = 256;  // cli_get: first batch size (parser + reply paths vary)
+static constexpr uint8_t  BENCH_REPS_DEFAULT = 11;   // timed batches per case (min / median / max)
+static constexpr uint8_t  BENCH_REPS_MAX = 64;
+
 // --- Safety ---
 static constexpr uint32_t STARTUP_ARM_ZERO_MS = 400; // send zero a bit at boot
 static constexpr float VBAT_PRESENT_THRESHOLD_V = 1.0f;
@@ -1,88 +1,211 @@
 #include "cli.h"
 #include <Wire.h>
 
-#include "esc_bdshot.h"
+#include "esc_group.h"
 #include "sensors_hx711.h"
 #include "sensors_ina226.h"
 #include "autotest.h"
 #include "meta.h"
+#include "csv.h"
+#include "query.h"
+#include "bench.h"
+#include "crc.h"
 
-static float parseFloatSafe(const String& s, float def = NAN) {
+static float parseFloatSafe(const char* s, float def = NAN) {
   char* endp = nullptr;
-  float v = strtof(s.c_str(), &endp);
-  if (endp == s.c_str()) return def;
+  float v = strtof(s, &endp);
+  if (endp == s) return def;
   return v;
 }
 
-static long parseLongSafe(const String& s, long def = -1) {
+static long parseLongSafe(const char* s, long def = -1) {
   char* endp = nullptr;
-  long v = strtol(s.c_str(), &endp, 10);
-  if (endp == s.c_str()) return def;
+  long v = strtol(s, &endp, 10);
+  if (endp == s) return def;
   return v;
 }
 
+// === Line parsing: no heap, the line buffer is split in place ===
+static constexpr char cliLower(char c) { return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c; }
+
+static void cliLowerInPlace(char* s) {
+  for (; *s; s++) *s = cliLower(*s);
+}
+
+// case-insensitive token compare, `word` in lowercase
+static bool tokIs(const char* t, const char* word) {
+  while (*t && *word) {
+    if (cliLower(*t) != *word) return false;
+    t++;
+    word++;
+  }
+  return *t == *word;
+}
+
+// splits on spaces/tabs, NUL-terminates each token; extra tokens are dropped
+static int cliTokenize(char* line, char** tok, int max_tok) {
+  int n = 0;
+  char* p = line;
+  while (*p && n < max_tok) {
+    while (*p == ' ' || *p == '\t') p++;
+    if (!*p) break;
+    tok[n++] = p;
+    while (*p && *p != ' ' && *p != '\t') p++;
+    if (*p) *p++ = '\0';
+  }
+  return n;
+}
+
+// FNV-1a over the lowercase name
+static constexpr uint32_t cliHash(const char* s) {
+  uint32_t h = 2166136261UL;
+  for (; *s; s++) {
+    h ^= (uint8_t)cliLower(*s);
+    h *= 16777619UL;
+  }
+  return h;
+}
+
+struct CliCmd {
+  const char* name;       // lowercase
+  uint8_t min_args;       // tokens needed after the name
+  const char* usage;      // "ERR <usage>" if fewer; nullptr = "ERR <name>"
+  void (CLI::*fn)(char** tok, int n);
+};
+
+// open-addressing index into the command table, built at compile time
+struct CliIndex {
+  uint8_t slot[CLI_HASH_SLOTS]{};   // table index + 1, 0 = empty
+};
+
+template <size_t N>
+static constexpr CliIndex cliBuildIndex(const CliCmd (&cmds)[N]) {
+  static_assert(N < CLI_HASH_SLOTS / 2, "CLI_HASH_SLOTS too small for the command table");
+  CliIndex idx{};
+  for (size_t i = 0; i < N; i++) {
+    uint32_t k = cliHash(cmds[i].name) & (CLI_HASH_SLOTS - 1);
+    while (idx.slot[k]) k = (k + 1) & (CLI_HASH_SLOTS - 1);
+    idx.slot[k] = (uint8_t)(i + 1);
+  }
+  return idx;
+}
+
+template <size_t N>
+static const CliCmd* cliFind(const CliCmd (&cmds)[N], const CliIndex& idx, const char* name) {
+  uint32_t k = cliHash(name) & (CLI_HASH_SLOTS - 1);
+  while (idx.slot[k]) {
+    const CliCmd& c = cmds[idx.slot[k] - 1];
+    if (strcmp(c.name, name) == 0) return &c;
+    k = (k + 1) & (CLI_HASH_SLOTS - 1);
+  }
+  return nullptr;
+}
+
 static void printFinite(float v, int prec, const char* suffix = "") {
   if (!isfinite(v)) Serial.print("NaN");
   else Serial.print(v, prec);
   if (suffix && suffix[0]) Serial.print(suffix);
 }
 
-void CLI::begin() { buf_.reserve(128); }
+void CLI::begin() {
+  store_.begin();
+}
 
-void CLI::bind(EscBdshot* esc, SensorsHx711* hx, SensorsIna226* ina, Meta* meta, AutoTest* at) {
+void CLI::bind(EscGroup* esc, SensorsHx711* hx, SensorsIna226* ina, Meta* meta, AutoTest* at,
+               const FrameSnapshot* live, const LoopGuard* guard, LimitGuard* limits) {
   esc_ = esc;
   hx_ = hx;
   ina_ = ina;
   meta_ = meta;
   at_ = at;
+  live_ = live;
+  guard_ = guard;
+  limits_ = limits;
 }
 
-void CLI::setLive(float thrust_g, float thrust_N,
-                  float vbus_V, float i_A, float p_W,
-                  uint32_t erpm, uint32_t rpm, float bdshot_err_pct,
-                  int32_t hx_raw, int32_t hx_offset, float hx_scale,
-                  bool hx_cal_valid, bool hx_inverted,
-                  int32_t hx_noise_pp) {
-  st_thrust_g_ = isfinite(thrust_g) ? thrust_g : NAN;
-  st_thrust_N_ = isfinite(thrust_N) ? thrust_N : NAN;
-
-  st_vbus_V_ = isfinite(vbus_V) ? vbus_V : NAN;
-  st_i_A_    = isfinite(i_A) ? i_A : NAN;
-  st_p_W_    = isfinite(p_W) ? p_W : NAN;
-
-  st_erpm_ = erpm;
-  st_rpm_  = rpm;
-  st_bdshot_err_pct_ = isfinite(bdshot_err_pct) ? bdshot_err_pct : 100.0f;
-
-  st_hx_raw_       = hx_raw;
-  st_hx_offset_    = hx_offset;
-  st_hx_scale_     = isfinite(hx_scale) ? hx_scale : NAN;
-  st_hx_cal_valid_ = hx_cal_valid;
-  st_hx_inverted_  = hx_inverted;
-  st_hx_noise_pp_  = hx_noise_pp;
+// Copy the latest published frame into lf_ (kept as is if none / writer racing).
+void CLI::pullLive() {
+  if (live_) live_->read(lf_);
 }
 
-static void toLowerInPlace(String& s) { s.toLowerCase(); }
-
 void CLI::tick() {
   while (Serial.available()) {
     char c = (char)Serial.read();
     if (c == '\r') continue;
     if (c == '\n') {
-      if (buf_.length() > 0) handleLine(buf_);
-      buf_ = "";
+      // an over-long line is dropped whole rather than run truncated
+      if (line_overflow_) Serial.println("ERR line_too_long");
+      else if (line_len_ > 0) { line_[line_len_] = '\0'; handleLine(line_); }
+      line_len_ = 0;
+      line_overflow_ = false;
+    } else if (line_len_ < CLI_LINE_MAX) {
+      line_[line_len_++] = c;
     } else {
-      if (buf_.length() < 200) buf_ += c;
+      line_overflow_ = true;
     }
   }
 
-  // non-blocking sequencer for CORE2 autotest
+  // non-blocking sequencer for CORE2 / BATCH autotest
   serviceAutotestSequence();
 
+  // THRCAL sweep / STEPRESP capture (non-blocking)
+  serviceThrCal();
+  serviceStepResp();
+
   // soft-stop service (runs until fully stopped)
   serviceSoftStop();
 }
 
+const char* CLI::busyJob() const {
+  if (thrcal_.active()) return "THRCAL";
+  if (stepresp_.active()) return "STEPRESP";
+  if (batch_phase_ == 2) return "BATCH";   // gap: motor idles for the cooldown gate
+  return nullptr;
+}
+
+// === STEP RESPONSE ===
+void CLI::serviceStepResp() {
+  if (!esc_) return;
+  stepresp_.tick(*esc_, ina_, hx_);
+
+  // motor is released through the normal soft stop as soon as the capture is complete
+  if (stepresp_.takeCaptureDone() && !stop_active_) beginSoftStop("STEPRESP");
+
+  const StepResp::State r = stepresp_.takeResult();
+  if (r == StepResp::DONE) Serial.println("OK STEPRESP DONE");
+  else if (r == StepResp::FAIL) { Serial.print("ERR STEPRESP "); Serial.println(stepresp_.error()); }
+}
+
+// === THROTTLE CALIBRATION ===
+void CLI::serviceThrCal() {
+  if (!esc_) return;
+  thrcal_.tick(*esc_);
+
+  const ThrottleCal::State r = thrcal_.takeResult();
+  if (r == ThrottleCal::DONE) {
+    Serial.print("OK THRCAL DONE m="); Serial.print(thrcal_.motor() + 1);
+    Serial.print(" spin_pct="); printFinite(thrcal_.spinPct(), 2, "");
+    Serial.print(" start_dshot="); Serial.print(thrcal_.result().start_dshot);
+    Serial.println(" (use THRCAL SAVE to persist)");
+  } else if (r == ThrottleCal::FAIL) {
+    Serial.print("ERR THRCAL "); Serial.print(thrcal_.error());
+    Serial.print(" m="); Serial.println(thrcal_.motor() + 1);
+  }
+}
+
+void CLI::printThrCal(uint8_t m) {
+  const ThrCalData& tc = esc_->motor(m).throttleCal();
+  Serial.print("THRCAL m="); Serial.print(m + 1);
+  Serial.print(" valid="); Serial.print(tc.valid ? 1 : 0);
+  Serial.print(" start_dshot="); Serial.print(tc.start_dshot);
+  Serial.print(" rpm@5%:");
+  for (uint8_t k = 0; k < ThrCalData::RPM_PTS; k++) {
+    Serial.print(k ? "," : " ");
+    Serial.print(tc.rpm_at[k]);
+  }
+  Serial.println();
+}
+
 // === SOFT STOP ===
 void CLI::beginSoftStop(const char* reason_tag) {
   stop_reason_ = reason_tag ? reason_tag : "STOP";
@@ -91,7 +214,7 @@ void CLI::beginSoftStop(const char* reason_tag) {
 
   if (esc_) {
     // Smooth ramp to 0% to avoid abrupt torque change / spikes
-    esc_->setTargetThrottlePct(0.0f, stop_ramp_s_);
+    esc_->setTargetThrottlePct(0.0f, stop_ramp_s_, ramp_prof_);
   }
 
   Serial.print("OK STOPPING ramp_s=");
@@ -129,235 +252,530 @@ void CLI::serviceSoftStop() {
   }
 }
 
-void CLI::handleLine(const String& line) {
-  const int maxTok = 16;
-  String tok[maxTok];
-  int n = 0;
+void CLI::handleLine(char* line) {
+  char* tok[CLI_MAX_TOK];
+  int n = cliTokenize(line, tok, CLI_MAX_TOK);
+  if (n == 0) return;
 
-  int i = 0;
-  while (i < (int)line.length() && n < maxTok) {
-    while (i < (int)line.length() && line[i] == ' ') i++;
-    if (i >= (int)line.length()) break;
-    int j = i;
-    while (j < (int)line.length() && line[j] != ' ') j++;
-    tok[n++] = line.substring(i, j);
-    i = j;
+  // optional "@<seq>" request tag (host pipelining): echoed on the reply
+  char** args = tok;
+  const char* tag = nullptr;
+  if (tok[0][0] == '@') {
+    tag = tok[0];
+    args++;
+    n--;
+    if (n == 0) { Serial.print(tag); Serial.println(" END"); return; }
   }
-  if (n == 0) return;
+  cliLowerInPlace(args[0]);
+
+  // name (lowercase), args needed after the name, usage for "ERR <usage>", handler
+  static constexpr CliCmd CMDS[] = {
+    { "help", 0, nullptr, &CLI::cmdHelp },
+    { "status", 0, nullptr, &CLI::cmdStatus },
+    { "stopramp", 1, "stopramp <sec>", &CLI::cmdStopRamp },
+    { "rampprof", 1, "rampprof <lin|scurve|exp>", &CLI::cmdRampProf },
+    { "log", 1, "log <0|1>", &CLI::cmdLog },
+    { "adaptive", 1, "adaptive <0|1>", &CLI::cmdAdaptive },
+    { "rpmstream", 1, "rpmstream <0|1>", &CLI::cmdRpmStream },
+    { "jitter", 0, nullptr, &CLI::cmdJitter },
+    { "tare", 0, nullptr, &CLI::cmdTare },
+    { "cal", 1, "cal <mass_g>", &CLI::cmdCal },
+    { "caltrim", 1, "caltrim <mass_g>", &CLI::cmdCalTrim },
+    { "save", 0, nullptr, &CLI::cmdSave },
+    { "load", 0, nullptr, &CLI::cmdLoad },
+    { "resetcal", 0, nullptr, &CLI::cmdResetCal },
+    { "setmeta", 7, "setmeta <test_id> <motor_id> <kv> <prop> <battery_s> <esc_fw> <pole_pairs>", &CLI::cmdSetMeta },
+    { "start", 0, nullptr, &CLI::cmdStart },
+    { "estop", 0, nullptr, &CLI::cmdEstop },
+    { "stop", 0, nullptr, &CLI::cmdStop },
+    { "autotest", 1, "autotest <core|core2|rpm|sweep|stop> [gap_s]", &CLI::cmdAutotest },
+    { "batch", 0, nullptr, &CLI::cmdBatch },
+    { "prog", 1, "prog <begin|step|end|save|list|show|run|del>", &CLI::cmdProg },
+    { "preset", 1, "preset <save|load|list|show|del> [name]", &CLI::cmdPreset },
+    { "rpm", 1, "rpm <target> [motor]", &CLI::cmdRpm },
+    { "rpmpid", 2, "rpmpid <kp> <ki> [kd]", &CLI::cmdRpmPid },
+    { "throttle", 1, "throttle <pct> [motor]", &CLI::cmdThrottle },
+    { "thrcal", 0, nullptr, &CLI::cmdThrCal },
+    { "stepresp", 2, "stepresp <from_pct> <to_pct>", &CLI::cmdStepResp },
+    { "escs", 1, "escs <1..4>", &CLI::cmdEscs },
+    { "i2cscan", 0, nullptr, &CLI::cmdI2cScan },
+    { "limit", 0, nullptr, &CLI::cmdLimit },
+    { "stat?", 0, nullptr, &CLI::cmdStat },
+    { "get", 1, "get <key>[,<key>...]", &CLI::cmdGet },
+    { "bench", 0, nullptr, &CLI::cmdBench },
+  };
+  static constexpr CliIndex IDX = cliBuildIndex(CMDS);
+
+  reply_tag_ = tag;
+  reply_tagged_ = false;
+  const CliCmd* c = cliFind(CMDS, IDX, args[0]);
+  if (!c) Serial.println("ERR unknown_cmd");
+  else if (n - 1 < c->min_args) { Serial.print("ERR "); Serial.println(c->usage ? c->usage : c->name); }
+  else (this->*(c->fn))(args, n);
+
+  // multi-line / legacy replies: the tag closes them
+  if (tag && !reply_tagged_) { Serial.print(tag); Serial.println(" END"); }
+  reply_tag_ = nullptr;
+}
 
-  String cmd = tok[0];
-  toLowerInPlace(cmd);
+void CLI::cmdHelp(char**, int) {
+  Serial.println("CMDS: HELP, STATUS, SETMETA ..., LOG <0|1>, START, STOP, ESTOP");
+  Serial.println("      RPMSTREAM <0|1>, RPM <target> [motor], RPMPID <kp> <ki> [kd]");
+  Serial.println("      JITTER [reset], ADAPTIVE <0|1>");
+  Serial.println("      STOPRAMP <sec>, RAMPPROF <lin|scurve|exp>");
+  Serial.println("      THROTTLE <pct> [motor], ESCS <1..4>, TARE, CAL <mass_g>, CALTRIM <mass_g>");
+  Serial.println("      AUTOTEST <core|core2|stop> [gap_s], AUTOTEST RPM <step_s> <rpm1> [rpm2..], I2CSCAN");
+  Serial.println("      AUTOTEST SWEEP <from> <to> <seconds> [up|updown], STEPRESP <from> <to>");
+  Serial.println("      PROG BEGIN <name>, PROG STEP <thr|rpm> <value> <ramp_s> <hold_s> [lin|scurve|exp], PROG END");
+  Serial.println("      PROG <save|list|show|run|del> [name]");
+  Serial.println("      PRESET <save|load|show|del> <name>, PRESET LIST");
+  Serial.println("      THRCAL [motor] [max_pct], THRCAL <show|save|clear> [motor], THRCAL STOP");
+  Serial.println("      BATCH ADD <prog|core> [test_id|-] [prop|-], BATCH <list|clear|run|stop>, BATCH GAP <min_s>");
+  Serial.println("      LIMIT [i|p|thrust <value|off>], LIMIT ACTION <cut|ramp>");
+  Serial.println("      SAVE, LOAD, RESETCAL");
+  Serial.println("      STAT?, GET <key>[,<key>...]  (prefix \"@<seq> \" to tag the reply)");
+  Serial.println("      BENCH [case|all] [reps]  (motor stopped)");
+}
 
-  if (cmd == "help") {
-    Serial.println("CMDS: HELP, STATUS, SETMETA ..., LOG <0|1>, START, STOP, ESTOP");
-    Serial.println("      STOPRAMP <sec>");
-    Serial.println("      THROTTLE <pct>, TARE, CAL <mass_g>, CALTRIM <mass_g>");
-    Serial.println("      AUTOTEST <core|core2|stop> [gap_s], I2CSCAN");
-    Serial.println("      SAVE, LOAD, RESETCAL");
-    return;
-  }
+void CLI::cmdStatus(char**, int) {
+  printStatus();
+}
 
-  if (cmd == "status") { printStatus(); return; }
+void CLI::cmdStopRamp(char** tok, int) {
+  float s = parseFloatSafe(tok[1], NAN);
+  if (!isfinite(s)) { Serial.println("ERR stopramp"); return; }
+  // sane bounds
+  if (s < 0.2f) s = 0.2f;
+  if (s > 8.0f) s = 8.0f;
+  stop_ramp_s_ = s;
+  Serial.print("OK STOPRAMP ");
+  printFinite(stop_ramp_s_, 2, " s\n");
+}
 
-  if (cmd == "stopramp") {
-    if (n < 2) { Serial.println("ERR stopramp <sec>"); return; }
-    float s = parseFloatSafe(tok[1], NAN);
-    if (!isfinite(s)) { Serial.println("ERR stopramp"); return; }
-    // sane bounds
-    if (s < 0.2f) s = 0.2f;
-    if (s > 8.0f) s = 8.0f;
-    stop_ramp_s_ = s;
-    Serial.print("OK STOPRAMP ");
-    printFinite(stop_ramp_s_, 2, " s\n");
-    return;
-  }
+void CLI::cmdRampProf(char** tok, int) {
+  RampProfile p;
+  if (!rampProfileParse(tok[1], p)) { Serial.println("ERR rampprof <lin|scurve|exp>"); return; }
+  ramp_prof_ = p;
+  Serial.print("OK RAMPPROF "); Serial.println(rampProfileName(ramp_prof_));
+}
 
-  if (cmd == "log") {
-    if (n < 2) { Serial.println("ERR log <0|1>"); return; }
-    long v = parseLongSafe(tok[1], -1);
-    if (v != 0 && v != 1) { Serial.println("ERR log <0|1>"); return; }
-    csv_on_ = (v == 1);
-    Serial.println(csv_on_ ? "OK LOG 1" : "OK LOG 0");
-    return;
-  }
+void CLI::cmdLog(char** tok, int) {
+  long v = parseLongSafe(tok[1], -1);
+  if (v != 0 && v != 1) { Serial.println("ERR log <0|1>"); return; }
+  csv_on_ = (v == 1);
+  Serial.println(csv_on_ ? "OK LOG 1" : "OK LOG 0");
+}
 
-  if (cmd == "tare") {
-    if (!hx_) { Serial.println("ERR TARE"); return; }
-    hx_->tareTrimStart(200, 20);
-    Serial.println("OK TARE (trim 200,20%)");
-    return;
-  }
+void CLI::cmdAdaptive(char** tok, int) {
+  if (!at_) { Serial.println("ERR adaptive <0|1>"); return; }
+  long v = parseLongSafe(tok[1], -1);
+  if (v != 0 && v != 1) { Serial.println("ERR adaptive <0|1>"); return; }
+  at_->setAdaptive(v == 1);
+  Serial.println(at_->adaptive() ? "OK ADAPTIVE 1" : "OK ADAPTIVE 0");
+}
 
-  if (cmd == "cal") {
-    if (n < 2) { Serial.println("ERR cal <mass_g>"); return; }
-    float m = parseFloatSafe(tok[1], NAN);
-    if (!hx_ || isnan(m) || m <= 0.0f) { Serial.println("ERR cal"); return; }
-    bool ok = hx_->calibrateWithMass(m);
-    Serial.println(ok ? "OK CAL" : "ERR CAL");
-    return;
-  }
+void CLI::cmdRpmStream(char** tok, int) {
+  long v = parseLongSafe(tok[1], -1);
+  if (v != 0 && v != 1) { Serial.println("ERR rpmstream <0|1>"); return; }
+  rpm_stream_on_ = (v == 1);
+  Serial.println(rpm_stream_on_ ? "OK RPMSTREAM 1" : "OK RPMSTREAM 0");
+}
 
-  if (cmd == "caltrim") {
-    if (n < 2) { Serial.println("ERR caltrim <mass_g>"); return; }
-    float m = parseFloatSafe(tok[1], NAN);
-    if (!hx_ || isnan(m) || m <= 0.0f) { Serial.println("ERR caltrim"); return; }
-    hx_->calTrimStart(m, 200, 20);
-    Serial.println("OK CALTRIM (200,20%)");
-    return;
+void CLI::cmdJitter(char** tok, int n) {
+  if (!esc_) { Serial.println("ERR jitter"); return; }
+  const char* sub = (n >= 2) ? tok[1] : "";
+  const bool reset = tokIs(sub, "reset");
+  for (uint8_t i = 0; i < esc_->count(); i++) {
+    const EscJitterStats js = esc_->motor(i).sendJitter(reset);
+    Serial.print("JITTER m="); Serial.print(i + 1);
+    Serial.print(" sched="); Serial.print(esc_->sendTimerOn() ? "TIMER" : "POLLED");
+    Serial.print(" n="); Serial.print(js.n);
+    Serial.print(" mean_us="); printFinite(js.mean_us, 2, "");
+    Serial.print(" std_us="); printFinite(js.std_us, 2, "");
+    Serial.print(" min_us="); Serial.print(js.period_min_us);
+    Serial.print(" max_us="); Serial.print(js.period_max_us);
+    Serial.print(" late="); Serial.println(js.late);
   }
+  if (reset) Serial.println("OK JITTER RESET");
+}
 
-  if (cmd == "save") {
-    if (!hx_) { Serial.println("ERR SAVE"); return; }
-    Serial.println(hx_->saveCal() ? "OK SAVE" : "ERR SAVE");
-    return;
-  }
+void CLI::cmdTare(char**, int) {
+  if (!hx_) { Serial.println("ERR TARE"); return; }
+  hx_->tareTrimStart(200, 20);
+  Serial.println("OK TARE (trim 200,20%)");
+}
 
-  if (cmd == "load") {
-    if (!hx_) { Serial.println("ERR LOAD"); return; }
-    Serial.println(hx_->loadCal() ? "OK LOAD" : "ERR LOAD");
-    return;
-  }
+void CLI::cmdCal(char** tok, int) {
+  float m = parseFloatSafe(tok[1], NAN);
+  if (!hx_ || isnan(m) || m <= 0.0f) { Serial.println("ERR cal"); return; }
+  bool ok = hx_->calibrateWithMass(m);
+  Serial.println(ok ? "OK CAL" : "ERR CAL");
+}
 
-  if (cmd == "resetcal") {
-    if (!hx_) { Serial.println("ERR RESETCAL"); return; }
-    hx_->resetCal();
-    Serial.println("OK RESETCAL");
-    return;
-  }
+void CLI::cmdCalTrim(char** tok, int) {
+  float m = parseFloatSafe(tok[1], NAN);
+  if (!hx_ || isnan(m) || m <= 0.0f) { Serial.println("ERR caltrim"); return; }
+  hx_->calTrimStart(m, 200, 20);
+  Serial.println("OK CALTRIM (200,20%)");
+}
+
+void CLI::cmdSave(char**, int) {
+  if (!hx_) { Serial.println("ERR SAVE"); return; }
+  Serial.println(hx_->saveCal() ? "OK SAVE" : "ERR SAVE");
+}
 
-  if (cmd == "setmeta") {
-    if (!meta_) { Serial.println("ERR meta"); return; }
-    if (n < 8) {
-      Serial.println("ERR setmeta <test_id> <motor_id> <kv> <prop> <battery_s> <esc_fw> <pole_pairs>");
+void CLI::cmdLoad(char**, int) {
+  if (!hx_) { Serial.println("ERR LOAD"); return; }
+  Serial.println(hx_->loadCal() ? "OK LOAD" : "ERR LOAD");
+}
+
+void CLI::cmdResetCal(char**, int) {
+  if (!hx_) { Serial.println("ERR RESETCAL"); return; }
+  hx_->resetCal();
+  Serial.println("OK RESETCAL");
+}
+
+void CLI::cmdSetMeta(char** tok, int) {
+  if (!meta_) { Serial.println("ERR meta"); return; }
+  // all or nothing: an over-long ID would tag every row and batch session with a wrong one
+  static const char* const TEXT_FIELDS[] = { "test_id", "motor_id", nullptr, "prop", nullptr, "esc_fw" };
+  for (uint8_t i = 0; i < 6; i++) {
+    if (TEXT_FIELDS[i] && !metaFits(tok[i + 1])) {
+      Serial.print("ERR SETMETA "); Serial.print(TEXT_FIELDS[i]); Serial.println("_too_long");
       return;
     }
-    meta_->test_id = tok[1];
-    meta_->motor_id = tok[2];
-    meta_->kv = (int)parseLongSafe(tok[3], -1);
-    meta_->prop = tok[4];
-    meta_->battery_s = (int)parseLongSafe(tok[5], -1);
-    meta_->esc_fw = tok[6];
-    meta_->pole_pairs = (uint8_t)parseLongSafe(tok[7], 7);
-    if (esc_) esc_->setPolePairs(meta_->pole_pairs);
-    Serial.println("OK SETMETA");
-    return;
   }
+  metaSet(meta_->test_id, tok[1]);
+  metaSet(meta_->motor_id, tok[2]);
+  meta_->kv = (int)parseLongSafe(tok[3], -1);
+  metaSet(meta_->prop, tok[4]);
+  meta_->battery_s = (int)parseLongSafe(tok[5], -1);
+  metaSet(meta_->esc_fw, tok[6]);
+  meta_->pole_pairs = (uint8_t)parseLongSafe(tok[7], 7);
+  if (esc_) esc_->setPolePairs(meta_->pole_pairs);
+  Serial.println("OK SETMETA");
+}
 
-  if (cmd == "start") {
-    armed_ = true;
-    stop_active_ = false; // cancel any pending stop
-    if (esc_) esc_->clearFailsafe();
-    Serial.println("OK START");
-    return;
-  }
+void CLI::cmdStart(char**, int) {
+  armed_ = true;
+  stop_active_ = false; // cancel any pending stop
+  if (esc_) esc_->clearFailsafe();
+  Serial.println("OK START");
+}
+
+// === ESTOP (hard) ===
+void CLI::cmdEstop(char**, int) {
+  finishBatch("OK BATCH ABORT");
+  armed_ = false;
+  at_mode_ = 0;
+  at_seq_active_ = false;
+  at_seq_phase_ = 0;
+  if (at_) at_->stop();
+  stop_active_ = false;
+  if (esc_) thrcal_.abort(*esc_);
+  stepresp_.abort(ina_);
+
+  if (esc_) esc_->stopNow();
+
+  if (csv_on_) { csv_on_ = false; Serial.println("OK LOG 0"); }
+  Serial.println("OK ESTOP");
+}
+
+// === STOP (soft) ===
+void CLI::cmdStop(char**, int) {
+  finishBatch("OK BATCH ABORT");
+  armed_ = false;
+  at_mode_ = 0;
+  at_seq_active_ = false;
+  at_seq_phase_ = 0;
+  if (at_) at_->stop();
+  if (esc_) thrcal_.abort(*esc_);
+  stepresp_.abort(ina_);
+
+  // do NOT stopNow immediately – start soft stop sequence
+  if (!stop_active_) beginSoftStop("STOP");
+
+}
 
-  // === ESTOP (hard) ===
-  if (cmd == "estop") {
-    armed_ = false;
+void CLI::cmdAutotest(char** tok, int n) {
+  if (!at_ || !esc_) { Serial.println("ERR autotest"); return; }
+  if (!armed_) { Serial.println("ERR NOT_ARMED (use start)"); return; }
+  const char* sub = tok[1];
+
+  if (tokIs(sub, "stop")) {
+    finishBatch("OK BATCH ABORT");
     at_mode_ = 0;
     at_seq_active_ = false;
     at_seq_phase_ = 0;
-    if (at_) at_->stop();
-    stop_active_ = false;
+    at_->stop();
 
-    if (esc_) esc_->stopNow();
+    // soft stop instead of hard impulse
+    if (!stop_active_) beginSoftStop("AUTOTEST_STOP");
 
-    if (csv_on_) { csv_on_ = false; Serial.println("OK LOG 0"); }
-    Serial.println("OK ESTOP");
+    Serial.println("OK AUTOTEST STOP");
     return;
   }
 
-  // === STOP (soft) ===
-  if (cmd == "stop")  {
-    armed_ = false;
-    at_mode_ = 0;
+  if (busyJob()) { Serial.print("ERR BUSY "); Serial.println(busyJob()); return; }
+
+  if (tokIs(sub, "core")) {
+    at_mode_ = 1;
     at_seq_active_ = false;
     at_seq_phase_ = 0;
-    if (at_) at_->stop();
-
-    // do NOT stopNow immediately – start soft stop sequence
-    if (!stop_active_) beginSoftStop("STOP");
-
+    startAutotestCoreRun();
+    Serial.println("OK AUTOTEST CORE");
     return;
   }
 
-  if (cmd == "autotest") {
-    if (!at_ || !esc_) { Serial.println("ERR autotest"); return; }
-    if (!armed_) { Serial.println("ERR NOT_ARMED (use start)"); return; }
-    if (n < 2) { Serial.println("ERR autotest <core|core2|stop> [gap_s]"); return; }
-    String sub = tok[1];
-    toLowerInPlace(sub);
+  if (tokIs(sub, "core2")) {
+    at_mode_ = 2;
+    long gap = 90;
+    if (n >= 3) gap = parseLongSafe(tok[2], 90);
+    if (gap < 0) gap = 0;
+    if (gap > 600) gap = 600;
+    at_gap_s_ = (uint16_t)gap;
 
-    if (sub == "stop") {
-      at_mode_ = 0;
-      at_seq_active_ = false;
-      at_seq_phase_ = 0;
-      at_->stop();
+    at_seq_active_ = true;
+    at_seq_phase_ = 1;
+    at_phase_t0_ms_ = (uint32_t)millis();
 
-      // soft stop instead of hard impulse
-      if (!stop_active_) beginSoftStop("AUTOTEST_STOP");
+    startAutotestCoreRun();
+    Serial.print("OK AUTOTEST CORE2 gap_s="); Serial.println(at_gap_s_);
+    return;
+  }
 
-      Serial.println("OK AUTOTEST STOP");
-      return;
+  if (tokIs(sub, "rpm")) {
+    // AUTOTEST RPM <step_s> <rpm1> [rpm2 ...] : closed-loop RPM steps
+    if (n < 4) { Serial.println("ERR autotest rpm <step_s> <rpm1> [rpm2 ...]"); return; }
+    const float step_s = parseFloatSafe(tok[2], NAN);
+    if (!isfinite(step_s) || step_s <= 0.0f) { Serial.println("ERR autotest rpm step_s"); return; }
+
+    float rpms[CLI_MAX_TOK];
+    float durs[CLI_MAX_TOK];
+    int cnt = 0;
+    for (int k = 3; k < n; k++) {
+      const long r = parseLongSafe(tok[k], -1);
+      if (r < 0) { Serial.println("ERR autotest rpm value"); return; }
+      rpms[cnt] = (float)r;
+      durs[cnt] = step_s;
+      cnt++;
     }
 
-    if (sub == "core") {
-      at_mode_ = 1;
-      at_seq_active_ = false;
-      at_seq_phase_ = 0;
-      startAutotestCoreRun();
-      Serial.println("OK AUTOTEST CORE");
+    at_mode_ = 1;
+    at_seq_active_ = false;
+    at_seq_phase_ = 0;
+    stop_active_ = false;
+    csv_on_ = true;
+    Serial.println("OK LOG 1");
+    at_->startRpmProgram(rpms, durs, cnt, 3.0f);
+    Serial.print("OK AUTOTEST RPM steps="); Serial.println(cnt);
+    return;
+  }
+
+  if (tokIs(sub, "sweep")) {
+    // AUTOTEST SWEEP <from> <to> <seconds> [up|updown] : continuous linear ramp, 50 Hz log
+    if (n < 5) { Serial.println("ERR autotest sweep <from> <to> <seconds> [up|updown]"); return; }
+    const float from = parseFloatSafe(tok[2], NAN);
+    const float to = parseFloatSafe(tok[3], NAN);
+    const float secs = parseFloatSafe(tok[4], NAN);
+    const char* dir = (n >= 6) ? tok[5] : "up";
+    const bool updown = tokIs(dir, "updown");
+    if (!updown && !tokIs(dir, "up")) { Serial.println("ERR autotest sweep [up|updown]"); return; }
+    if (!isfinite(secs) || secs < 5.0f || secs > 600.0f) { Serial.println("ERR autotest sweep seconds (5..600)"); return; }
+
+    at_mode_ = 1;
+    at_seq_active_ = false;
+    at_seq_phase_ = 0;
+    if (!at_->startSweep(from, to, secs, updown)) {
+      at_mode_ = 0;
+      Serial.println("ERR autotest sweep from/to (0..100, >= 1 % apart)");
       return;
     }
+    stop_active_ = false;
+    csv_on_ = true;
+    Serial.println("OK LOG 1");
+    Serial.print("OK AUTOTEST SWEEP "); printFinite(from, 1, " -> ");
+    printFinite(to, 1, " in "); printFinite(secs, 1, " s ");
+    Serial.println(updown ? "updown" : "up");
+    return;
+  }
 
-    if (sub == "core2") {
-      at_mode_ = 2;
-      long gap = 90;
-      if (n >= 3) gap = parseLongSafe(tok[2], 90);
-      if (gap < 0) gap = 0;
-      if (gap > 600) gap = 600;
-      at_gap_s_ = (uint16_t)gap;
+  Serial.println("ERR autotest <core|core2|rpm|sweep|stop> [gap_s]");
+}
 
-      at_seq_active_ = true;
-      at_seq_phase_ = 1;
-      at_phase_t0_ms_ = (uint32_t)millis();
+void CLI::cmdRpm(char** tok, int n) {
+  long rpm = parseLongSafe(tok[1], -1);
+  long m = (n >= 3) ? parseLongSafe(tok[2], -1) : 0;
+  if (rpm < 0 || !esc_ || m < 0 || m > esc_->count()) { Serial.println("ERR rpm"); return; }
+  if (!armed_) { Serial.println("ERR NOT_ARMED (use start)"); return; }
+  if (busyJob()) { Serial.print("ERR BUSY "); Serial.println(busyJob()); return; }
+  stop_active_ = false; // cancel any pending soft stop
+  if (m == 0) esc_->setTargetRpm((uint32_t)rpm, 1.0f);
+  else esc_->motor((uint8_t)(m - 1)).setTargetRpm((uint32_t)rpm, 1.0f);
+  Serial.print("OK RPM "); Serial.println(rpm);
+}
 
-      startAutotestCoreRun();
-      Serial.print("OK AUTOTEST CORE2 gap_s="); Serial.println(at_gap_s_);
-      return;
+void CLI::cmdRpmPid(char** tok, int n) {
+  if (!esc_) { Serial.println("ERR rpmpid <kp> <ki> [kd]"); return; }
+  const float kp = parseFloatSafe(tok[1], NAN);
+  const float ki = parseFloatSafe(tok[2], NAN);
+  const float kd = (n >= 4) ? parseFloatSafe(tok[3], NAN) : esc_->primary().rpmKd();
+  if (!isfinite(kp) || !isfinite(ki) || !isfinite(kd) || kp < 0.0f || ki < 0.0f || kd < 0.0f) {
+    Serial.println("ERR rpmpid");
+    return;
+  }
+  // the reply shows the gains actually set
+  esc_->setRpmGains(fminf(kp, RPM_CTRL_KP_MAX), fminf(ki, RPM_CTRL_KI_MAX), fminf(kd, RPM_CTRL_KD_MAX));
+  Serial.print("OK RPMPID kp="); printFinite(esc_->primary().rpmKp(), 5, "");
+  Serial.print(" ki="); printFinite(esc_->primary().rpmKi(), 5, "");
+  Serial.print(" kd="); printFinite(esc_->primary().rpmKd(), 6, "\n");
+}
+
+void CLI::cmdThrottle(char** tok, int n) {
+  float pct = parseFloatSafe(tok[1], NAN);
+  long m = (n >= 3) ? parseLongSafe(tok[2], -1) : 0; // 0 = all motors
+  if (isnan(pct) || !esc_ || m < 0 || m > esc_->count()) { Serial.println("ERR throttle"); return; }
+  if (!armed_) { Serial.println("ERR NOT_ARMED (use start)"); return; }
+  if (busyJob()) { Serial.print("ERR BUSY "); Serial.println(busyJob()); return; }
+  stop_active_ = false; // cancel any pending soft stop
+  if (m == 0) esc_->setTargetThrottlePct(pct, 0.5f, ramp_prof_);
+  else esc_->motor((uint8_t)(m - 1)).setTargetThrottlePct(pct, 0.5f, ramp_prof_);
+  Serial.println("OK THROTTLE");
+}
+
+void CLI::cmdThrCal(char** tok, int n) {
+  if (!esc_) { Serial.println("ERR thrcal"); return; }
+  const char* sub = (n >= 2) ? tok[1] : "";
+
+  if (tokIs(sub, "stop")) {
+    if (!thrcal_.active()) { Serial.println("ERR THRCAL not running"); return; }
+    thrcal_.abort(*esc_);
+    if (!stop_active_) beginSoftStop("THRCAL_STOP");
+    Serial.println("OK THRCAL STOP");
+    return;
+  }
+
+  if (tokIs(sub, "show") || tokIs(sub, "save") || tokIs(sub, "clear")) {
+    long m = (n >= 3) ? parseLongSafe(tok[2], -1) : 0; // 0 = all motors
+    if (m < 0 || m > esc_->count()) { Serial.println("ERR thrcal motor"); return; }
+    if (!tokIs(sub, "show") && thrcal_.active()) { Serial.println("ERR THRCAL running"); return; }
+    if (tokIs(sub, "save") && armed_) { Serial.println("ERR ARMED (use stop)"); return; }
+    const uint8_t lo = (m == 0) ? 0 : (uint8_t)(m - 1);
+    const uint8_t hi = (m == 0) ? esc_->count() : (uint8_t)m;
+    bool ok = true;
+    for (uint8_t i = lo; i < hi; i++) {
+      if (tokIs(sub, "show")) printThrCal(i);
+      else if (tokIs(sub, "save")) ok = esc_->saveThrottleCal(i) && ok;
+      else esc_->motor(i).setThrottleCal(ThrCalData{});
     }
+    if (tokIs(sub, "save")) Serial.println(ok ? "OK THRCAL SAVE" : "ERR THRCAL SAVE");
+    if (tokIs(sub, "clear")) Serial.println("OK THRCAL CLEAR (use THRCAL SAVE to persist)");
+    return;
+  }
 
-    Serial.println("ERR autotest <core|core2|stop> [gap_s]");
+  // THRCAL [motor] [max_pct] : sweep one ESC
+  long m = (n >= 2) ? parseLongSafe(tok[1], -1) : 1;
+  float max_pct = (n >= 3) ? parseFloatSafe(tok[2], NAN) : 100.0f;
+  if (m < 1 || m > esc_->count() || !isfinite(max_pct)) {
+    Serial.println("ERR thrcal [motor] [max_pct]");
+    return;
+  }
+  if (!armed_) { Serial.println("ERR NOT_ARMED (use start)"); return; }
+  if ((at_ && at_->active()) || busyJob()) { Serial.println("ERR BUSY"); return; }
+  stop_active_ = false; // cancel any pending soft stop
+  if (!thrcal_.start(*esc_, (uint8_t)(m - 1), max_pct)) {
+    Serial.println("ERR THRCAL (motor must be stopped, no failsafe)");
     return;
   }
+  Serial.print("OK THRCAL m="); Serial.print(m);
+  Serial.print(" max_pct="); printFinite(max_pct, 1, "");
+  Serial.print(" rate="); printFinite(THRCAL_SWEEP_PCT_PER_S, 1, " %/s\n");
+}
 
-  if (cmd == "throttle") {
-    if (n < 2) { Serial.println("ERR throttle <pct>"); return; }
-    float pct = parseFloatSafe(tok[1], NAN);
-    if (isnan(pct) || !esc_) { Serial.println("ERR throttle"); return; }
-    if (!armed_) { Serial.println("ERR NOT_ARMED (use start)"); return; }
-    stop_active_ = false; // cancel any pending soft stop
-    esc_->setTargetThrottlePct(pct, 0.5f);
-    Serial.println("OK THROTTLE");
+void CLI::cmdStepResp(char** tok, int) {
+  // STEPRESP <from> <to> : hold from, step to, capture full-rate RPM/current/thrust around the step
+  if (!esc_) { Serial.println("ERR stepresp <from_pct> <to_pct>"); return; }
+  const float from = parseFloatSafe(tok[1], NAN);
+  const float to = parseFloatSafe(tok[2], NAN);
+  if (!armed_) { Serial.println("ERR NOT_ARMED (use start)"); return; }
+  if ((at_ && at_->active()) || busyJob()) { Serial.println("ERR BUSY"); return; }
+  stop_active_ = false; // cancel any pending soft stop
+  if (!stepresp_.start(*esc_, from, to)) {
+    Serial.println("ERR stepresp (0..100, >= 1 % apart, no failsafe)");
     return;
   }
+  Serial.print("OK STEPRESP "); printFinite(from, 1, " -> ");
+  printFinite(to, 1, " pre_ms="); Serial.print(STEPRESP_PRE_MS);
+  Serial.print(" post_ms="); Serial.println(STEPRESP_POST_MS);
+}
 
-  if (cmd == "i2cscan") {
-    Serial.println("I2CSCAN:");
-    byte count = 0;
-    for (uint8_t addr = 1; addr < 127; addr++) {
-      Wire.beginTransmission(addr);
-      uint8_t err = Wire.endTransmission();
-      if (err == 0) { Serial.print("  0x"); Serial.println(addr, HEX); count++; }
-    }
-    Serial.print("FOUND="); Serial.println(count);
+void CLI::cmdEscs(char** tok, int) {
+  if (!esc_) { Serial.println("ERR escs <1..4>"); return; }
+  if (armed_) { Serial.println("ERR ARMED (use stop)"); return; }
+  if (busyJob()) { Serial.print("ERR BUSY "); Serial.println(busyJob()); return; }
+  long v = parseLongSafe(tok[1], -1);
+  if (v < 1 || v > ESC_COUNT_MAX || !esc_->setCount((uint8_t)v)) { Serial.println("ERR escs <1..4>"); return; }
+  Serial.print("OK ESCS "); Serial.println(esc_->count());
+}
+
+static void printLimit(float v, int prec) {
+  if (isfinite(v)) Serial.print(v, prec);
+  else Serial.print("off");
+}
+
+void CLI::printLimits() {
+  Serial.print("OK LIMIT i="); printLimit(limits_->currentMax(), 2);
+  Serial.print(" p="); printLimit(limits_->powerMax(), 1);
+  Serial.print(" thrust="); printLimit(limits_->thrustMax(), 0);
+  Serial.print(" action="); Serial.print(limits_->ramp() ? "RAMP" : "CUT");
+  Serial.print(" hw="); Serial.println(limits_->hwAlert() ? "ON" : "OFF");
+}
+
+void CLI::cmdLimit(char** tok, int n) {
+  if (!limits_) { Serial.println("ERR LIMIT"); return; }
+  if (n == 1) { printLimits(); return; }
+  if (n < 3) { Serial.println("ERR limit [i|p|thrust <value|off>], limit action <cut|ramp>"); return; }
+
+  if (tokIs(tok[1], "action")) {
+    if (tokIs(tok[2], "cut")) limits_->setRamp(false);
+    else if (tokIs(tok[2], "ramp")) limits_->setRamp(true);
+    else { Serial.println("ERR limit action <cut|ramp>"); return; }
+    printLimits();
     return;
   }
 
-  Serial.println("ERR unknown_cmd");
+  float v = NAN;
+  if (!tokIs(tok[2], "off")) {
+    v = parseFloatSafe(tok[2], NAN);
+    if (!isfinite(v) || v <= 0.0f) { Serial.println("ERR LIMIT value (> 0 or off)"); return; }
+  }
+
+  if (tokIs(tok[1], "i")) {
+    // hardware ALERT follows the software current limit; off or no INA226 = software only
+    limits_->setCurrentMax(v);
+  } else if (tokIs(tok[1], "p")) {
+    limits_->setPowerMax(v);
+  } else if (tokIs(tok[1], "thrust")) {
+    limits_->setThrustMax(v);
+  } else {
+    Serial.println("ERR limit [i|p|thrust <value|off>]");
+    return;
+  }
+  printLimits();
 }
 
+void CLI::cmdI2cScan(char**, int) {
+  Serial.println("I2CSCAN:");
+  byte count = 0;
+  for (uint8_t addr = 1; addr < 127; addr++) {
+    Wire.beginTransmission(addr);
+    uint8_t err = Wire.endTransmission();
+    if (err == 0) { Serial.print("  0x"); Serial.println(addr, HEX); count++; }
+  }
+  Serial.print("FOUND="); Serial.println(count);
+}
 void CLI::printStatus() {
+  pullLive();
   Serial.println();
   Serial.println("================= STATUS =================");
 
@@ -365,43 +783,137 @@ void CLI::printStatus() {
   Serial.print("  Armed:        "); Serial.println(armed_ ? "YES" : "NO");
   Serial.print("  CSV logging:  "); Serial.println(csv_on_ ? "ON" : "OFF");
   Serial.print("  Notes:        "); Serial.println(notes_);
+  Serial.print("  Preset:       "); Serial.println(preset_[0] ? preset_ : "none");
+  if (guard_) {
+    Serial.print("  Watchdog:     "); Serial.print(WDT_TIMEOUT_MS);
+    Serial.print(" ms  last reset="); Serial.println(guard_->wdtReboot() ? "WATCHDOG" : "normal");
+    Serial.print("  Loop max:     "); Serial.print(guard_->maxPassUs()); Serial.println(" us");
+    Serial.print("  Overruns:     "); Serial.print(guard_->overruns());
+    Serial.print("  (> "); Serial.print(LOOP_OVERRUN_US); Serial.print(" us)");
+    if (guard_->overruns()) {
+      Serial.print("  last "); Serial.print(guard_->lastOverrunUs());
+      Serial.print(" us in "); Serial.print(loopStageName(guard_->lastOverrunStage()));
+      Serial.print(", "); Serial.print((uint32_t)(millis() - guard_->lastOverrunMs()) / 1000UL);
+      Serial.print(" s ago");
+    }
+    Serial.println();
+  }
+  if (esc_) { Serial.print("  Loop stalls:  "); Serial.println(esc_->loopStalls()); }
+  {
+    KvStore& kv = kvStore();
+    Serial.print("  Store:        ");
+    if (!kv.mounted()) Serial.println("NOT MOUNTED");
+    else {
+      Serial.print(kv.sectors()); Serial.print(" x 4 KB  gen="); Serial.print(kv.generation());
+      Serial.print(" keys="); Serial.print(kv.keys());
+      Serial.print(" active="); Serial.print(kv.activeUsed()); Serial.print(" B");
+      Serial.print(" erases="); Serial.print(kv.erases());
+      Serial.println(kv.pending() ? "  (writes pending: motor running)" : "");
+    }
+    Serial.print("  CRC:          self-test ");
+    Serial.println(crcSelfTestPassed() ? "OK" : "FAIL  (store records unreliable)");
+  }
+  if (limits_) {
+    Serial.print("  Limits:       i="); printLimit(limits_->currentMax(), 2);
+    Serial.print(" A  p="); printLimit(limits_->powerMax(), 1);
+    Serial.print(" W  thrust="); printLimit(limits_->thrustMax(), 0);
+    Serial.print(" g  "); Serial.print(limits_->ramp() ? "RAMP" : "CUT");
+    Serial.println(limits_->hwAlert() ? " +HW" : "");
+    if (limits_->trips()) {
+      Serial.print("  Last trip:    "); Serial.print(LimitGuard::kindReason(limits_->lastKind()));
+      Serial.print(' '); printFinite(limits_->lastValue(), 2, "");
+      Serial.print("  (trips="); Serial.print(limits_->trips()); Serial.println(")");
+    }
+  }
 
   Serial.println();
   Serial.println("ESC / CONTROL");
   if (esc_) {
     Serial.print("  Throttle:     ");
-    printFinite(esc_->currentThrottlePct(), 2, " %  (target ");
-    printFinite(esc_->targetThrottlePct(), 2, " %)\n");
-
+    printFinite(esc_->primary().currentThrottlePct(), 2, " %  (target ");
+    printFinite(esc_->primary().targetThrottlePct(), 2, " %)\n");
+
+    Serial.print("  Mode:         "); Serial.println(esc_->primary().rpmMode() ? "RPM" : "THROTTLE");
+    Serial.print("  Ramp profile: "); Serial.println(rampProfileName(ramp_prof_));
+    if (esc_->primary().rpmMode()) {
+      Serial.print("  RPM sp/tgt:   "); Serial.print(esc_->primary().rpmSetpoint());
+      Serial.print(" / "); Serial.print(esc_->primary().rpmTarget());
+      Serial.print("  (filt "); printFinite(esc_->primary().rpmFiltered(), 0, ")\n");
+    }
+    Serial.print("  RPM PID:      kp="); printFinite(esc_->primary().rpmKp(), 5, "");
+    Serial.print(" ki="); printFinite(esc_->primary().rpmKi(), 5, "");
+    Serial.print(" kd="); printFinite(esc_->primary().rpmKd(), 6, "\n");
+    const EscJitterStats js = esc_->primary().sendJitter(false);
+    Serial.print("  Send sched:   "); Serial.print(esc_->sendTimerOn() ? "TIMER" : "POLLED");
+    Serial.print("  period "); printFinite(js.mean_us, 1, " us");
+    Serial.print(" +/- "); printFinite(js.std_us, 1, " us");
+    Serial.print("  [");  Serial.print(js.period_min_us); Serial.print(".."); Serial.print(js.period_max_us);
+    Serial.print("]  late="); Serial.println(js.late);
+    const ThrCalData& tc = esc_->primary().throttleCal();
+    Serial.print("  Throttle cal: ");
+    if (thrcal_.active()) Serial.println("SWEEP");
+    else if (tc.valid) { Serial.print("start_dshot="); Serial.println(tc.start_dshot); }
+    else Serial.println("NONE (linear)");
+    Serial.print("  ESC temp:     "); printFinite(esc_->maxTempC(), 0, " C (EDT)\n");
     Serial.print("  Failsafe:     "); Serial.println(esc_->isFailsafe() ? "YES" : "NO");
     Serial.print("  Reason:       "); Serial.println(esc_->failsafeReason());
   }
-  Serial.print("  eRPM / RPM:   "); Serial.print(st_erpm_); Serial.print(" / "); Serial.println(st_rpm_);
-  Serial.print("  BDShot err:   "); printFinite(st_bdshot_err_pct_, 1, " %\n");
+  if (esc_ && esc_->count() > 1) {
+    Serial.print("  ESCs:         "); Serial.println(esc_->count());
+    for (uint8_t i = 0; i < esc_->count(); i++) {
+      EscBdshot& m = esc_->motor(i);
+      const EscTelemetry mt = m.getTelemetry();
+      Serial.print("  M"); Serial.print(i + 1); Serial.print(":           ");
+      printFinite(m.currentThrottlePct(), 2, " %  rpm=");
+      Serial.print(mt.rpm);
+      Serial.print("  err=");
+      printFinite(mt.bdshot_err_pct, 1, " %  ");
+      Serial.println(m.isFailsafe() ? m.failsafeReason() : "OK");
+    }
+  }
+  Serial.print("  eRPM / RPM:   "); Serial.print(lf_.erpm); Serial.print(" / "); Serial.println(lf_.rpm);
+  Serial.print("  BDShot err:   "); printFinite(lf_.bdshot_err_pct, 1, " %\n");
+  if (esc_) {
+    const EscTelemetry tel = esc_->primary().getTelemetry();
+    Serial.print("  BDShot win:   ok="); Serial.print(tel.win_ok);
+    Serial.print(" crc="); Serial.print(tel.win_crc_err);
+    Serial.print(" noresp="); Serial.print(tel.win_no_resp);
+    Serial.print(" / "); Serial.println(tel.win_sends);
+    Serial.print("  BDShot total: ok="); Serial.print(tel.tot_ok);
+    Serial.print(" crc="); Serial.print(tel.tot_crc_err);
+    Serial.print(" noresp="); Serial.println(tel.tot_no_resp);
+    Serial.print("  RPM outliers: "); Serial.println(esc_->primary().erpmOutliers());
+  }
 
   Serial.println();
   Serial.println("POWER (INA226)");
-  Serial.print("  VBAT:         "); printFinite(st_vbus_V_, 3, " V\n");
-  Serial.print("  Current:      "); printFinite(st_i_A_, 6, " A\n");
-  Serial.print("  Power:        "); printFinite(st_p_W_, 6, " W\n");
+  Serial.print("  VBAT:         "); printFinite(lf_.v_bus_V, 3, " V\n");
+  Serial.print("  Current:      "); printFinite(lf_.i_A, 6, " A\n");
+  Serial.print("  Power:        "); printFinite(lf_.p_in_W, 6, " W\n");
 
   Serial.println();
   Serial.println("THRUST (HX711)");
-  Serial.print("  Raw:          "); Serial.println(st_hx_raw_);
-  Serial.print("  Offset:       "); Serial.println(st_hx_offset_);
-  Serial.print("  Scale:        "); printFinite(st_hx_scale_, 6, " counts/g\n");
-  Serial.print("  Cal valid:    "); Serial.println(st_hx_cal_valid_ ? "YES" : "NO");
-  Serial.print("  Inverted:     "); Serial.println(st_hx_inverted_ ? "YES" : "NO");
+  Serial.print("  Raw:          "); Serial.println(lf_.hx_raw);
+  if (hx_) {
+    Serial.print("  Offset:       "); Serial.println(hx_->offset());
+    Serial.print("  Scale:        "); printFinite(hx_->scaleCountsPerG(), 6, " counts/g\n");
+    Serial.print("  Cal valid:    "); Serial.println(hx_->calValid() ? "YES" : "NO");
+    Serial.print("  Inverted:     "); Serial.println(hx_->inverted() ? "YES" : "NO");
+  }
   Serial.print("  Noise p2p:    ");
-  if (st_hx_noise_pp_ >= 0) Serial.println(st_hx_noise_pp_);
+  if (lf_.hx_noise_pp >= 0) Serial.println(lf_.hx_noise_pp);
   else Serial.println("-");
 
   Serial.print("  Thrust:       ");
-  printFinite(st_thrust_g_, 2, " g   (");
-  printFinite(st_thrust_N_, 3, " N)\n");
+  printFinite(lf_.thrust_g, 2, " g   (");
+  printFinite(lf_.thrust_N, 3, " N)\n");
 
   Serial.println();
   Serial.println("AUTOTEST");
+  if (at_) {
+    Serial.print("  Adaptive:     ");
+    Serial.println(at_->adaptive() ? "ON (steady + dwell ends step)" : "OFF (fixed hold)");
+  }
   if (at_ && at_->active()) {
     Serial.println("  Active:       YES");
     Serial.print("  Step ID:      "); Serial.println(at_->stepId());
@@ -412,39 +924,392 @@ void CLI::printStatus() {
     Serial.println("  Steady:       -");
   }
 
+  if (batch_phase_) {
+    Serial.print("  Batch:        run "); Serial.print(batch_idx_ + 1);
+    Serial.print('/'); Serial.print(batch_count_);
+    if (batch_phase_ == 2) {
+      Serial.print("  GAP waiting=");
+      Serial.print(!gate_.full() ? "WINDOW" : CooldownGate::condName(gate_.blocking()));
+    }
+    Serial.println();
+  } else if (batch_count_) {
+    Serial.print("  Batch:        "); Serial.print(batch_count_); Serial.println(" queued");
+  }
+
   Serial.println("=========================================");
   Serial.println();
 }
 
-// CORE profile (single run) + auto LOG markers for PC rotation
-void CLI::startAutotestCoreRun() {
-  if (!at_ || !esc_) return;
-
+// builtin CORE profile (also PROG RUN core)
+void CLI::buildCoreProgram(AtProgram& p) {
   static const float steps[] = { 0, 10, 20, 30, 40, 50, 60, 70, 80, 90, 100, 60, 0 };
   static const float durs[]  = { 5, 20, 20, 20, 20, 20, 20, 30, 30, 30,  30, 20, 10 };
   static const int N = (int)(sizeof(steps) / sizeof(steps[0]));
   static const float RAMP_S = 3.0f;
 
+  atProgramFromTable(p, "core", steps, durs, N, RAMP_S, ramp_prof_, AT_STEP_THROTTLE);
+}
+
+// CORE profile (single run) + auto LOG markers for PC rotation
+void CLI::startAutotestCoreRun() {
+  if (!at_ || !esc_) return;
+  buildCoreProgram(prog_tmp_);
+  startProgramRun(prog_tmp_);
+}
+
+bool CLI::startProgramRun(const AtProgram& p) {
+  if (!at_ || atProgramValidate(p) != nullptr) return false;
+
   stop_active_ = false; // cancel stop if any
   csv_on_ = true;
   Serial.println("OK LOG 1");
 
-  at_->startProgram(steps, durs, N, RAMP_S);
+  return at_->startProgram(p);
+}
+
+// === PROG: upload / store / run named programs ===
+void CLI::printProgram(const AtProgram& p) {
+  Serial.print("PROG "); Serial.print(p.name);
+  Serial.print(" steps="); Serial.print(p.count);
+  Serial.print(" dur_s="); printFinite(atProgramDurationS(p), 1, "\n");
+  for (uint8_t i = 0; i < p.count; i++) {
+    const AtStep& s = p.steps[i];
+    Serial.print("  STEP "); Serial.print(s.type == AT_STEP_RPM ? "rpm " : "thr ");
+    printFinite(s.value, (s.type == AT_STEP_RPM) ? 0 : 2, " ");
+    printFinite(s.ramp_s, 1, " ");
+    printFinite(s.hold_s, 1, " ");
+    Serial.println(rampProfileName((RampProfile)s.prof));
+  }
+}
+
+const AtProgram* CLI::findProgram(const char* name) {
+  // lookup order: uploaded (RAM) program, builtin core, flash
+  if (prog_edit_ready_ && strcmp(prog_edit_.name, name) == 0) return &prog_edit_;
+  if (strcmp(name, "core") == 0) { buildCoreProgram(prog_tmp_); return &prog_tmp_; }
+  if (store_.loadProgram(name, prog_tmp_)) return &prog_tmp_;
+  return nullptr;
+}
+
+void CLI::cmdProg(char** tok, int n) {
+  const char* sub = tok[1];
+  const char* name = (n >= 3) ? tok[2] : "";
+
+  if (tokIs(sub, "begin")) {
+    if (!atProgramNameValid(name)) { Serial.println("ERR PROG name (1..15 of A-Z a-z 0-9 _ -)"); return; }
+    prog_edit_ = AtProgram{};
+    atProgramSetName(prog_edit_, name);
+    prog_edit_open_ = true;
+    prog_edit_ready_ = false;
+    Serial.print("OK PROG BEGIN "); Serial.println(prog_edit_.name);
+    return;
+  }
+
+  if (tokIs(sub, "step")) {
+    if (!prog_edit_open_) { Serial.println("ERR PROG no BEGIN"); return; }
+    if (n < 6) { Serial.println("ERR prog step <thr|rpm> <value> <ramp_s> <hold_s> [lin|scurve|exp]"); return; }
+    if (prog_edit_.count >= AtProgram::MAX_STEPS) { Serial.println("ERR PROG too_many_steps"); return; }
+
+    const char* type = tok[2];
+    AtStep s;
+    if (tokIs(type, "thr") || tokIs(type, "throttle")) s.type = AT_STEP_THROTTLE;
+    else if (tokIs(type, "rpm")) s.type = AT_STEP_RPM;
+    else { Serial.println("ERR PROG type <thr|rpm>"); return; }
+
+    s.value  = parseFloatSafe(tok[3], NAN);
+    s.ramp_s = parseFloatSafe(tok[4], NAN);
+    s.hold_s = parseFloatSafe(tok[5], NAN);
+    RampProfile prof = ramp_prof_;
+    if (n >= 7 && !rampProfileParse(tok[6], prof)) { Serial.println("ERR PROG profile"); return; }
+    s.prof = (uint8_t)prof;
+
+    const char* err = atStepValidate(s);
+    if (err) { Serial.print("ERR PROG "); Serial.println(err); return; }
+
+    prog_edit_.steps[prog_edit_.count++] = s;
+    Serial.print("OK PROG STEP "); Serial.println(prog_edit_.count);
+    return;
+  }
+
+  if (tokIs(sub, "end")) {
+    if (!prog_edit_open_) { Serial.println("ERR PROG no BEGIN"); return; }
+    const char* err = atProgramValidate(prog_edit_);
+    if (err) { Serial.print("ERR PROG "); Serial.println(err); return; }
+    prog_edit_open_ = false;
+    prog_edit_ready_ = true;
+    Serial.print("OK PROG END "); Serial.print(prog_edit_.name);
+    Serial.print(" steps="); Serial.print(prog_edit_.count);
+    Serial.print(" dur_s="); printFinite(atProgramDurationS(prog_edit_), 1, "\n");
+    return;
+  }
+
+  if (tokIs(sub, "save")) {
+    if (!prog_edit_ready_) { Serial.println("ERR PROG nothing to save (BEGIN..END)"); return; }
+    // flash commit stalls interrupts (send alarm) -> only while disarmed
+    if (armed_) { Serial.println("ERR ARMED (use stop)"); return; }
+    if (!store_.saveProgram(prog_edit_)) { Serial.println("ERR PROG SAVE (flash full, use PROG DEL)"); return; }
+    Serial.print("OK PROG SAVE "); Serial.println(prog_edit_.name);
+    return;
+  }
+
+  if (tokIs(sub, "list")) {
+    Serial.println("PROG core (builtin)");
+    if (prog_edit_ready_) {
+      Serial.print("PROG "); Serial.print(prog_edit_.name); Serial.println(" (ram)");
+    }
+    for (uint8_t i = 0; i < CalStorage::PROG_SLOTS; i++) {
+      if (!store_.loadProgramSlot(i, prog_tmp_)) continue;
+      Serial.print("PROG "); Serial.print(prog_tmp_.name);
+      Serial.print(" slot="); Serial.print(i);
+      Serial.print(" steps="); Serial.print(prog_tmp_.count);
+      Serial.print(" dur_s="); printFinite(atProgramDurationS(prog_tmp_), 1, "\n");
+    }
+    Serial.println("OK PROG LIST");
+    return;
+  }
+
+  if (tokIs(sub, "del")) {
+    if (armed_) { Serial.println("ERR ARMED (use stop)"); return; }
+    Serial.println(store_.deleteProgram(name) ? "OK PROG DEL" : "ERR PROG not found");
+    return;
+  }
+
+  if (tokIs(sub, "show") || tokIs(sub, "run")) {
+    if (n < 3) { Serial.println("ERR prog <show|run> <name>"); return; }
+
+    const AtProgram* p = findProgram(name);
+
+    if (tokIs(sub, "show")) {
+      if (!p) { Serial.println("ERR PROG not found"); return; }
+      printProgram(*p);
+      return;
+    }
+
+    if (!at_ || !esc_) { Serial.println("ERR prog run"); return; }
+    if (!armed_) { Serial.println("ERR NOT_ARMED (use start)"); return; }
+    if (at_->active() || busyJob()) { Serial.println("ERR BUSY"); return; }
+    if (!p) { Serial.println("ERR PROG not found"); return; }
+
+    at_mode_ = 1;
+    at_seq_active_ = false;
+    at_seq_phase_ = 0;
+    if (!startProgramRun(*p)) { at_mode_ = 0; Serial.println("ERR PROG invalid"); return; }
+    Serial.print("OK PROG RUN "); Serial.println(name);
+    return;
+  }
+
+  Serial.println("ERR prog <begin|step|end|save|list|show|run|del>");
+}
+
+static_assert(PresetData::FIELD_LEN == Meta::FIELD_LEN, "preset fields hold SETMETA values");
+
+// Apply a preset in one step: metadata, ESC count, pole pairs and (thrcal) every ESC's throttle cal.
+bool CLI::applyPreset(const PresetData& p, bool thrcal) {
+  if (!meta_ || !esc_) return false;
+  if (p.esc_count < 1 || p.esc_count > ESC_COUNT_MAX || !esc_->setCount(p.esc_count)) return false;
+  metaSet(meta_->motor_id, p.motor_id);
+  meta_->kv = p.kv;
+  metaSet(meta_->prop, p.prop);
+  meta_->battery_s = p.battery_s;
+  metaSet(meta_->esc_fw, p.esc_fw);
+  meta_->pole_pairs = p.pole_pairs;
+  esc_->setPolePairs(p.pole_pairs);
+  if (thrcal) for (uint8_t i = 0; i < esc_->count(); i++) esc_->motor(i).setThrottleCal(p.thr[i]);
+  textCopy(preset_, p.name);
+  return true;
+}
+
+// Boot: the THRCAL slots escs.begin() loaded are newer than the preset's copy (THRCAL SAVE after
+// PRESET SAVE / LOAD) -> keep them, apply the rest.
+void CLI::restorePreset() {
+  char name[PresetData::NAME_LEN];
+  if (!store_.activePreset(name)) return;
+  if (store_.loadPreset(name, preset_tmp_) && applyPreset(preset_tmp_, false)) {
+    Serial.print("OK PRESET "); Serial.println(preset_);
+  } else {
+    Serial.print("ERR PRESET "); Serial.print(name); Serial.println(" missing");
+  }
+}
+
+void CLI::printPreset(const PresetData& p, int slot) {
+  Serial.print("PRESET "); Serial.print(p.name);
+  if (slot >= 0) { Serial.print(" slot="); Serial.print(slot); }
+  Serial.print(" motor="); Serial.print(p.motor_id);
+  Serial.print(" kv="); Serial.print(p.kv);
+  Serial.print(" prop="); Serial.print(p.prop);
+  Serial.print(" bat_s="); Serial.print(p.battery_s);
+  Serial.print(" esc_fw="); Serial.print(p.esc_fw);
+  Serial.print(" pp="); Serial.print(p.pole_pairs);
+  Serial.print(" escs="); Serial.print(p.esc_count);
+  Serial.print(" thrcal=");
+  for (uint8_t i = 0; i < p.esc_count && i < ESC_COUNT_MAX; i++) Serial.print(p.thr[i].valid ? 'Y' : '-');
+  Serial.println(strncmp(p.name, preset_, sizeof(preset_)) == 0 ? " (active)" : "");
+}
+
+void CLI::cmdPreset(char** tok, int n) {
+  const char* sub = tok[1];
+  const char* name = (n >= 3) ? tok[2] : "";
+
+  if (tokIs(sub, "list")) {
+    for (uint8_t i = 0; i < CalStorage::PRESET_SLOTS; i++) {
+      if (store_.loadPresetSlot(i, preset_tmp_)) printPreset(preset_tmp_, i);
+    }
+    Serial.println("OK PRESET LIST");
+    return;
+  }
+
+  if (n < 3) { Serial.println("ERR preset <save|load|show|del> <name>"); return; }
+
+  if (tokIs(sub, "save")) {
+    if (!meta_ || !esc_) { Serial.println("ERR PRESET"); return; }
+    if (!atProgramNameValid(name)) { Serial.println("ERR PRESET name (1..15 of A-Z a-z 0-9 _ -)"); return; }
+    if (armed_) { Serial.println("ERR ARMED (use stop)"); return; }
+    if (thrcal_.active()) { Serial.println("ERR THRCAL running"); return; }
+    PresetData& p = preset_tmp_;
+    p = PresetData{};
+    textCopy(p.name, name);
+    metaSet(p.motor_id, meta_->motor_id);
+    p.kv = meta_->kv;
+    metaSet(p.prop, meta_->prop);
+    p.battery_s = meta_->battery_s;
+    metaSet(p.esc_fw, meta_->esc_fw);
+    p.pole_pairs = meta_->pole_pairs;
+    p.esc_count = esc_->count();
+    for (uint8_t i = 0; i < esc_->count(); i++) p.thr[i] = esc_->motor(i).throttleCal();
+    if (!store_.savePreset(p)) { Serial.println("ERR PRESET SAVE (flash full, use PRESET DEL)"); return; }
+    // what is loaded now is this preset: keep it across reboots too
+    textCopy(preset_, p.name);
+    store_.setActivePreset(preset_);
+    Serial.print("OK PRESET SAVE "); Serial.println(p.name);
+    return;
+  }
+
+  if (tokIs(sub, "load")) {
+    if (armed_) { Serial.println("ERR ARMED (use stop)"); return; }
+    if ((at_ && at_->active()) || busyJob()) { Serial.println("ERR BUSY"); return; }
+    if (!store_.loadPreset(name, preset_tmp_)) { Serial.println("ERR PRESET not found"); return; }
+    if (!applyPreset(preset_tmp_, true)) { Serial.println("ERR PRESET invalid"); return; }
+    store_.setActivePreset(preset_);
+    // the slots are what a reboot restores: they follow the loaded preset
+    bool ok = true;
+    for (uint8_t i = 0; i < esc_->count(); i++) ok = esc_->saveThrottleCal(i) && ok;
+    if (!ok) { Serial.println("ERR PRESET LOAD thrcal_not_saved"); return; }
+    printPreset(preset_tmp_, -1);
+    Serial.print("OK PRESET LOAD "); Serial.println(preset_);
+    return;
+  }
+
+  if (tokIs(sub, "show")) {
+    if (!store_.loadPreset(name, preset_tmp_)) { Serial.println("ERR PRESET not found"); return; }
+    printPreset(preset_tmp_, -1);
+    for (uint8_t i = 0; i < preset_tmp_.esc_count && i < ESC_COUNT_MAX; i++) {
+      const ThrCalData& tc = preset_tmp_.thr[i];
+      if (!tc.valid) continue;
+      Serial.print("  m"); Serial.print(i + 1);
+      Serial.print(" start_dshot="); Serial.print(tc.start_dshot);
+      Serial.print(" rpm@100="); Serial.println(tc.rpm_at[ThrCalData::RPM_PTS - 1]);
+    }
+    return;
+  }
+
+  if (tokIs(sub, "del")) {
+    if (armed_) { Serial.println("ERR ARMED (use stop)"); return; }
+    if (!store_.deletePreset(name)) { Serial.println("ERR PRESET not found"); return; }
+    if (strncmp(name, preset_, sizeof(preset_)) == 0) { preset_[0] = '\0'; store_.setActivePreset(""); }
+    Serial.println("OK PRESET DEL");
+    return;
+  }
+
+  Serial.println("ERR preset <save|load|list|show|del> [name]");
+}
+
+void CLI::serviceStepSummaries() {
+  const uint8_t cnt = at_->summaryCount();
+  if (cnt < at_sum_printed_) at_sum_printed_ = 0;   // new program started
+  while (at_sum_printed_ < cnt) {
+    if (at_sum_printed_ == 0) printStepSummaryHeader();
+    printStepSummary(at_->summary(at_sum_printed_), at_->programName());
+    at_sum_printed_++;
+  }
+}
+
+void CLI::printStepTable() {
+  const uint8_t cnt = at_->summaryCount();
+  Serial.print("SUMMARY "); Serial.print(at_->programName());
+  Serial.print(" steps="); Serial.println(cnt);
+  for (uint8_t i = 0; i < cnt; i++) {
+    const AtStepSummary& s = at_->summary(i);
+    Serial.print("  S"); Serial.print(s.step_id);
+    Serial.print(s.type == AT_STEP_RPM ? " rpm=" : " thr=");
+    printFinite(s.value, (s.type == AT_STEP_RPM) ? 0 : 1, "");
+    Serial.print(s.ended_steady ? " STEADY" : " TIMEOUT");
+    Serial.print(" t="); printFinite(s.step_s, 1, "s");
+    Serial.print(" n="); Serial.print(s.frames);
+    Serial.print(" thrust="); printFinite(s.st[AT_SUM_THRUST_G].meanOrNan(), 1, "");
+    Serial.print("+/-"); printFinite(s.st[AT_SUM_THRUST_G].std(), 1, "g");
+    Serial.print(" I="); printFinite(s.st[AT_SUM_I_A].meanOrNan(), 3, "A");
+    Serial.print(" V="); printFinite(s.st[AT_SUM_V_BUS_V].meanOrNan(), 2, "V");
+    Serial.print(" P="); printFinite(s.st[AT_SUM_P_IN_W].meanOrNan(), 1, "W");
+    Serial.print(" RPM="); printFinite(s.st[AT_SUM_RPM].meanOrNan(), 0, "");
+    Serial.print(" eff="); printFinite(s.st[AT_SUM_EFF_G_PER_W].meanOrNan(), 2, "g/W");
+    if (s.basis != AT_BASIS_STEADY) Serial.print(s.basis == AT_BASIS_POSTRAMP ? " (not steady)" : " (no data)");
+    Serial.println();
+  }
+}
+
+void CLI::printSweepHysteresis() {
+  const SweepHysteresis& h = at_->sweepHysteresis();
+
+  // per-bin table (bins seen on both legs): "HYST,<thr_pct>,<thrust_1>,<thrust_2>,<rpm_1>,<rpm_2>,<I_1>,<I_2>"
+  Serial.println("HYSTHDR,throttle_pct,thrust_g_leg1,thrust_g_leg2,RPM_leg1,RPM_leg2,I_A_leg1,I_A_leg2");
+  for (uint8_t b = 0; b < SweepHysteresis::BINS; b++) {
+    if (!h.binHasBoth(b)) continue;
+    Serial.print("HYST,"); Serial.print(b);
+    Serial.print(','); printFinite(h.mean(0, b, SweepHysteresis::CH_THRUST), 2, "");
+    Serial.print(','); printFinite(h.mean(1, b, SweepHysteresis::CH_THRUST), 2, "");
+    Serial.print(','); printFinite(h.mean(0, b, SweepHysteresis::CH_RPM), 0, "");
+    Serial.print(','); printFinite(h.mean(1, b, SweepHysteresis::CH_RPM), 0, "");
+    Serial.print(','); printFinite(h.mean(0, b, SweepHysteresis::CH_I), 3, "");
+    Serial.print(','); printFinite(h.mean(1, b, SweepHysteresis::CH_I), 3, "\n");
+  }
+
+  int bt = -1, br = -1, bi = -1;
+  const float dt = h.maxDiff(SweepHysteresis::CH_THRUST, bt);
+  const float dr = h.maxDiff(SweepHysteresis::CH_RPM, br);
+  const float di = h.maxDiff(SweepHysteresis::CH_I, bi);
+  Serial.print("SWEEP HYST max_dthrust_g="); printFinite(dt, 2, "");
+  Serial.print(" @"); Serial.print(bt);
+  Serial.print("% max_drpm="); printFinite(dr, 0, "");
+  Serial.print(" @"); Serial.print(br);
+  Serial.print("% max_dI_A="); printFinite(di, 3, "");
+  Serial.print(" @"); Serial.print(bi);
+  Serial.println("%");
 }
 
 void CLI::serviceAutotestSequence() {
   if (!at_ || !esc_) return;
 
+  // one STEP record per finished step (the last one lands before DONE)
+  serviceStepSummaries();
+
   // single run => auto stop log when finished
   if (at_mode_ == 1) {
     if (!at_->active()) {
       if (csv_on_) { csv_on_ = false; Serial.println("OK LOG 0"); }
       Serial.println("OK AUTOTEST DONE");
+      if (at_->lastWasSweep()) {
+        // sweep may end at high throttle: leave through the normal soft stop
+        if (!stop_active_) beginSoftStop("SWEEP_DONE");
+        if (at_->lastSweepUpDown()) printSweepHysteresis();
+      } else {
+        printStepTable();
+      }
       at_mode_ = 0;
     }
     return;
   }
 
+  if (at_mode_ == 3) { serviceBatch(); return; }
+
   // two runs with a gap
   if (at_mode_ != 2 || !at_seq_active_) return;
 
@@ -455,6 +1320,7 @@ void CLI::serviceAutotestSequence() {
     if (!at_->active()) {
       if (csv_on_) { csv_on_ = false; Serial.println("OK LOG 0"); }
       Serial.println("OK AUTOTEST GAP");
+      printStepTable();
       at_seq_phase_ = 2;
       at_phase_t0_ms_ = now;
     }
@@ -475,6 +1341,7 @@ void CLI::serviceAutotestSequence() {
     if (!at_->active()) {
       if (csv_on_) { csv_on_ = false; Serial.println("OK LOG 0"); }
       Serial.println("OK AUTOTEST DONE");
+      printStepTable();
       at_seq_active_ = false;
       at_seq_phase_ = 0;
       at_mode_ = 0;
@@ -482,3 +1349,323 @@ void CLI::serviceAutotestSequence() {
     return;
   }
 }
+
+// === BATCH: queue of runs, gaps end on the cooldown gate ===
+void CLI::cmdBatch(char** tok, int n) {
+  const char* sub = (n >= 2) ? tok[1] : "list";
+
+  if (tokIs(sub, "add")) {
+    // BATCH ADD <prog|core> [test_id|-] [prop|-]
+    if (n < 3) { Serial.println("ERR batch add <prog|core> [test_id|-] [prop|-]"); return; }
+    if (batch_phase_) { Serial.println("ERR BUSY BATCH"); return; }
+    if (batch_count_ >= BATCH_MAX) { Serial.println("ERR BATCH full"); return; }
+    if (!findProgram(tok[2])) { Serial.println("ERR PROG not found"); return; }
+
+    const bool set_id = n >= 4 && strcmp(tok[3], "-") != 0;
+    const bool set_prop = n >= 5 && strcmp(tok[4], "-") != 0;
+    if (set_id && !metaFits(tok[3])) { Serial.println("ERR BATCH test_id_too_long"); return; }
+    if (set_prop && !metaFits(tok[4])) { Serial.println("ERR BATCH prop_too_long"); return; }
+
+    BatchEntry& e = batch_[batch_count_];
+    e = BatchEntry{};
+    textCopy(e.prog, tok[2]);   // fits: findProgram() matched it
+    if (set_id) metaSet(e.test_id, tok[3]);
+    if (set_prop) metaSet(e.prop, tok[4]);
+    batch_count_++;
+    Serial.print("OK BATCH ADD "); Serial.print(batch_count_);
+    Serial.print(' '); Serial.println(e.prog);
+    return;
+  }
+
+  if (tokIs(sub, "list")) {
+    for (uint8_t i = 0; i < batch_count_; i++) {
+      const BatchEntry& e = batch_[i];
+      Serial.print("BATCH "); Serial.print(i + 1); Serial.print(' '); Serial.print(e.prog);
+      Serial.print(" test_id="); Serial.print(e.test_id[0] ? e.test_id : "-");
+      Serial.print(" prop="); Serial.println(e.prop[0] ? e.prop : "-");
+    }
+    Serial.print("OK BATCH LIST runs="); Serial.print(batch_count_);
+    Serial.print(" gap_min_s="); Serial.println(batch_gap_min_s_);
+    return;
+  }
+
+  if (tokIs(sub, "clear")) {
+    if (batch_phase_) { Serial.println("ERR BUSY BATCH"); return; }
+    batch_count_ = 0;
+    Serial.println("OK BATCH CLEAR");
+    return;
+  }
+
+  if (tokIs(sub, "gap")) {
+    if (n < 3) { Serial.println("ERR batch gap <min_s>"); return; }
+    const long g = parseLongSafe(tok[2], -1);
+    if (g < 0 || g > (long)BATCH_GAP_MAX_S) { Serial.println("ERR batch gap (0..1800)"); return; }
+    batch_gap_min_s_ = (uint16_t)g;
+    Serial.print("OK BATCH GAP min_s="); Serial.println(batch_gap_min_s_);
+    return;
+  }
+
+  if (tokIs(sub, "run")) {
+    if (!at_ || !esc_) { Serial.println("ERR batch"); return; }
+    if (!armed_) { Serial.println("ERR NOT_ARMED (use start)"); return; }
+    if (batch_count_ == 0) { Serial.println("ERR BATCH empty"); return; }
+    if (at_->active() || busyJob()) { Serial.println("ERR BUSY"); return; }
+
+    metaSet(batch_meta_test_id_, meta_ ? meta_->test_id : "NA");
+    metaSet(batch_meta_prop_, meta_ ? meta_->prop : "NA");
+    at_mode_ = 3;
+    at_seq_active_ = false;
+    at_seq_phase_ = 0;
+    batch_idx_ = 0;
+    // the TEMP gate needs EDT frames, which most ESCs send only once told to
+    esc_->requestEdt();
+    Serial.print("OK BATCH START runs="); Serial.print(batch_count_);
+    Serial.print(" gap_min_s="); Serial.println(batch_gap_min_s_);
+    startBatchRun();
+    return;
+  }
+
+  if (tokIs(sub, "stop")) {
+    if (!batch_phase_) { Serial.println("ERR BATCH idle"); return; }
+    if (at_) at_->stop();
+    if (csv_on_) { csv_on_ = false; Serial.println("OK LOG 0"); }
+    finishBatch("OK BATCH STOP");
+    if (!stop_active_) beginSoftStop("BATCH_STOP");
+    return;
+  }
+
+  Serial.println("ERR batch <add|list|clear|gap|run|stop>");
+}
+
+bool CLI::startBatchRun() {
+  const BatchEntry& e = batch_[batch_idx_];
+  const AtProgram* p = findProgram(e.prog);
+  if (!p || atProgramValidate(*p) != nullptr) {
+    Serial.print("ERR BATCH PROG "); Serial.println(e.prog);
+    finishBatch(nullptr);
+    return false;
+  }
+
+  if (meta_) {
+    metaSet(meta_->test_id, e.test_id[0] ? e.test_id : batch_meta_test_id_);
+    metaSet(meta_->prop, e.prop[0] ? e.prop : batch_meta_prop_);
+  }
+
+  // announced before LOG 1 so the host can name the session after the run
+  Serial.print("OK BATCH RUN "); Serial.print(batch_idx_ + 1);
+  Serial.print('/'); Serial.print(batch_count_);
+  Serial.print(' '); Serial.print(e.prog);
+  Serial.print(' '); Serial.println(meta_ ? meta_->test_id : "NA");
+
+  batch_phase_ = 1;
+  batch_t0_ms_ = (uint32_t)millis();
+  startProgramRun(*p);
+  return true;
+}
+
+void CLI::finishBatch(const char* msg) {
+  if (!batch_phase_) return;
+  if (meta_) {
+    metaSet(meta_->test_id, batch_meta_test_id_);
+    metaSet(meta_->prop, batch_meta_prop_);
+  }
+  batch_phase_ = 0;
+  if (at_mode_ == 3) at_mode_ = 0;
+  if (msg) Serial.println(msg);
+}
+
+void CLI::serviceBatch() {
+  const uint32_t now = (uint32_t)millis();
+
+  // unattended: a tripped ESC ends the whole batch
+  if (esc_->isFailsafe()) {
+    if (at_) at_->stop();
+    if (csv_on_) { csv_on_ = false; Serial.println("OK LOG 0"); }
+    Serial.print("ERR BATCH FAILSAFE "); Serial.println(esc_->failsafeReason());
+    finishBatch(nullptr);
+    return;
+  }
+
+  if (batch_phase_ == 1) {
+    if (at_->active()) return;
+    if (csv_on_) { csv_on_ = false; Serial.println("OK LOG 0"); }
+    printStepTable();
+
+    batch_idx_++;
+    if (batch_idx_ >= batch_count_) { finishBatch("OK BATCH DONE"); return; }
+
+    gate_.reset();
+    gate_seq_ = liveFrames();
+    esc_->requestEdt();   // again while the motor idles: an ESC that browned out forgot it
+    batch_phase_ = 2;
+    batch_t0_ms_ = now;
+    batch_report_ms_ = now;
+    Serial.print("OK BATCH GAP "); Serial.print(batch_idx_);
+    Serial.print('/'); Serial.println(batch_count_);
+    return;
+  }
+
+  if (batch_phase_ != 2) return;
+
+  // one gate sample per log frame
+  if (gate_seq_ != liveFrames()) {
+    gate_seq_ = liveFrames();
+    pullLive();
+    gate_.push(lf_.esc_temp_C, lf_.i_A, lf_.v_bus_V, lf_.thrust_g);
+  }
+
+  const uint32_t age_ms = (uint32_t)(now - batch_t0_ms_);
+  const uint8_t blk = gate_.blocking();
+
+  if (age_ms >= (uint32_t)batch_gap_min_s_ * 1000u && blk == 0) {
+    Serial.print("OK BATCH GATE t_s="); Serial.println(age_ms / 1000u);
+    startBatchRun();
+    return;
+  }
+
+  if (age_ms >= BATCH_GAP_MAX_S * 1000u) {
+    // a hot ESC or a motor still drawing current is not safe to restart; drift/creep is
+    if (blk & (CooldownGate::C_TEMP | CooldownGate::C_CURRENT)) {
+      Serial.print("ERR BATCH GATE_TIMEOUT "); Serial.println(CooldownGate::condName(blk));
+      finishBatch(nullptr);
+      return;
+    }
+    Serial.print("BATCH GATE_TIMEOUT "); Serial.print(CooldownGate::condName(blk));
+    Serial.println(" (continuing)");
+    startBatchRun();
+    return;
+  }
+
+  if ((uint32_t)(now - batch_report_ms_) >= 10000u) {
+    batch_report_ms_ = now;
+    Serial.print("BATCH GAP t_s="); Serial.print(age_ms / 1000u);
+    Serial.print(" waiting=");
+    Serial.print(!gate_.full() ? "WINDOW" : (blk ? CooldownGate::condName(blk) : "MIN_GAP"));
+    Serial.print(" temp_C=");
+    if (isfinite(gate_.tempC())) Serial.print(gate_.tempC(), 0);
+    else Serial.print("n/a");   // no EDT: the gate goes by current, V_bus and zero only
+    Serial.print(" I_A="); printFinite(gate_.meanOf(CooldownGate::CH_I), 3, "");
+    Serial.print(" dV="); printFinite(gate_.driftOf(CooldownGate::CH_VBUS), 3, "");
+    Serial.print(" zero_g="); printFinite(gate_.meanOf(CooldownGate::CH_THRUST), 2, "\n");
+  }
+}
+
+// === STAT? / GET: single-line key=value replies from the live snapshot ===
+void CLI::queryBegin(const char* verb) {
+  pullLive();
+  qline_.len = 0;
+  qline_.overflow = false;
+  if (reply_tag_) { qline_.add(reply_tag_); qline_.add(' '); reply_tagged_ = true; }
+  qline_.add(verb);
+}
+
+// a reply cut at QUERY_LINE_MAX would parse as a complete one: send an error line instead
+void CLI::queryEnd(const char* verb) {
+  if (qline_.overflow) {
+    qline_.len = 0;
+    if (reply_tag_) { qline_.add(reply_tag_); qline_.add(' '); }
+    qline_.add("ERR ");
+    qline_.add(verb);
+    qline_.add(" too_long");
+  }
+  qline_.send();
+}
+
+void CLI::addQueryValue(QueryKey k) {
+  QueryLine& q = qline_;
+  q.add(' ');
+  q.add(queryKeyName(k));
+  q.add('=');
+
+  EscBdshot* p = esc_ ? &esc_->primary() : nullptr;
+  switch (k) {
+    case QK_FSEQ:       q.addUInt(liveFrames()); break;
+    case QK_T_MS:       q.addUInt((uint32_t)millis()); break;
+    case QK_ARMED:      q.addUInt(armed_ ? 1 : 0); break;
+    case QK_LOG:        q.addUInt(csv_on_ ? 1 : 0); break;
+    case QK_MODE:       q.add((p && p->rpmMode()) ? "RPM" : "THR"); break;
+    case QK_THR:        q.addFloat(p ? p->currentThrottlePct() : NAN, 2); break;
+    case QK_THR_TGT:    q.addFloat(p ? p->targetThrottlePct() : NAN, 2); break;
+    case QK_RPM:        q.addUInt(lf_.rpm); break;
+    case QK_ERPM:       q.addUInt(lf_.erpm); break;
+    case QK_RPM_SP:     q.addFloat((p && p->rpmMode()) ? (float)p->rpmSetpoint() : NAN, 0); break;
+    case QK_BDSHOT_ERR: q.addFloat(lf_.bdshot_err_pct, 2); break;
+    case QK_TEMP_C:     q.addFloat(lf_.esc_temp_C, 0); break;
+    case QK_V:          q.addFloat(lf_.v_bus_V, 3); break;
+    case QK_I:          q.addFloat(lf_.i_A, 3); break;
+    case QK_P:          q.addFloat(lf_.p_in_W, 2); break;
+    case QK_THRUST_G:   q.addFloat(lf_.thrust_g, 2); break;
+    case QK_THRUST_N:   q.addFloat(lf_.thrust_N, 4); break;
+    case QK_HX_RAW:     q.addInt(lf_.hx_raw); break;
+    case QK_HX_NOISE:   q.addInt(lf_.hx_noise_pp); break;
+    case QK_FAILSAFE:   q.addUInt((esc_ && esc_->isFailsafe()) ? 1 : 0); break;
+    case QK_FS_REASON:  q.add(esc_ ? esc_->failsafeReason() : "-"); break;
+    case QK_OVERRUNS:   q.addUInt(guard_ ? guard_->overruns() : 0); break;
+    case QK_AT:         q.addUInt((at_ && at_->active()) ? 1 : 0); break;
+    case QK_STEP:       q.addInt((at_ && at_->active()) ? (int32_t)at_->stepId() : -1); break;
+    case QK_STEADY:     q.addUInt((at_ && at_->active() && at_->isSteady()) ? 1 : 0); break;
+    case QK_JOB:        q.add(busyJob() ? busyJob() : "-"); break;
+    default:            q.add('?'); break;
+  }
+}
+
+void CLI::cmdStat(char**, int) {
+  queryBegin("STAT");
+  for (uint8_t k = 0; k < QK_COUNT; k++) addQueryValue((QueryKey)k);
+  queryEnd("STAT");
+}
+
+void CLI::cmdGet(char** tok, int n) {
+  // keys separated by commas and/or spaces; all are checked before anything is sent
+  for (int t = 1; t < n; t++) {
+    for (const char* s = tok[t]; *s; ) {
+      const char* e = s;
+      while (*e && *e != ',') e++;
+      if (e > s && queryKeyFind(s, (size_t)(e - s)) < 0) {
+        if (reply_tag_) { Serial.print(reply_tag_); Serial.print(' '); reply_tagged_ = true; }
+        Serial.print("ERR GET unknown_key ");
+        Serial.write((const uint8_t*)s, (size_t)(e - s));
+        Serial.println();
+        return;
+      }
+      s = *e ? e + 1 : e;
+    }
+  }
+
+  queryBegin("GET");
+  for (int t = 1; t < n; t++) {
+    for (const char* s = tok[t]; *s; ) {
+      const char* e = s;
+      while (*e && *e != ',') e++;
+      if (e > s) addQueryValue((QueryKey)queryKeyFind(s, (size_t)(e - s)));
+      s = *e ? e + 1 : e;
+    }
+  }
+  queryEnd("GET");
+}
+
+// BENCH [case|all] [reps]: hot-path microbenchmarks (bench.h). The loop waits while they run,
+// so only with the motor stopped.
+void CLI::cmdBench(char** tok, int n) {
+  if (armed_ || (esc_ && esc_->currentThrottlePct() > 0.0f)) { Serial.println("ERR ARMED (use stop)"); return; }
+  if ((at_ && at_->active()) || busyJob()) { Serial.println("ERR BUSY"); return; }
+
+  const char* filter = "all";
+  if (n >= 2) { cliLowerInPlace(tok[1]); filter = tok[1]; }
+  const long reps = (n >= 3) ? parseLongSafe(tok[2], -1) : BENCH_REPS_DEFAULT;
+  if (reps < 1 || reps > BENCH_REPS_MAX) { Serial.print("ERR bench [case|all] [1.."); Serial.print(BENCH_REPS_MAX); Serial.println("]"); return; }
+
+  // cli_get re-enters handleLine(), which clears the request tag on the way out
+  const char* tag = reply_tag_;
+  const bool tagged = reply_tagged_;
+  const uint8_t cases = benchRun(filter, (uint8_t)reps, *this);
+  reply_tag_ = tag;
+  reply_tagged_ = tagged;
+  if (cases == 0) {
+    Serial.print("ERR BENCH unknown case, one of: all");
+    for (uint8_t i = 0; benchCaseName(i); i++) { Serial.print(' '); Serial.print(benchCaseName(i)); }
+    Serial.println();
+    return;
+  }
+  Serial.print("OK BENCH "); Serial.println(cases);
+}
@@ -1,65 +1,184 @@
 #pragma once
 #include <Arduino.h>
-
-class EscBdshot;
+#include "ramp.h"
+#include "thrcal.h"
+#include "program.h"
+#include "storage.h"
+#include "stepresp.h"
+#include "batch.h"
+#include "meta.h"
+#include "query.h"
+#include "snapshot.h"
+#include "loopguard.h"
+#include "limitguard.h"
+
+class EscGroup;
 class SensorsHx711;
 class SensorsIna226;
-struct Meta;
 class AutoTest;
 
 class CLI {
 public:
   void begin();
-  void bind(EscBdshot* esc, SensorsHx711* hx, SensorsIna226* ina, Meta* meta, AutoTest* at);
+  void bind(EscGroup* esc, SensorsHx711* hx, SensorsIna226* ina, Meta* meta, AutoTest* at,
+            const FrameSnapshot* live, const LoopGuard* guard, LimitGuard* limits);
+
+  // re-apply the last PRESET LOAD / SAVE (after bind), throttle cals excepted: THRCAL slots win
+  void restorePreset();
 
   void tick();
-  void handleLine(const String& line);
+  // one command line, tokenized in place (modified)
+  void handleLine(char* line);
+  // GET / STAT reply lines go to out instead of Serial (nullptr = Serial again); BENCH's cli_get
+  void setQueryOut(Print* out) { qline_.out = out; }
 
   // runtime control
   bool csvOn() const { return csv_on_; }
   bool armed() const { return armed_; }
-  const String& notes() const { return notes_; }   // public getter
-
-  // live snapshot for status
-  void setLive(float thrust_g, float thrust_N,
-               float vbus_V, float i_A, float p_W,
-               uint32_t erpm, uint32_t rpm, float bdshot_err_pct,
-               int32_t hx_raw, int32_t hx_offset, float hx_scale,
-               bool hx_cal_valid, bool hx_inverted,
-               int32_t hx_noise_pp);
+  bool rpmStreamOn() const { return rpm_stream_on_; }
+  const char* notes() const { return notes_; }   // public getter
 
 private:
+  // command handlers (table in handleLine): tok[0] = command, n = token count
+  void cmdHelp(char** tok, int n);
+  void cmdStatus(char** tok, int n);
+  void cmdStopRamp(char** tok, int n);
+  void cmdRampProf(char** tok, int n);
+  void cmdLog(char** tok, int n);
+  void cmdAdaptive(char** tok, int n);
+  void cmdRpmStream(char** tok, int n);
+  void cmdJitter(char** tok, int n);
+  void cmdTare(char** tok, int n);
+  void cmdCal(char** tok, int n);
+  void cmdCalTrim(char** tok, int n);
+  void cmdSave(char** tok, int n);
+  void cmdLoad(char** tok, int n);
+  void cmdResetCal(char** tok, int n);
+  void cmdSetMeta(char** tok, int n);
+  void cmdStart(char** tok, int n);
+  void cmdEstop(char** tok, int n);
+  void cmdStop(char** tok, int n);
+  void cmdAutotest(char** tok, int n);
+  void cmdRpm(char** tok, int n);
+  void cmdRpmPid(char** tok, int n);
+  void cmdThrottle(char** tok, int n);
+  void cmdThrCal(char** tok, int n);
+  void cmdStepResp(char** tok, int n);
+  void cmdEscs(char** tok, int n);
+  void cmdI2cScan(char** tok, int n);
+  void cmdPreset(char** tok, int n);
+  void printPreset(const PresetData& p, int slot);   // slot < 0: not shown
+  bool applyPreset(const PresetData& p, bool thrcal);
+  void cmdLimit(char** tok, int n);
+  void printLimits();
+  void cmdStat(char** tok, int n);
+  void cmdGet(char** tok, int n);
+  void cmdBench(char** tok, int n);
+
+  // STAT? / GET: one key=value line, tagged with the request's @seq if any
+  void queryBegin(const char* verb);
+  void addQueryValue(QueryKey k);
+  void queryEnd(const char* verb);
+
   void printStatus();
+  void pullLive();
+  uint32_t liveFrames() const { return live_ ? live_->frames() : 0; }
 
   // autotest helpers (from your previous version)
   void serviceAutotestSequence();
+  void serviceStepSummaries();
+  void printStepTable();
+  void printSweepHysteresis();
+  void buildCoreProgram(AtProgram& p);
   void startAutotestCoreRun();
+  bool startProgramRun(const AtProgram& p);
+
+  // PROG upload / flash programs
+  void cmdProg(char** tok, int n);
+  void printProgram(const AtProgram& p);
+  // uploaded (RAM) program, builtin core, then flash; nullptr if not found
+  const AtProgram* findProgram(const char* name);
+
+  // BATCH queue: runs back to back, each gap ends on the cooldown gate
+  void cmdBatch(char** tok, int n);
+  void serviceBatch();
+  bool startBatchRun();
+  void finishBatch(const char* msg);
+
+  // exclusive motor jobs (THRCAL / STEPRESP): name of the running one, nullptr if none
+  const char* busyJob() const;
+
+  // throttle calibration sweep
+  void serviceThrCal();
+  void printThrCal(uint8_t m);
+
+  // step response capture
+  void serviceStepResp();
 
   // soft-stop
   void beginSoftStop(const char* reason_tag);
   void serviceSoftStop();
 
 private:
-  String buf_;
+  char line_[CLI_LINE_MAX + 1]{};
+  uint16_t line_len_ = 0;
+  bool line_overflow_ = false;
+
+  // query protocol: "@<seq> <cmd>" tags the reply; untagged-reply commands get "@<seq> END"
+  const char* reply_tag_ = nullptr;
+  bool reply_tagged_ = false;
+  QueryLine qline_;
 
   // bindings
-  EscBdshot* esc_ = nullptr;
+  EscGroup* esc_ = nullptr;
   SensorsHx711* hx_ = nullptr;
   SensorsIna226* ina_ = nullptr;
   Meta* meta_ = nullptr;
   AutoTest* at_ = nullptr;
+  const FrameSnapshot* live_ = nullptr;
+  const LoopGuard* guard_ = nullptr;
+  LimitGuard* limits_ = nullptr;
 
   // state
   bool armed_ = false;
   bool csv_on_ = false;
-  String notes_ = "OK";
+  bool rpm_stream_on_ = false;
+  RampProfile ramp_prof_ = RAMP_LINEAR;  // THROTTLE, AUTOTEST steps, soft stop
+  ThrottleCal thrcal_;
+  StepResp stepresp_;
+
+  // programs: PROG BEGIN..END streams into prog_edit_, prog_tmp_ is load/run scratch
+  CalStorage store_;
+  AtProgram prog_edit_;
+  AtProgram prog_tmp_;
+  bool prog_edit_open_ = false;
+  bool prog_edit_ready_ = false;
+
+  // presets: name of the applied one ("" = none), preset_tmp_ is load/save scratch
+  char preset_[PresetData::NAME_LEN]{};
+  PresetData preset_tmp_;
+  const char* notes_ = "OK";
 
   // autotest sequence (CORE2)
-  uint8_t at_mode_ = 0;          // 0=idle, 1=core (single), 2=core2 (two runs)
+  uint8_t at_mode_ = 0;          // 0=idle, 1=core (single), 2=core2 (two runs), 3=batch
   bool at_seq_active_ = false;
   uint8_t at_seq_phase_ = 0;      // 0=idle, 1=run1, 2=gap, 3=run2
   uint32_t at_phase_t0_ms_ = 0;
   uint16_t at_gap_s_ = 90;
+  uint8_t at_sum_printed_ = 0;    // STEP summary lines already sent
+
+  // batch queue (at_mode_ 3)
+  BatchEntry batch_[BATCH_MAX];
+  uint8_t batch_count_ = 0;
+  uint8_t batch_idx_ = 0;         // run in progress / next run
+  uint8_t batch_phase_ = 0;       // 0=idle, 1=run, 2=gap
+  uint32_t batch_t0_ms_ = 0;
+  uint32_t batch_report_ms_ = 0;
+  uint16_t batch_gap_min_s_ = BATCH_GAP_MIN_S_DEFAULT;
+  CooldownGate gate_;
+  uint32_t gate_seq_ = 0;
+  char batch_meta_test_id_[Meta::FIELD_LEN]{};   // SETMETA values restored after the batch
+  char batch_meta_prop_[Meta::FIELD_LEN]{};
 
   // === SOFT STOP settings/state ===
   bool stop_active_ = false;
@@ -69,22 +188,6 @@ private:
   uint32_t stop_timeout_ms_ = 6000;   // failsafe timeout for stopping
   const char* stop_reason_ = "STOP";
 
-  // live snapshot values
-  float st_thrust_g_ = NAN;
-  float st_thrust_N_ = NAN;
-
-  float st_vbus_V_ = NAN;
-  float st_i_A_ = NAN;
-  float st_p_W_ = NAN;
-
-  uint32_t st_erpm_ = 0;
-  uint32_t st_rpm_ = 0;
-  float st_bdshot_err_pct_ = 100.0f;
-
-  int32_t st_hx_raw_ = 0;
-  int32_t st_hx_offset_ = 0;
-  float st_hx_scale_ = 1.0f;
-  bool st_hx_cal_valid_ = false;
-  bool st_hx_inverted_ = false;
-  int32_t st_hx_noise_pp_ = -1;
+  // latest published frame (pullLive() refreshes lf_)
+  Frame lf_;
 };
@@ -0,0 +1,116 @@
+#include "crc.h"
+#include "cfg.h"
+
+#if defined(ARDUINO_ARCH_RP2040)
+#include <hardware/dma.h>
+#endif
+
+// slice-by-4: T[0] is the classic byte table, T[k][i] = CRC of byte i followed by k zero bytes
+struct Crc32Tables {
+  uint32_t t[4][256];
+  constexpr Crc32Tables() : t() {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int b = 0; b < 8; b++) c = (c >> 1) ^ (0xEDB88320UL & (0U - (c & 1U)));
+      t[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+      for (int k = 1; k < 4; k++) t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+    }
+  }
+};
+static constexpr Crc32Tables CRC_T{};
+
+uint32_t crc32IeeeTable(const void* data, size_t len, uint32_t crc) {
+  const uint8_t* p = (const uint8_t*)data;
+  crc = ~crc;
+
+  // byte-wise up to a word boundary, then 4 bytes per step (little endian)
+  while (len && ((uintptr_t)p & 3u)) { crc = (crc >> 8) ^ CRC_T.t[0][(crc ^ *p++) & 0xFF]; len--; }
+  while (len >= 4) {
+    crc ^= (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    crc = CRC_T.t[3][crc & 0xFF] ^ CRC_T.t[2][(crc >> 8) & 0xFF] ^
+          CRC_T.t[1][(crc >> 16) & 0xFF] ^ CRC_T.t[0][crc >> 24];
+    p += 4;
+    len -= 4;
+  }
+  while (len--) crc = (crc >> 8) ^ CRC_T.t[0][(crc ^ *p++) & 0xFF];
+  return ~crc;
+}
+
+#if defined(ARDUINO_ARCH_RP2040)
+
+static inline uint32_t bitrev32(uint32_t v) {
+  v = ((v >> 1) & 0x55555555UL) | ((v & 0x55555555UL) << 1);
+  v = ((v >> 2) & 0x33333333UL) | ((v & 0x33333333UL) << 2);
+  v = ((v >> 4) & 0x0F0F0F0FUL) | ((v & 0x0F0F0F0FUL) << 4);
+  v = ((v >> 8) & 0x00FF00FFUL) | ((v & 0x00FF00FFUL) << 8);
+  return (v >> 16) | (v << 16);
+}
+
+static int crc_dma_ch = -2;          // -2 = not claimed yet, -1 = none free
+static volatile bool crc_dma_busy = false;
+
+// DMA byte copy into one dummy word with the sniffer on (CRC-32, bit-reversed data).
+// The sniffer keeps the unreflected state: seed = bitrev(~crc), read back reversed + inverted.
+static bool crc32Dma(const void* data, size_t len, uint32_t& crc) {
+  if (crc_dma_ch == -2) crc_dma_ch = dma_claim_unused_channel(false);
+  if (crc_dma_ch < 0 || crc_dma_busy) return false;
+  crc_dma_busy = true;
+
+  static uint32_t sink;
+  const uint ch = (uint)crc_dma_ch;
+  dma_channel_config c = dma_channel_get_default_config(ch);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_sniff_enable(&c, true);
+
+  dma_sniffer_enable(ch, DMA_SNIFF_CTRL_CALC_VALUE_CRC32R, true);
+  dma_sniffer_set_output_reverse_enabled(true);
+  dma_sniffer_set_output_invert_enabled(true);
+  dma_sniffer_set_data_accumulator(bitrev32(~crc));
+
+  dma_channel_configure(ch, &c, &sink, data, len, true);
+  dma_channel_wait_for_finish_blocking(ch);
+
+  crc = dma_sniffer_get_data_accumulator();
+  dma_sniffer_disable();
+  crc_dma_busy = false;
+  return true;
+}
+
+#endif
+
+uint32_t crc32Ieee(const void* data, size_t len, uint32_t crc) {
+#if defined(ARDUINO_ARCH_RP2040)
+  if (len >= CRC_DMA_MIN_LEN && crc32Dma(data, len, crc)) return crc;
+#endif
+  return crc32IeeeTable(data, len, crc);
+}
+
+static int8_t selftest_ok = -1;   // -1: not run yet
+
+static bool crcSelfTestRun() {
+  static const char CHECK[] = "123456789";   // catalogue check value 0xCBF43926
+  static uint8_t buf[CRC_DMA_MIN_LEN * 2];
+  for (size_t i = 0; i < sizeof(buf); i++) buf[i] = (uint8_t)(i * 37u + 11u);
+
+  if (crc32IeeeTable(CHECK, 9) != 0xCBF43926UL) return false;
+  if (crc32Ieee(CHECK, 9) != 0xCBF43926UL) return false;
+
+  // long buffers take the hardware path on target: same value, split or not, any alignment
+  const uint32_t ref = crc32IeeeTable(buf, sizeof(buf));
+  if (crc32Ieee(buf, sizeof(buf)) != ref) return false;
+  if (crc32Ieee(buf + CRC_DMA_MIN_LEN, CRC_DMA_MIN_LEN, crc32Ieee(buf, CRC_DMA_MIN_LEN)) != ref) return false;
+  return crc32Ieee(buf + 1, sizeof(buf) - 1) == crc32IeeeTable(buf + 1, sizeof(buf) - 1);
+}
+
+bool crcSelfTest() {
+  selftest_ok = crcSelfTestRun() ? 1 : 0;
+  return selftest_ok == 1;
+}
+
+bool crcSelfTestPassed() {
+  return selftest_ok < 0 ? crcSelfTest() : selftest_ok == 1;
+}
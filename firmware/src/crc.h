@@ -0,0 +1,18 @@
+#pragma once
+#include <Arduino.h>
+
+// CRC-32 (IEEE 802.3 / zlib: reflected poly 0xEDB88320, init and final xor 0xFFFFFFFF) for every
+// integrity check in the firmware (store records, legacy blobs).
+// Chains: crc32Ieee(b, lb, crc32Ieee(a, la)) == crc32Ieee(a || b).
+//
+// On the RP2040 buffers of CRC_DMA_MIN_LEN bytes and more go through the DMA sniffer (one byte
+// per clock); shorter ones, the host build and a busy sniffer use slice-by-4 tables. Main-loop
+// use only (not from IRQs or the other core: one sniffer).
+uint32_t crc32Ieee(const void* data, size_t len, uint32_t crc = 0);
+// table version only (reference for the self-test, benchmarks)
+uint32_t crc32IeeeTable(const void* data, size_t len, uint32_t crc = 0);
+
+// boot check: "123456789" -> 0xCBF43926 on both paths, chaining included
+bool crcSelfTest();
+// result of the last crcSelfTest() (runs it if it never ran) -> STATUS
+bool crcSelfTestPassed();
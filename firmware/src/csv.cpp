@@ -1,60 +1,121 @@
 #include "csv.h"
 #include "esc_bdshot.h"
+#include "autotest.h"
 
-static void printFieldStr(const String& s) {
-  if (s.length() == 0) Serial.print("NA");
-  else Serial.print(s);
+static void printFieldStr(const char* s, Print& out = Serial) {
+  if (!s || !s[0]) out.print("NA");
+  else out.print(s);
 }
 
-static void printFieldFloat(float v, int prec = 6) {
-  if (!isfinite(v)) Serial.print("NaN");
-  else Serial.print(v, prec);
+static void printFieldFloat(float v, int prec = 6, Print& out = Serial) {
+  if (!isfinite(v)) out.print("NaN");
+  else out.print(v, prec);
 }
 
-static void printFieldInt(long v) {
-  Serial.print(v);
+static void printFieldInt(long v, Print& out = Serial) {
+  out.print(v);
 }
 
-void printCsvFrame(const Frame& f, const Meta& meta, const EscBdshot& esc, const String& notes) {
-  // 24 columns, no header:
+void printCsvFrame(const Frame& f, const Meta& meta, const char* notes, Print& out) {
+  // 38 columns, no header:
   // t_ms, test_id, motor_id, kv, prop, battery_s, esc_fw, pole_pairs, step_id, throttle_pct,
   // step_time_s, is_steady, eRPM, RPM, V_bus_V, I_A, P_in_W, thrust_N, thrust_g,
-  // eff_g_per_W, eff_N_per_W, eff_g_per_A, bdshot_err_pct, notes
+  // eff_g_per_W, eff_N_per_W, eff_g_per_A, bdshot_err_pct, RPM_mean, RPM_min, RPM_max,
+  // RPM_sp, RPM_err, m2_throttle_pct, m2_RPM, m2_bdshot_err_pct, ... (m2..m4), notes
 
-  printFieldInt((long)f.t_ms); Serial.print(',');
+  printFieldInt((long)f.t_ms, out); out.print(',');
 
-  printFieldStr(meta.test_id); Serial.print(',');
-  printFieldStr(meta.motor_id); Serial.print(',');
+  printFieldStr(meta.test_id, out); out.print(',');
+  printFieldStr(meta.motor_id, out); out.print(',');
 
-  printFieldInt(meta.kv); Serial.print(',');
-  printFieldStr(meta.prop); Serial.print(',');
-  printFieldInt(meta.battery_s); Serial.print(',');
+  printFieldInt(meta.kv, out); out.print(',');
+  printFieldStr(meta.prop, out); out.print(',');
+  printFieldInt(meta.battery_s, out); out.print(',');
 
-  printFieldStr(meta.esc_fw); Serial.print(',');
-  printFieldInt((long)meta.pole_pairs); Serial.print(',');
+  printFieldStr(meta.esc_fw, out); out.print(',');
+  printFieldInt((long)meta.pole_pairs, out); out.print(',');
 
-  printFieldInt((long)f.step_id); Serial.print(',');
-  printFieldFloat(f.throttle_pct, 2); Serial.print(',');
+  printFieldInt((long)f.step_id, out); out.print(',');
+  printFieldFloat(f.throttle_pct, 2, out); out.print(',');
 
-  printFieldFloat(f.step_time_s, 3); Serial.print(',');
-  printFieldInt((long)f.is_steady); Serial.print(',');
+  printFieldFloat(f.step_time_s, 3, out); out.print(',');
+  printFieldInt((long)f.is_steady, out); out.print(',');
 
-  printFieldInt((long)f.erpm); Serial.print(',');
-  printFieldInt((long)f.rpm); Serial.print(',');
+  printFieldInt((long)f.erpm, out); out.print(',');
+  printFieldInt((long)f.rpm, out); out.print(',');
 
-  printFieldFloat(f.v_bus_V, 6); Serial.print(',');
-  printFieldFloat(f.i_A, 6); Serial.print(',');
-  printFieldFloat(f.p_in_W, 6); Serial.print(',');
+  printFieldFloat(f.v_bus_V, 6, out); out.print(',');
+  printFieldFloat(f.i_A, 6, out); out.print(',');
+  printFieldFloat(f.p_in_W, 6, out); out.print(',');
 
-  printFieldFloat(f.thrust_N, 6); Serial.print(',');
-  printFieldFloat(f.thrust_g, 6); Serial.print(',');
+  printFieldFloat(f.thrust_N, 6, out); out.print(',');
+  printFieldFloat(f.thrust_g, 6, out); out.print(',');
 
-  printFieldFloat(f.eff_g_per_W, 6); Serial.print(',');
-  printFieldFloat(f.eff_N_per_W, 6); Serial.print(',');
-  printFieldFloat(f.eff_g_per_A, 6); Serial.print(',');
+  printFieldFloat(f.eff_g_per_W, 6, out); out.print(',');
+  printFieldFloat(f.eff_N_per_W, 6, out); out.print(',');
+  printFieldFloat(f.eff_g_per_A, 6, out); out.print(',');
 
-  printFieldFloat(f.bdshot_err_pct, 6); Serial.print(',');
+  printFieldFloat(f.bdshot_err_pct, 6, out); out.print(',');
 
-  printFieldStr(notes);
+  printFieldFloat(f.rpm_mean, 1, out); out.print(',');
+  printFieldInt((long)f.rpm_min, out); out.print(',');
+  printFieldInt((long)f.rpm_max, out); out.print(',');
+
+  printFieldFloat(f.rpm_sp, 0, out); out.print(',');
+  printFieldFloat(f.rpm_err, 1, out); out.print(',');
+
+  for (uint8_t i = 0; i < ESC_COUNT_MAX - 1; i++) {
+    printFieldFloat(f.aux[i].throttle_pct, 2, out); out.print(',');
+    printFieldFloat(f.aux[i].rpm, 0, out); out.print(',');
+    printFieldFloat(f.aux[i].bdshot_err_pct, 6, out); out.print(',');
+  }
+
+  printFieldStr(notes, out);
+  out.println();
+}
+
+void printRpmStreamSample(const ErpmSample& s, uint8_t pole_pairs) {
+  Serial.print("RPM,");
+  Serial.print((unsigned long)s.t_us); Serial.print(',');
+  printFieldInt((long)s.erpm); Serial.print(',');
+  printFieldInt((long)(s.erpm / (pole_pairs ? pole_pairs : 1)));
+  Serial.println();
+}
+
+static const char* const STEP_CH_NAMES[AT_SUM_COUNT] = {
+  "thrust_g", "I_A", "V_bus_V", "P_in_W", "RPM", "eff_g_per_W"
+};
+
+void printStepSummaryHeader() {
+  Serial.print("STEPHDR,prog,step_id,type,value,end,basis,n,step_s");
+  for (uint8_t c = 0; c < AT_SUM_COUNT; c++) {
+    Serial.print(','); Serial.print(STEP_CH_NAMES[c]); Serial.print("_mean");
+    Serial.print(','); Serial.print(STEP_CH_NAMES[c]); Serial.print("_std");
+    Serial.print(','); Serial.print(STEP_CH_NAMES[c]); Serial.print("_min");
+    Serial.print(','); Serial.print(STEP_CH_NAMES[c]); Serial.print("_max");
+  }
+  Serial.println();
+}
+
+void printStepSummary(const AtStepSummary& s, const char* prog) {
+  static const char* const BASIS[] = { "NONE", "POSTRAMP", "STEADY" };
+
+  Serial.print("STEP,");
+  printFieldStr(prog); Serial.print(',');
+  printFieldInt((long)s.step_id); Serial.print(',');
+  Serial.print(s.type == AT_STEP_RPM ? "rpm" : "thr"); Serial.print(',');
+  printFieldFloat(s.value, 2); Serial.print(',');
+  Serial.print(s.ended_steady ? "STEADY" : "TIMEOUT"); Serial.print(',');
+  Serial.print(BASIS[s.basis <= AT_BASIS_STEADY ? s.basis : 0]); Serial.print(',');
+  printFieldInt((long)s.frames); Serial.print(',');
+  printFieldFloat(s.step_s, 1);
+
+  for (uint8_t c = 0; c < AT_SUM_COUNT; c++) {
+    const RunningStat& r = s.st[c];
+    Serial.print(','); printFieldFloat(r.meanOrNan(), 4);
+    Serial.print(','); printFieldFloat(r.std(), 4);
+    Serial.print(','); printFieldFloat(r.min, 4);
+    Serial.print(','); printFieldFloat(r.max, 4);
+  }
   Serial.println();
 }
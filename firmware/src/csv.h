@@ -3,7 +3,17 @@
 #include "frame.h"
 #include "meta.h"
 
-class EscBdshot;
+struct ErpmSample;
+struct AtStepSummary;
 
-// Print CSV line in required 24-column format (no header)
-void printCsvFrame(const Frame& f, const Meta& meta, const EscBdshot& esc, const String& notes);
+// Print CSV line in required 38-column format (no header); out = Serial except in BENCH
+void printCsvFrame(const Frame& f, const Meta& meta, const char* notes, Print& out = Serial);
+
+// High-rate RPM-only stream line: "RPM,<t_us>,<erpm>,<rpm>" (ignored by the CSV logger)
+void printRpmStreamSample(const ErpmSample& s, uint8_t pole_pairs);
+
+// Per-step autotest summary (ignored by the CSV logger, saved to <log>_steps.csv by the monitor):
+// "STEP,<prog>,<step_id>,<thr|rpm>,<value>,<STEADY|TIMEOUT>,<STEADY|POSTRAMP|NONE>,<n>,<step_s>,"
+// then mean,std,min,max for thrust_g, I_A, V_bus_V, P_in_W, RPM, eff_g_per_W
+void printStepSummaryHeader();
+void printStepSummary(const AtStepSummary& s, const char* prog);
@@ -3,7 +3,15 @@
 
 #include <Arduino.h>
 #include <math.h>
-#include <PIO_DShot.h>  // pico-bidir-dshot
+#include "hal.h"
+
+// tickSend() may run from the send alarm IRQ: main-loop accessors that touch
+// multi-word state take a short critical section.
+struct IrqGuard {
+  uint32_t saved;
+  IrqGuard() : saved(hal::irqSave()) {}
+  ~IrqGuard() { hal::irqRestore(saved); }
+};
 
 static inline float clampf(float x, float lo, float hi) {
   if (x < lo) return lo;
@@ -17,32 +25,58 @@ static inline uint64_t us_now() { return (uint64_t)micros(); }
 // After this age (at low throttle), we'll present RPM=0 to avoid "stale cached RPM" in STATUS/CSV.
 static constexpr uint32_t STOPPED_STALE_RPM_MS = 250;
 
-bool EscBdshot::begin(uint8_t pin, uint16_t dshot_speed) {
+// Hampel: reject if |x - median| > 3 * 1.4826 * MAD, but never tighter than median/20 (5%).
+// eRPM is period-quantized, so at steady speed MAD is often 0.
+static constexpr uint32_t HAMPEL_K_X1000 = 4448;
+static constexpr uint32_t HAMPEL_MIN_DEV_DIV = 20;
+
+// RPM controller output range / slew in 0.01 % units
+static constexpr int64_t RPM_OUT_MAX_Q24 = (int64_t)10000 << 24;
+static constexpr int32_t RPM_SLEW_CPCT_PER_SEND =
+  (int32_t)(RPM_CTRL_MAX_SLEW_PCT_PER_S * 100.0f * (float)ESC_SEND_PERIOD_US / 1000000.0f);
+static_assert(RPM_SLEW_CPCT_PER_SEND > 0, "RPM_CTRL_MAX_SLEW_PCT_PER_S too low for ESC_SEND_PERIOD_US");
+
+static void sortSmall(uint32_t* a, uint8_t n) {
+  // insertion sort (n <= ERPM_HAMPEL_WIN)
+  for (uint8_t i = 1; i < n; i++) {
+    uint32_t key = a[i];
+    int j = (int)i - 1;
+    while (j >= 0 && a[j] > key) { a[j + 1] = a[j]; j--; }
+    a[j + 1] = key;
+  }
+}
+
+bool EscBdshot::begin(uint8_t pin, uint16_t dshot_speed, uint32_t send_phase_us) {
   pin_ = pin;
   speed_ = dshot_speed;
 
-  auto* e = new BidirDShotX1(pin_, speed_);
-  esc_ = (void*)e;
+  dshot_ = hal::dshotOpen(pin_, speed_);
+  if (dshot_ < 0) return false;
 
   current_throttle_pct_ = 0.0f;
   target_throttle_pct_  = 0.0f;
-
-  ramp_rate_pct_per_s_ = 9999.0f;
-  last_ramp_ms_ = ms_now();
-  last_send_us_ = us_now();
+  ramp_.reset(0);
+  buildDshotLut();
+  next_send_us_ = us_now() + (send_phase_us % ESC_SEND_PERIOD_US);
 
   // Start with clean telemetry state
   last_rpm_update_ms_ = ms_now();
   last_erpm_cached_ = 0;
   telemetry_seen_ = false;
 
+  rpm_mode_ = false;
+  setRpmGains(kp_, ki_, kd_);
+
   clearFailsafe();
   return true;
 }
 
 void EscBdshot::clearFailsafe() {
+  IrqGuard g;
+
   // Clear failsafe latch
   failsafe_ = false;
+  failsafe_soft_ = false;
   failsafe_reason_ = "OK";
 
   // Reset telemetry expectation so RPM_TIMEOUT cannot trigger
@@ -50,107 +84,489 @@ void EscBdshot::clearFailsafe() {
   telemetry_seen_ = false;
   last_erpm_cached_ = 0;
   last_rpm_update_ms_ = ms_now();
+
+  telStatsReset();
+
+  hampel_head_ = 0;
+  hampel_count_ = 0;
+  rpm_outliers_ = 0;
+  rpmAccReset();
+
+  rpm_filt_init_ = false;
+  rpm_filt_q4_ = 0;
+  rpm_filt_prev_q4_ = 0;
+}
+
+void EscBdshot::telStatsReset() {
+  tel_win_head_ = 0;
+  tel_win_count_ = 0;
+  for (uint8_t i = 0; i < 3; i++) {
+    tel_win_cnt_[i] = 0;
+    tel_tot_cnt_[i] = 0;
+  }
+}
+
+void EscBdshot::telStatsPush(TelOutcome o) {
+  // drop the oldest outcome once the window is full (O(1) per send)
+  if (tel_win_count_ >= BDSHOT_ERR_WINDOW) {
+    tel_win_cnt_[tel_win_[tel_win_head_]]--;
+  } else {
+    tel_win_count_++;
+  }
+  tel_win_[tel_win_head_] = (uint8_t)o;
+  tel_win_head_ = (uint16_t)((tel_win_head_ + 1) % BDSHOT_ERR_WINDOW);
+
+  tel_win_cnt_[o]++;
+  tel_tot_cnt_[o]++;
+}
+
+bool EscBdshot::hampelAccept(uint32_t erpm) {
+  bool accept = true;
+
+  // warm-up: accept until the window is full
+  if (hampel_count_ >= ERPM_HAMPEL_WIN) {
+    uint32_t tmp[ERPM_HAMPEL_WIN];
+    for (uint8_t i = 0; i < ERPM_HAMPEL_WIN; i++) tmp[i] = hampel_win_[i];
+    sortSmall(tmp, ERPM_HAMPEL_WIN);
+    const uint32_t med = tmp[ERPM_HAMPEL_WIN / 2];
+
+    for (uint8_t i = 0; i < ERPM_HAMPEL_WIN; i++) {
+      tmp[i] = (hampel_win_[i] > med) ? (hampel_win_[i] - med) : (med - hampel_win_[i]);
+    }
+    sortSmall(tmp, ERPM_HAMPEL_WIN);
+    const uint32_t mad = tmp[ERPM_HAMPEL_WIN / 2];
+
+    uint32_t thr = (uint32_t)(((uint64_t)mad * HAMPEL_K_X1000) / 1000U);
+    const uint32_t min_dev = med / HAMPEL_MIN_DEV_DIV;
+    if (thr < min_dev) thr = min_dev;
+
+    const uint32_t dev = (erpm > med) ? (erpm - med) : (med - erpm);
+    accept = (dev <= thr);
+  }
+
+  // raw window keeps rejected samples too, so a genuine step is accepted after ~K/2 sends
+  hampel_win_[hampel_head_] = erpm;
+  hampel_head_ = (uint8_t)((hampel_head_ + 1) % ERPM_HAMPEL_WIN);
+  if (hampel_count_ < ERPM_HAMPEL_WIN) hampel_count_++;
+
+  return accept;
+}
+
+void EscBdshot::rpmAccReset() {
+  acc_n_ = 0;
+  acc_rejected_ = 0;
+  acc_sum_ = 0;
+  acc_min_ = 0xFFFFFFFFUL;
+  acc_max_ = 0;
+}
+
+void EscBdshot::histPush(uint32_t t_us, uint32_t erpm) {
+  ErpmSample& s = hist_[hist_seq_ % ERPM_HIST_LEN];
+  s.t_us = t_us;
+  s.erpm = erpm;
+  hist_seq_++;
+
+  if (acc_n_ < 0xFFFF) {
+    acc_n_++;
+    acc_sum_ += erpm;
+    if (erpm < acc_min_) acc_min_ = erpm;
+    if (erpm > acc_max_) acc_max_ = erpm;
+  }
+}
+
+bool EscBdshot::erpmHistAt(uint32_t seq, ErpmSample& out) const {
+  IrqGuard g;
+
+  // only the last ERPM_HIST_LEN samples are retained
+  if ((uint32_t)(hist_seq_ - seq) == 0 || (uint32_t)(hist_seq_ - seq) > ERPM_HIST_LEN) return false;
+  out = hist_[seq % ERPM_HIST_LEN];
+  return true;
+}
+
+void EscBdshot::acceptErpm(uint32_t t_us, uint32_t erpm) {
+  if (hampelAccept(erpm)) {
+    histPush(t_us, erpm);
+    rpmFilterPush(erpm);
+    if (erpm > 0) last_erpm_cached_ = erpm;
+  } else {
+    rpm_outliers_++;
+    if (acc_rejected_ < 0xFFFF) acc_rejected_++;
+  }
+}
+
+EscRpmStats EscBdshot::takeRpmStats() {
+  IrqGuard g;
+
+  EscRpmStats st;
+  st.rejected = acc_rejected_;
+  if (acc_n_ > 0 && pole_pairs_ > 0) {
+    st.n = acc_n_;
+    st.rpm_mean = (float)((double)acc_sum_ / (double)acc_n_) / (float)pole_pairs_;
+    st.rpm_min = acc_min_ / (uint32_t)pole_pairs_;
+    st.rpm_max = acc_max_ / (uint32_t)pole_pairs_;
+  }
+  rpmAccReset();
+  return st;
 }
 
 void EscBdshot::stopNow() {
+  IrqGuard g;
+
   // Bring throttle to zero immediately
+  rpm_mode_ = false;
   target_throttle_pct_ = 0.0f;
   current_throttle_pct_ = 0.0f;
-  ramp_rate_pct_per_s_ = 9999.0f;
+  ramp_.reset(0);
 
   // Reset telemetry/failsafe state for next START
   clearFailsafe();
 
-  // One immediate send (loop will continue sending at fixed period)
-  applyThrottleInternal(0.0f);
+  // One immediate send (loop will continue sending at fixed period).
+  // Timer-driven: the alarm owns the PIO, zero goes out on the next tick (<= 1 period).
+  if (!timer_driven_) applyThrottleInternal(0.0f);
 }
 
-void EscBdshot::setTargetThrottlePct(float pct, float ramp_s) {
+void EscBdshot::setTargetThrottlePct(float pct, float ramp_s, RampProfile prof) {
+  IrqGuard g;
+  if (failsafe_soft_) return;   // the trip ramp owns the output
+
+  // leaving RPM mode: ramp continues from the controller's last output
+  if (rpm_mode_) {
+    rpm_mode_ = false;
+    ramp_.reset(rpm_out_cpct_);
+  }
+
   pct = clampf(pct, 0.0f, 100.0f);
   target_throttle_pct_ = pct;
 
-  if (ramp_s <= 0.0f) ramp_rate_pct_per_s_ = 9999.0f;
-  else ramp_rate_pct_per_s_ = 100.0f / ramp_s;
+  // AutoTest re-applies its step target every loop pass: keep the running segment
+  const int32_t tgt = (int32_t)lrintf(pct * 100.0f);
+  if (tgt == ramp_.target() && prof == ramp_.profile()) return;
+
+  // ramp_s keeps its meaning: time for a full 0..100 % swing
+  const int32_t cur = ramp_.value();
+  const uint32_t delta = (uint32_t)(tgt > cur ? tgt - cur : cur - tgt);
+  const uint32_t dur_us = (ramp_s <= 0.0f) ? 0u : (uint32_t)(ramp_s * 100.0f * (float)delta);
+  ramp_.start(tgt, dur_us, prof, (uint32_t)us_now());
+}
+
+void EscBdshot::trip(const char* reason) {
+  IrqGuard g;
+  if (failsafe_ && !failsafe_soft_) return;
+  failsafe_ = true;
+  failsafe_soft_ = false;
+  failsafe_reason_ = reason;
+}
+
+void EscBdshot::tripSoft(const char* reason, float ramp_s) {
+  IrqGuard g;
+  if (failsafe_) return;
+
+  failsafe_ = true;
+  failsafe_soft_ = true;
+  failsafe_reason_ = reason;
+
+  // same bumpless hand-over as leaving RPM mode, then a plain linear ramp to zero
+  if (rpm_mode_) {
+    rpm_mode_ = false;
+    ramp_.reset(rpm_out_cpct_);
+  }
+  target_throttle_pct_ = 0.0f;
+  const int32_t cur = ramp_.value();
+  const uint32_t dur_us = (ramp_s <= 0.0f || cur <= 0) ? 0u : (uint32_t)(ramp_s * 100.0f * (float)cur);
+  ramp_.start(0, dur_us, RAMP_LINEAR, (uint32_t)us_now());
+}
+
+void EscBdshot::setTargetRpm(uint32_t rpm, float ramp_s) {
+  IrqGuard g;
+  if (failsafe_soft_) return;
+
+  if (rpm == 0) { setTargetThrottlePct(0.0f, ramp_s, RAMP_LINEAR); return; }
+  if (rpm_mode_ && rpm == rpm_target_) return; // AutoTest re-applies every tick
+
+  if (!rpm_mode_) {
+    // bumpless transfer: integrator holds the current output, setpoint starts at measured RPM
+    rpm_mode_ = true;
+    rpm_out_cpct_ = (int32_t)lrintf(current_throttle_pct_ * 100.0f);
+    rpm_integ_q24_ = (int64_t)rpm_out_cpct_ << 24;
+    rpm_sp_q4_ = rpm_filt_init_ ? rpm_filt_q4_ : 0;
+    rpm_filt_prev_q4_ = rpm_filt_q4_;
+  }
+
+  if (rpm > 100000UL) rpm = 100000UL;
+  rpm_target_ = rpm;
+
+  const int32_t tgt_q4 = (int32_t)(rpm << 4);
+  const int32_t delta = (tgt_q4 > rpm_sp_q4_) ? (tgt_q4 - rpm_sp_q4_) : (rpm_sp_q4_ - tgt_q4);
+  const float sends = ramp_s * 1000000.0f / (float)ESC_SEND_PERIOD_US;
+  if (ramp_s <= 0.0f || sends < 1.0f) {
+    rpm_sp_step_q4_ = 0;
+  } else {
+    const int32_t step = (int32_t)((float)delta / sends);
+    rpm_sp_step_q4_ = (step < 1) ? 1 : step;
+  }
+}
+
+void EscBdshot::setRpmGains(float kp, float ki, float kd) {
+  IrqGuard g;
+
+  kp_ = (isfinite(kp) && kp >= 0.0f) ? kp : 0.0f;
+  ki_ = (isfinite(ki) && ki >= 0.0f) ? ki : 0.0f;
+  kd_ = (isfinite(kd) && kd >= 0.0f) ? kd : 0.0f;
+
+  // %/RPM -> 0.01 %/RPM in Q24, folded with the fixed send period
+  const double dt_s = (double)ESC_SEND_PERIOD_US * 1e-6;
+  const double q24 = 16777216.0;
+  kp_q24_ = (int64_t)((double)kp_ * 100.0 * q24);
+  ki_q24_ = (int64_t)((double)ki_ * 100.0 * dt_s * q24);
+  kd_q24_ = (int64_t)((double)kd_ * 100.0 / dt_s * q24);
+}
+
+void EscBdshot::rpmFilterPush(uint32_t erpm) {
+  const int32_t x_q4 = (int32_t)((erpm << 4) / (uint32_t)pole_pairs_);
+  if (!rpm_filt_init_) {
+    rpm_filt_q4_ = x_q4;
+    rpm_filt_prev_q4_ = x_q4;
+    rpm_filt_init_ = true;
+    return;
+  }
+  rpm_filt_q4_ += (x_q4 - rpm_filt_q4_) >> RPM_CTRL_FILT_SHIFT;
+}
+
+void EscBdshot::rpmCtrlStep() {
+  // 1) setpoint rate limit
+  const int32_t tgt_q4 = (int32_t)(rpm_target_ << 4);
+  if (rpm_sp_step_q4_ == 0) {
+    rpm_sp_q4_ = tgt_q4;
+  } else if (rpm_sp_q4_ < tgt_q4) {
+    rpm_sp_q4_ = (tgt_q4 - rpm_sp_q4_ <= rpm_sp_step_q4_) ? tgt_q4 : rpm_sp_q4_ + rpm_sp_step_q4_;
+  } else if (rpm_sp_q4_ > tgt_q4) {
+    rpm_sp_q4_ = (rpm_sp_q4_ - tgt_q4 <= rpm_sp_step_q4_) ? tgt_q4 : rpm_sp_q4_ - rpm_sp_step_q4_;
+  }
+
+  // 2) PI + D on measurement (no derivative kick on setpoint steps)
+  const int32_t err_q4 = rpm_sp_q4_ - rpm_filt_q4_;
+  const int64_t p = (kp_q24_ * err_q4) >> 4;
+  const int64_t d = -((kd_q24_ * (int64_t)(rpm_filt_q4_ - rpm_filt_prev_q4_)) >> 4);
+  rpm_filt_prev_q4_ = rpm_filt_q4_;
+
+  int64_t i_next = rpm_integ_q24_ + ((ki_q24_ * err_q4) >> 4);
+  if (i_next < 0) i_next = 0;
+  if (i_next > RPM_OUT_MAX_Q24) i_next = RPM_OUT_MAX_Q24;
+
+  // anti-windup: conditional integration, don't push further into saturation
+  const int64_t u_try = p + i_next + d;
+  const bool sat_hi = (u_try > RPM_OUT_MAX_Q24) && (err_q4 > 0);
+  const bool sat_lo = (u_try < 0) && (err_q4 < 0);
+  if (!sat_hi && !sat_lo) rpm_integ_q24_ = i_next;
+
+  int64_t u = p + rpm_integ_q24_ + d;
+  if (u < 0) u = 0;
+  if (u > RPM_OUT_MAX_Q24) u = RPM_OUT_MAX_Q24;
+
+  // 3) output rate limit
+  int32_t du = (int32_t)(u >> 24) - rpm_out_cpct_;
+  if (du > RPM_SLEW_CPCT_PER_SEND) du = RPM_SLEW_CPCT_PER_SEND;
+  if (du < -RPM_SLEW_CPCT_PER_SEND) du = -RPM_SLEW_CPCT_PER_SEND;
+  rpm_out_cpct_ += du;
+
+  current_throttle_pct_ = (float)rpm_out_cpct_ * 0.01f;
+  target_throttle_pct_ = current_throttle_pct_;
 }
 
 uint16_t EscBdshot::pctToDshot(float pct) const {
-  pct = clampf(pct, 0.0f, 100.0f);
-  const float v = (pct / 100.0f) * (float)DSHOT_MAX;
-  uint16_t out = (uint16_t)(v + 0.5f);
+  // 0 is always "motor stop"; anything above starts at the calibrated spin-up value
+  const int32_t cpct = (int32_t)lrintf(clampf(pct, 0.0f, 100.0f) * 100.0f);
+  if (cpct <= 0) return 0;
+  if (cpct >= 10000) return dshot_lut_[100];
+
+  const int32_t i = cpct / 100;
+  const int32_t f = cpct % 100;
+  const int32_t a = dshot_lut_[i];
+  const int32_t b = dshot_lut_[i + 1];
+  uint16_t out = (uint16_t)(a + ((b - a) * f + 50) / 100);
   if (out > DSHOT_MAX) out = DSHOT_MAX;
   return out;
 }
 
+void EscBdshot::buildDshotLut() {
+  const uint32_t start = (thr_cal_.valid && thr_cal_.start_dshot < DSHOT_MAX) ? thr_cal_.start_dshot : 0;
+  for (uint32_t i = 0; i <= 100; i++) {
+    dshot_lut_[i] = (uint16_t)(start + ((DSHOT_MAX - start) * i + 50) / 100);
+  }
+}
+
+void EscBdshot::setThrottleCal(const ThrCalData& tc) {
+  IrqGuard g;
+  thr_cal_ = tc;
+  buildDshotLut();
+}
+
+void EscBdshot::requestEdt() {
+  IrqGuard g;
+  edt_cmd_left_ = DSHOT_CMD_REPEAT;
+}
+
 void EscBdshot::applyThrottleInternal(float pct) {
-  if (!esc_) return;
-  auto* e = (BidirDShotX1*)esc_;
-  e->sendThrottle(pctToDshot(pct));
+  if (dshot_ < 0) return;
+  hal::dshotSend(dshot_, pctToDshot(pct));
 }
 
 void EscBdshot::tickFast() {
-  if (!esc_) return;
+  if (dshot_ < 0 || timer_driven_) return;
+
+  // polled fallback: run the fixed tick whenever the send grid is due
+  const uint64_t now_us = us_now();
+  if (now_us >= next_send_us_) {
+    // stay on the grid (keeps the stagger between ESCs); resync if we fell a whole period behind
+    next_send_us_ += ESC_SEND_PERIOD_US;
+    if (next_send_us_ <= now_us) next_send_us_ = now_us + ESC_SEND_PERIOD_US;
+    tickSend(now_us);
+  }
+}
+
+void EscBdshot::tickSend(uint64_t now_us) {
+  if (dshot_ < 0) return;
 
   const uint32_t now_ms = ms_now();
+  jitterPush((uint32_t)now_us);
 
   // If failsafe latched: force throttle to 0 but keep sending at a fixed period
-  if (failsafe_) {
+  // (a soft trip keeps evaluating its ramp to zero below)
+  if (failsafe_ && !failsafe_soft_) {
+    rpm_mode_ = false;
     target_throttle_pct_ = 0.0f;
     current_throttle_pct_ = 0.0f;
-  } else {
-    // 1) ramp current throttle toward target
-    const uint32_t dt_ms = (uint32_t)(now_ms - last_ramp_ms_);
-    last_ramp_ms_ = now_ms;
-
-    const float dt_s = (float)dt_ms * 0.001f;
-    const float max_step = ramp_rate_pct_per_s_ * dt_s;
+    ramp_.reset(0);
+  } else if (!rpm_mode_) {
+    // 1) evaluate the ramp at this tick's µs time
+    //    (in RPM mode the output comes from rpmCtrlStep() below)
+    current_throttle_pct_ = (float)ramp_.tick((uint32_t)now_us) * 0.01f;
+  }
 
-    const float err = target_throttle_pct_ - current_throttle_pct_;
-    if (fabsf(err) <= max_step) current_throttle_pct_ = target_throttle_pct_;
-    else current_throttle_pct_ += (err > 0.0f ? max_step : -max_step);
+  // 2) send throttle (or a queued EDT enable while stopped), and only then pull telemetry
+  if (edt_cmd_left_ && current_throttle_pct_ <= 0.0f) {
+    hal::dshotCommand(dshot_, DSHOT_CMD_EDT_ENABLE);
+    edt_cmd_left_--;
+  } else {
+    applyThrottleInternal(current_throttle_pct_);
   }
 
-  // 2) send throttle at fixed period, and only then pull telemetry (bounded work)
-  const uint64_t now_us = us_now();
-  if ((uint32_t)(now_us - last_send_us_) >= ESC_SEND_PERIOD_US) {
-    last_send_us_ = now_us;
+  // 3) telemetry pull + cache (eRPM, or an EDT frame if the ESC has EDT enabled)
+  uint32_t erpm = 0;
+  const hal::DshotTel tt = hal::dshotTelemetry(dshot_, &erpm);
 
-    applyThrottleInternal(current_throttle_pct_);
+  if (tt == hal::DSHOT_TEL_NONE) {
+    telStatsPush(TEL_NO_RESP);
+  } else if (tt == hal::DSHOT_TEL_CRC) {
+    telStatsPush(TEL_CRC_ERR);
+  } else {
+    // valid frame (eRPM or EDT); eRPM=0 just means "stopped"
+    telStatsPush(TEL_OK);
+  }
 
-    // 3) telemetry pull + cache (only on send)
-    uint32_t erpm = 0;
-    auto* e = (BidirDShotX1*)esc_;
-    e->getTelemetryErpm(&erpm);
+  if (tt == hal::DSHOT_TEL_TEMP) {
+    edt_temp_C_ = (int16_t)erpm;   // EDT temperature is in whole °C
+    edt_temp_ms_ = now_ms;
+    edt_temp_seen_ = true;
+  }
 
+  if (tt == hal::DSHOT_TEL_ERPM) {
+    // ESC alive: feeds the RPM_TIMEOUT failsafe regardless of outlier filtering
     if (erpm > 0) {
-      last_erpm_cached_ = erpm;
       telemetry_seen_ = true;
       last_rpm_update_ms_ = now_ms;
     }
+
+    acceptErpm((uint32_t)now_us, erpm);
   }
 
-  // 4) failsafe only if telemetry was seen in THIS run and throttle is real
+  // 4) closed-loop RPM: new output goes out with the next send
+  if (rpm_mode_ && !failsafe_) rpmCtrlStep();
+
+  // 5) failsafe only if telemetry was seen in THIS run and throttle is real
   const uint32_t age_ms = (uint32_t)(now_ms - last_rpm_update_ms_);
   if (!failsafe_ && telemetry_seen_ && age_ms > TELEMETRY_TIMEOUT_MS && current_throttle_pct_ > 3.0f) {
     failsafe_ = true;
     failsafe_reason_ = "RPM_TIMEOUT";
   }
+
+  // RPM mode without any eRPM would wind up to full throttle
+  if (!failsafe_ && rpm_mode_ && !telemetry_seen_ && current_throttle_pct_ > RPM_CTRL_NO_TEL_MAX_PCT) {
+    failsafe_ = true;
+    failsafe_reason_ = "RPM_NO_TELEMETRY";
+  }
+}
+
+void EscBdshot::jitterPush(uint32_t now_us) {
+  if (jit_have_last_) {
+    const uint32_t dt = (uint32_t)(now_us - jit_last_us_);
+    if (jit_.n < 0xFFFFFFFFUL) jit_.n++;
+    if (dt < jit_.period_min_us) jit_.period_min_us = dt;
+    if (dt > jit_.period_max_us) jit_.period_max_us = dt;
+    if (dt > ESC_SEND_PERIOD_US + ESC_SEND_LATE_US) jit_.late++;
+
+    const int32_t dev = (int32_t)dt - (int32_t)ESC_SEND_PERIOD_US;
+    jit_sum_dev_ += dev;
+    jit_sum_dev2_ += (int64_t)dev * dev;
+  }
+  jit_last_us_ = now_us;
+  jit_have_last_ = true;
+}
+
+EscJitterStats EscBdshot::sendJitter(bool reset) {
+  IrqGuard g;
+
+  EscJitterStats st = jit_;
+  if (st.n > 0) {
+    const double mean_dev = (double)jit_sum_dev_ / (double)st.n;
+    const double var = (double)jit_sum_dev2_ / (double)st.n - mean_dev * mean_dev;
+    st.mean_us = (float)((double)ESC_SEND_PERIOD_US + mean_dev);
+    st.std_us = (float)sqrt(var > 0.0 ? var : 0.0);
+  } else {
+    st.period_min_us = 0;
+  }
+  if (reset) {
+    jit_ = EscJitterStats{};
+    jit_sum_dev_ = 0;
+    jit_sum_dev2_ = 0;
+    jit_have_last_ = false;
+  }
+  return st;
 }
 
 EscTelemetry EscBdshot::getTelemetry() {
+  IrqGuard g;
+
   EscTelemetry t;
 
+  t.win_sends   = tel_win_count_;
+  t.win_ok      = tel_win_cnt_[TEL_OK];
+  t.win_crc_err = tel_win_cnt_[TEL_CRC_ERR];
+  t.win_no_resp = tel_win_cnt_[TEL_NO_RESP];
+  t.tot_ok      = tel_tot_cnt_[TEL_OK];
+  t.tot_crc_err = tel_tot_cnt_[TEL_CRC_ERR];
+  t.tot_no_resp = tel_tot_cnt_[TEL_NO_RESP];
+
   const uint32_t now = ms_now();
   const uint32_t age_ms = (uint32_t)(now - last_rpm_update_ms_);
   const bool low_throttle = (current_throttle_pct_ < 1.0f && target_throttle_pct_ < 1.0f);
 
+  if (edt_temp_seen_ && (uint32_t)(now - edt_temp_ms_) <= EDT_TEMP_STALE_MS) t.temp_C = (float)edt_temp_C_;
+
+  // True error rate over the window. Unknown (NaN) if nothing was sent yet, or if the
+  // ESC is completely silent while stopped / before first RPM (no bidir, ESC unpowered).
+  const bool silent = (t.win_ok == 0 && (low_throttle || !telemetry_seen_));
+  const float err_pct = (t.win_sends == 0 || silent)
+                          ? NAN
+                          : 100.0f * (float)(t.win_crc_err + t.win_no_resp) / (float)t.win_sends;
+
   // If we're essentially stopped and telemetry is stale, don't show old cached RPM.
   if (low_throttle && age_ms > STOPPED_STALE_RPM_MS) {
     t.erpm = 0;
     t.rpm_valid = false;
     t.rpm = 0;
-
-    // When stopped / not expecting telemetry, don't scare with 100%.
-    t.bdshot_err_pct = NAN;
+    t.bdshot_err_pct = err_pct;
     return t;
   }
 
@@ -164,12 +580,6 @@ EscTelemetry EscBdshot::getTelemetry() {
     t.rpm = 0;
   }
 
-  // If telemetry was never seen yet, report NaN (unknown) instead of 100%.
-  if (!telemetry_seen_) {
-    t.bdshot_err_pct = NAN;
-  } else {
-    t.bdshot_err_pct = (age_ms > TELEMETRY_TIMEOUT_MS) ? 100.0f : 0.0f;
-  }
-
+  t.bdshot_err_pct = err_pct;
   return t;
 }
@@ -1,27 +1,104 @@
 #pragma once
 #include <Arduino.h>
+#include "cfg.h"
+#include "ramp.h"
+#include "storage.h"
 
 struct EscTelemetry {
   bool rpm_valid = false;
   uint32_t erpm = 0;
   uint32_t rpm = 0;
   float bdshot_err_pct = NAN;
+  float temp_C = NAN;   // EDT temperature frame, NaN if the ESC sends none (EDT off / stale)
+
+  // decode outcomes over the last BDSHOT_ERR_WINDOW sends
+  uint16_t win_sends = 0;
+  uint16_t win_ok = 0;
+  uint16_t win_crc_err = 0;
+  uint16_t win_no_resp = 0;
+
+  // decode outcomes since last clearFailsafe()
+  uint32_t tot_ok = 0;
+  uint32_t tot_crc_err = 0;
+  uint32_t tot_no_resp = 0;
+};
+
+// One accepted eRPM decode (full send rate).
+struct ErpmSample {
+  uint32_t t_us = 0;
+  uint32_t erpm = 0;
+};
+
+// RPM statistics over accepted samples since the last takeRpmStats() (one log frame).
+struct EscRpmStats {
+  uint16_t n = 0;
+  uint16_t rejected = 0;   // Hampel outliers dropped in this frame
+  float    rpm_mean = NAN;
+  uint32_t rpm_min = 0;
+  uint32_t rpm_max = 0;
+};
+
+// Actual send-period statistics (since last reset).
+struct EscJitterStats {
+  uint32_t n = 0;
+  uint32_t period_min_us = 0xFFFFFFFFUL;
+  uint32_t period_max_us = 0;
+  uint32_t late = 0;        // periods longer than ESC_SEND_PERIOD_US + ESC_SEND_LATE_US
+  float mean_us = NAN;
+  float std_us = NAN;
 };
 
 class EscBdshot {
 public:
-  bool begin(uint8_t pin, uint16_t dshot_speed);
+  // send_phase_us staggers the send grid when several ESCs share the loop
+  bool begin(uint8_t pin, uint16_t dshot_speed, uint32_t send_phase_us = 0);
   void setPolePairs(uint8_t pp) { pole_pairs_ = (pp == 0 ? 1 : pp); }
   uint8_t polePairs() const { return pole_pairs_; }
 
-  void setTargetThrottlePct(float pct, float ramp_s);
+  // ramp_s = time for a full 0..100 % swing (shorter steps take proportionally less)
+  void setTargetThrottlePct(float pct, float ramp_s, RampProfile prof = RAMP_LINEAR);
   void stopNow();
 
-  // must be called fast (main loop)
+  // Closed-loop RPM mode: setpoint ramps to rpm over ramp_s, PI(D) runs at send rate.
+  // Any setTargetThrottlePct()/stopNow()/failsafe leaves RPM mode. rpm == 0 -> throttle 0.
+  void setTargetRpm(uint32_t rpm, float ramp_s);
+  void setRpmGains(float kp, float ki, float kd);
+  bool rpmMode() const { return rpm_mode_; }
+  uint32_t rpmTarget() const { return rpm_target_; }
+  uint32_t rpmSetpoint() const { return (uint32_t)(rpm_sp_q4_ >> 4); }
+  float rpmFiltered() const { return (float)rpm_filt_q4_ / 16.0f; }
+  float rpmKp() const { return kp_; }
+  float rpmKi() const { return ki_; }
+  float rpmKd() const { return kd_; }
+
+  // Switch the ESC's extended telemetry (EDT temperature frames) on: DShot command 13, sent
+  // DSHOT_CMD_REPEAT times in place of throttle frames once the output is 0 (ESCs ignore
+  // commands while spinning). The ESC keeps EDT on until it loses power.
+  void requestEdt();
+
+  // Polled mode: must be called fast (main loop), runs tickSend() on the send grid.
+  // Timer-driven mode (setTimerDriven(true)): no-op, the send alarm calls tickSend().
   void tickFast();
+  // One fixed tick: ramp, send, telemetry pull, RPM loop, failsafe. IRQ-safe.
+  void tickSend(uint64_t now_us);
+  void setTimerDriven(bool en) { timer_driven_ = en; }
+  bool timerDriven() const { return timer_driven_; }
+  EscJitterStats sendJitter(bool reset = false);
 
   // called at log rate
   EscTelemetry getTelemetry();
+  EscRpmStats takeRpmStats();   // consumes the per-frame accumulator
+
+  // eRPM history: seq is a running index of accepted samples (never reset).
+  uint32_t erpmHistSeq() const { return hist_seq_; }
+  bool erpmHistAt(uint32_t seq, ErpmSample& out) const;
+  uint32_t erpmOutliers() const { return rpm_outliers_; }
+  // One eRPM decode through the outlier filter into history / RPM filter / frame stats.
+  // Called by tickSend(); the host replay feeds recorded RPMSTREAM samples here.
+  void acceptErpm(uint32_t t_us, uint32_t erpm);
+
+  // throttle ramp finished (throttle mode) / RPM setpoint reached its target (RPM mode)
+  bool rampDone() const { return rpm_mode_ ? (rpm_sp_q4_ == (int32_t)(rpm_target_ << 4)) : ramp_.done(); }
 
   float currentThrottlePct() const { return current_throttle_pct_; }
   float targetThrottlePct() const { return target_throttle_pct_; }
@@ -30,33 +107,119 @@ public:
   const char* failsafeReason() const { return failsafe_reason_; }
 
   void clearFailsafe();
+  // Latch a failsafe and cut: zero goes out with the next send (<= 1 period). IRQ-safe,
+  // overrides a soft trip's ramp.
+  void trip(const char* reason);
+  // Latch a failsafe but ramp the output to zero over ramp_s (full swing) instead of cutting.
+  // For the loop-stall monitor in the send alarm; an already latched failsafe wins.
+  void tripSoft(const char* reason, float ramp_s);
+
+  // Throttle calibration: % -> DShot LUT (O(1)); the RPM per 5 % is only shown (THRCAL SHOW).
+  // Invalid/cleared data = plain linear 0..DSHOT_MAX mapping.
+  void setThrottleCal(const ThrCalData& tc);
+  const ThrCalData& throttleCal() const { return thr_cal_; }
 
 private:
   void applyThrottleInternal(float pct);
   uint16_t pctToDshot(float pct) const;
+  void buildDshotLut();
+
+  // per-send telemetry outcome accounting
+  enum TelOutcome : uint8_t { TEL_OK = 0, TEL_CRC_ERR = 1, TEL_NO_RESP = 2 };
+  void telStatsReset();
+  void telStatsPush(TelOutcome o);
+
+  // eRPM outlier rejection + history
+  bool hampelAccept(uint32_t erpm);
+  void rpmAccReset();
+  void histPush(uint32_t t_us, uint32_t erpm);
+
+  // closed-loop RPM
+  void rpmFilterPush(uint32_t erpm);
+  void rpmCtrlStep();
 
 private:
   uint8_t pin_ = 255;
   uint16_t speed_ = 0;
 
-  void* esc_ = nullptr;
+  int dshot_ = -1;   // hal:: DShot handle
 
   uint8_t pole_pairs_ = 7;
 
   float current_throttle_pct_ = 0.0f;
   float target_throttle_pct_ = 0.0f;
 
-  float ramp_rate_pct_per_s_ = 9999.0f;
-  uint32_t last_ramp_ms_ = 0;
+  RampGen ramp_;   // evaluated at send rate (tickSend)
 
-  uint64_t last_send_us_ = 0;
+  // throttle calibration (1 % grid LUT, interpolated in 0.01 % steps)
+  ThrCalData thr_cal_;
+  uint16_t dshot_lut_[101]{};
+
+  uint64_t next_send_us_ = 0;   // fixed send grid (ESC_SEND_PERIOD_US), polled mode
+  volatile bool timer_driven_ = false;
+
+  // send-period jitter
+  void jitterPush(uint32_t now_us);
+  EscJitterStats jit_;
+  uint32_t jit_last_us_ = 0;
+  bool jit_have_last_ = false;
+  int64_t jit_sum_dev_ = 0;
+  int64_t jit_sum_dev2_ = 0;
 
   // telemetry cache
   uint32_t last_rpm_update_ms_ = 0;
   uint32_t last_erpm_cached_ = 0;
   bool telemetry_seen_ = false;
 
+  // extended DShot telemetry (EDT): enable frames still to send, last temperature frame
+  volatile uint8_t edt_cmd_left_ = 0;
+  int16_t edt_temp_C_ = 0;
+  uint32_t edt_temp_ms_ = 0;
+  bool edt_temp_seen_ = false;
+
+  // sliding window of decode outcomes (ring) + running counts
+  uint8_t tel_win_[BDSHOT_ERR_WINDOW]{};
+  uint16_t tel_win_head_ = 0;
+  uint16_t tel_win_count_ = 0;
+  uint16_t tel_win_cnt_[3]{};
+  uint32_t tel_tot_cnt_[3]{};
+
+  // Hampel window of previous raw eRPM decodes (ring)
+  uint32_t hampel_win_[ERPM_HAMPEL_WIN]{};
+  uint8_t hampel_head_ = 0;
+  uint8_t hampel_count_ = 0;
+  uint32_t rpm_outliers_ = 0;
+
+  // accepted eRPM history (ring)
+  ErpmSample hist_[ERPM_HIST_LEN];
+  uint32_t hist_seq_ = 0;
+
+  // per-frame accumulator (accepted eRPM)
+  uint16_t acc_n_ = 0;
+  uint16_t acc_rejected_ = 0;
+  uint64_t acc_sum_ = 0;
+  uint32_t acc_min_ = 0;
+  uint32_t acc_max_ = 0;
+
+  // closed-loop RPM (fixed point: RPM in Q4, throttle in 0.01 % units, gains Q24 per send)
+  bool rpm_mode_ = false;
+  uint32_t rpm_target_ = 0;
+  int32_t rpm_sp_q4_ = 0;
+  int32_t rpm_sp_step_q4_ = 0;     // setpoint slew per send, 0 = jump
+  int32_t rpm_filt_q4_ = 0;
+  int32_t rpm_filt_prev_q4_ = 0;
+  bool rpm_filt_init_ = false;
+  int64_t rpm_integ_q24_ = 0;
+  int32_t rpm_out_cpct_ = 0;
+  float kp_ = RPM_CTRL_KP_DEFAULT;
+  float ki_ = RPM_CTRL_KI_DEFAULT;
+  float kd_ = RPM_CTRL_KD_DEFAULT;
+  int64_t kp_q24_ = 0;
+  int64_t ki_q24_ = 0;
+  int64_t kd_q24_ = 0;
+
   // failsafe
   bool failsafe_ = false;
+  bool failsafe_soft_ = false;   // tripSoft(): ramp down, targets locked until clearFailsafe()
   const char* failsafe_reason_ = "OK";
 };
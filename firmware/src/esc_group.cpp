@@ -0,0 +1,194 @@
+#include "esc_group.h"
+#include "hal.h"
+
+static_assert(CalStorage::THRCAL_SLOTS >= ESC_COUNT_MAX, "one THRCAL slot per ESC");
+
+bool EscGroup::begin(const uint8_t* pins, uint8_t count, uint16_t dshot_speed) {
+  speed_ = dshot_speed;
+  storage_.begin();
+  for (uint8_t i = 0; i < ESC_COUNT_MAX; i++) {
+    pins_[i] = pins[i];
+    begun_[i] = false;
+  }
+  count_ = 0;
+  return setCount(count);
+}
+
+bool EscGroup::beginMotor_(uint8_t i) {
+  if (begun_[i]) return true;
+
+  // spread sends evenly over one period so adding ESCs never piles work into one loop pass
+  const uint32_t phase_us = (uint32_t)i * (ESC_SEND_PERIOD_US / ESC_COUNT_MAX);
+  if (!esc_[i].begin(pins_[i], speed_, phase_us)) return false;
+
+  esc_[i].setPolePairs(pole_pairs_);
+  loadThrottleCal(i);
+  begun_[i] = true;
+  return true;
+}
+
+bool EscGroup::setCount(uint8_t n) {
+  if (n < 1 || n > ESC_COUNT_MAX) return false;
+
+  for (uint8_t i = 0; i < n; i++) {
+    if (!beginMotor_(i)) return false;
+    // a motor dropped earlier went back to polled sends: hand it to the alarm again before
+    // count_ lets the alarm reach it, or it gets sent from both
+    esc_[i].setTimerDriven(timer_on_);
+  }
+
+  const uint8_t old = count_;
+  count_ = n;
+
+  // motors dropped from the group get one zero frame; the ESC then disarms on signal loss
+  for (uint8_t i = n; i < old; i++) {
+    esc_[i].setTimerDriven(false);
+    esc_[i].stopNow();
+  }
+  return true;
+}
+
+bool EscGroup::startSendTimer() {
+  if (timer_on_) return true;
+
+  for (uint8_t i = 0; i < ESC_COUNT_MAX; i++) esc_[i].setTimerDriven(true);
+
+  // fixed rate between callback starts (no drift from callback duration)
+  alarm_ = hal::alarmStart(ESC_SEND_PERIOD_US, onSendAlarm_, this);
+  if (alarm_ < 0) {
+    for (uint8_t i = 0; i < ESC_COUNT_MAX; i++) esc_[i].setTimerDriven(false);
+    return false;
+  }
+  timer_on_ = true;
+  return true;
+}
+
+void EscGroup::stopSendTimer() {
+  if (!timer_on_) return;
+  hal::alarmStop(alarm_);
+  alarm_ = -1;
+  timer_on_ = false;
+  for (uint8_t i = 0; i < ESC_COUNT_MAX; i++) esc_[i].setTimerDriven(false);
+}
+
+void EscGroup::tickFast() {
+  // no-op per ESC while the send alarm runs
+  for (uint8_t i = 0; i < count_; i++) esc_[i].tickFast();
+}
+
+bool EscGroup::onSendAlarm_(void* arg) {
+  EscGroup* g = (EscGroup*)arg;
+  const uint64_t now_us = (uint64_t)micros();
+
+  // PIO does the bit timing, so all ESCs go out in the same tick at the full per-motor rate
+  const uint8_t n = g->count_;
+  for (uint8_t i = 0; i < n; i++) g->esc_[i].tickSend(now_us);
+
+  // loop() stuck (I2C, Serial, ...): nobody else can stop the motors, so ramp them down here
+  if (g->beat_on_ && !g->stalled_ && (uint32_t)(millis() - g->beat_ms_) > LOOP_STALL_MS) {
+    g->stalled_ = true;
+    bool spinning = false;
+    for (uint8_t i = 0; i < n; i++) {
+      EscBdshot& e = g->esc_[i];
+      if (e.isFailsafe() || e.currentThrottlePct() <= 0.0f) continue;
+      e.tripSoft("LOOP_STALL", LOOP_STALL_RAMP_S);
+      spinning = true;
+    }
+    if (spinning) g->stalls_ = g->stalls_ + 1;
+  }
+  return true;
+}
+
+void EscGroup::loopBeat() {
+  beat_ms_ = millis();
+  stalled_ = false;
+  beat_on_ = true;
+}
+
+bool EscGroup::saveThrottleCal(uint8_t i) {
+  if (i >= ESC_COUNT_MAX) return false;
+  return storage_.saveThrCal(i, esc_[i].throttleCal());
+}
+
+bool EscGroup::loadThrottleCal(uint8_t i) {
+  if (i >= ESC_COUNT_MAX) return false;
+  ThrCalData tc;
+  if (!storage_.loadThrCal(i, tc)) return false;
+  esc_[i].setThrottleCal(tc);
+  return true;
+}
+
+void EscGroup::setTargetThrottlePct(float pct, float ramp_s, RampProfile prof) {
+  for (uint8_t i = 0; i < count_; i++) esc_[i].setTargetThrottlePct(pct, ramp_s, prof);
+}
+
+void EscGroup::setTargetRpm(uint32_t rpm, float ramp_s) {
+  for (uint8_t i = 0; i < count_; i++) esc_[i].setTargetRpm(rpm, ramp_s);
+}
+
+void EscGroup::setRpmGains(float kp, float ki, float kd) {
+  for (uint8_t i = 0; i < ESC_COUNT_MAX; i++) esc_[i].setRpmGains(kp, ki, kd);
+}
+
+void EscGroup::setPolePairs(uint8_t pp) {
+  pole_pairs_ = pp;
+  for (uint8_t i = 0; i < ESC_COUNT_MAX; i++) esc_[i].setPolePairs(pp);
+}
+
+void EscGroup::stopNow() {
+  for (uint8_t i = 0; i < count_; i++) esc_[i].stopNow();
+}
+
+void EscGroup::clearFailsafe() {
+  for (uint8_t i = 0; i < count_; i++) esc_[i].clearFailsafe();
+}
+
+void EscGroup::trip(const char* reason, float ramp_s) {
+  for (uint8_t i = 0; i < count_; i++) {
+    if (ramp_s <= 0.0f) esc_[i].trip(reason);
+    else esc_[i].tripSoft(reason, ramp_s);
+  }
+}
+
+float EscGroup::currentThrottlePct() const {
+  float mx = 0.0f;
+  for (uint8_t i = 0; i < count_; i++) {
+    const float t = esc_[i].currentThrottlePct();
+    if (t > mx) mx = t;
+  }
+  return mx;
+}
+
+bool EscGroup::rampDone() const {
+  for (uint8_t i = 0; i < count_; i++) {
+    if (!esc_[i].rampDone()) return false;
+  }
+  return true;
+}
+
+void EscGroup::requestEdt() {
+  for (uint8_t i = 0; i < count_; i++) esc_[i].requestEdt();
+}
+
+float EscGroup::maxTempC() {
+  float t_max = NAN;
+  for (uint8_t i = 0; i < count_; i++) {
+    const float t = esc_[i].getTelemetry().temp_C;
+    if (isfinite(t) && (!isfinite(t_max) || t > t_max)) t_max = t;
+  }
+  return t_max;
+}
+
+bool EscGroup::isFailsafe() const {
+  for (uint8_t i = 0; i < count_; i++) {
+    if (esc_[i].isFailsafe()) return true;
+  }
+  return false;
+}
+
+const char* EscGroup::failsafeReason() const {
+  for (uint8_t i = 0; i < count_; i++) {
+    if (esc_[i].isFailsafe()) return esc_[i].failsafeReason();
+  }
+  return "OK";
+}
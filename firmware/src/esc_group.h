@@ -0,0 +1,80 @@
+#pragma once
+#include <Arduino.h>
+#include <assert.h>
+#include "cfg.h"
+#include "esc_bdshot.h"
+
+// 1..ESC_COUNT_MAX ESCs driven together (coaxial pairs, multi-motor rigs).
+// Control calls are broadcast to all active motors; per-motor access via motor(i).
+// Motor 0 (primary) feeds the legacy single-motor CSV/STATUS fields.
+class EscGroup {
+public:
+  bool begin(const uint8_t* pins, uint8_t count, uint16_t dshot_speed);
+
+  // change number of active ESCs (extra ESCs are started on first use)
+  bool setCount(uint8_t n);
+  uint8_t count() const { return count_; }
+
+  // i < count(): callers check the index and answer with an error, a bad index is a bug
+  EscBdshot& motor(uint8_t i) { assert(i < count_); return esc_[i]; }
+  const EscBdshot& motor(uint8_t i) const { assert(i < count_); return esc_[i]; }
+  EscBdshot& primary() { return esc_[0]; }
+  const EscBdshot& primary() const { return esc_[0]; }
+
+  // Hardware-alarm scheduling: one repeating alarm runs every ESC's tickSend() at
+  // ESC_SEND_PERIOD_US, independent of loop() timing. Returns false (stays polled)
+  // if no alarm is available.
+  bool startSendTimer();
+  void stopSendTimer();
+  bool sendTimerOn() const { return timer_on_; }
+
+  // Loop-stall monitor: loop() calls loopBeat() every pass. If no beat arrives for
+  // LOOP_STALL_MS while a motor is spinning, the send alarm latches LOOP_STALL and ramps
+  // every motor down over LOOP_STALL_RAMP_S, even though loop() is still stuck.
+  void loopBeat();
+  uint32_t loopStalls() const { return stalls_; }
+
+  // must be called fast (main loop); polled fallback only, each ESC keeps its own staggered send grid
+  void tickFast();
+
+  // broadcast control
+  void setTargetThrottlePct(float pct, float ramp_s, RampProfile prof = RAMP_LINEAR);
+  void setTargetRpm(uint32_t rpm, float ramp_s);
+  void setRpmGains(float kp, float ki, float kd);
+  void setPolePairs(uint8_t pp);
+  void stopNow();
+  void clearFailsafe();
+  void requestEdt();   // EDT enable on every active motor (sent once each is at 0)
+  // latch failsafe <reason> on every motor: cut (ramp_s <= 0) or ramp down over ramp_s. IRQ-safe.
+  void trip(const char* reason, float ramp_s);
+
+  // per-ESC throttle calibration (THRCAL), slot = motor index; loaded in begin()
+  bool saveThrottleCal(uint8_t i);
+  bool loadThrottleCal(uint8_t i);
+
+  // aggregates
+  float currentThrottlePct() const;   // highest of all active motors
+  bool isFailsafe() const;             // any motor tripped
+  bool rampDone() const;               // all motors at their target
+  float maxTempC();                     // hottest EDT temperature, NaN if no ESC reports one
+  const char* failsafeReason() const;  // first tripped motor's reason
+
+private:
+  bool beginMotor_(uint8_t i);
+  static bool onSendAlarm_(void* arg);
+
+private:
+  EscBdshot esc_[ESC_COUNT_MAX];
+  bool begun_[ESC_COUNT_MAX]{};
+  uint8_t pins_[ESC_COUNT_MAX]{};
+  volatile uint8_t count_ = 0;
+  int alarm_ = -1;   // hal:: alarm handle
+  bool timer_on_ = false;
+  uint16_t speed_ = 0;
+  volatile uint32_t beat_ms_ = 0;
+  volatile bool beat_on_ = false;    // first beat arms the monitor
+  volatile bool stalled_ = false;    // this stall already handled
+  volatile uint32_t stalls_ = 0;
+  uint8_t pole_pairs_ = 7;
+  CalStorage storage_;
+};
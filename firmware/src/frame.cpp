@@ -0,0 +1,7 @@
+#include "frame.h"
+
+void frameDeriveEfficiency(Frame& f) {
+  if (isfinite(f.thrust_g) && isfinite(f.p_in_W) && f.p_in_W > 0.1f) f.eff_g_per_W = f.thrust_g / f.p_in_W;
+  if (isfinite(f.thrust_N) && isfinite(f.p_in_W) && f.p_in_W > 0.1f) f.eff_N_per_W = f.thrust_N / f.p_in_W;
+  if (isfinite(f.thrust_g) && isfinite(f.i_A) && fabsf(f.i_A) > 0.01f) f.eff_g_per_A = f.thrust_g / f.i_A;
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <Arduino.h>
+#include "cfg.h"
 
 // Single 10Hz frame used for status + CSV logging.
 // Keep NaN defaults where measurement may be unavailable.
@@ -17,6 +18,24 @@ struct Frame {
   uint32_t erpm = 0;
   uint32_t rpm = 0;
   float bdshot_err_pct = 100.0f;
+  float esc_temp_C = NAN;   // hottest EDT temperature (not logged)
+
+  // RPM statistics over all accepted full-rate samples in this frame
+  float rpm_mean = NAN;
+  uint32_t rpm_min = 0;
+  uint32_t rpm_max = 0;
+
+  // closed-loop RPM mode (NaN when running open-loop throttle)
+  float rpm_sp = NAN;
+  float rpm_err = NAN;
+
+  // additional ESCs (motor 2..ESC_COUNT_MAX); NaN when not active
+  struct MotorAux {
+    float throttle_pct = NAN;
+    float rpm = NAN;
+    float bdshot_err_pct = NAN;
+  };
+  MotorAux aux[ESC_COUNT_MAX - 1];
 
   // INA226
   float v_bus_V = NAN;
@@ -34,4 +53,9 @@ struct Frame {
 
   // diagnostics
   int32_t hx_noise_pp = -1; // peak-to-peak raw in the last 100ms window, -1 = unknown
+  int32_t hx_raw = 0;       // last HX711 conversion (not logged)
 };
+
+// Efficiency columns from thrust / power / current (NaN where undefined).
+// Shared by the main loop and the host log replay.
+void frameDeriveEfficiency(Frame& f);
@@ -0,0 +1,130 @@
+#include "hal.h"
+
+#if defined(ARDUINO_ARCH_RP2040)
+#include <PIO_DShot.h>   // pico-bidir-dshot
+#include <hardware/sync.h>
+#include <hardware/flash.h>
+#include <hardware/watchdog.h>
+#include <pico/time.h>
+#include "cfg.h"
+
+// reserved region from the linker script (board_build.filesystem_size)
+extern uint8_t _FS_start;
+extern uint8_t _FS_end;
+
+namespace hal {
+
+uint32_t irqSave() { return save_and_disable_interrupts(); }
+void irqRestore(uint32_t saved) { restore_interrupts(saved); }
+
+// ---------------- alarms ----------------
+
+static constexpr uint8_t ALARMS_MAX = 2;
+struct AlarmSlot {
+  repeating_timer_t t;
+  AlarmFn fn;
+  void* arg;
+  bool on;
+};
+static AlarmSlot alarms[ALARMS_MAX];
+
+static bool onAlarm(repeating_timer_t* rt) {
+  AlarmSlot* a = (AlarmSlot*)rt->user_data;
+  return a->fn(a->arg);
+}
+
+int alarmStart(uint32_t period_us, AlarmFn fn, void* arg) {
+  for (uint8_t i = 0; i < ALARMS_MAX; i++) {
+    AlarmSlot& a = alarms[i];
+    if (a.on) continue;
+    a.fn = fn;
+    a.arg = arg;
+    // negative delay = fixed rate between callback starts (no drift from callback duration)
+    if (!add_repeating_timer_us(-(int64_t)period_us, onAlarm, &a, &a.t)) return -1;
+    a.on = true;
+    return i;
+  }
+  return -1;
+}
+
+void alarmStop(int h) {
+  if (h < 0 || h >= ALARMS_MAX || !alarms[h].on) return;
+  cancel_repeating_timer(&alarms[h].t);
+  alarms[h].on = false;
+}
+
+// ---------------- DShot ----------------
+
+static BidirDShotX1* dshot[ESC_COUNT_MAX];
+static uint8_t ndshot = 0;
+
+int dshotOpen(uint8_t pin, uint16_t speed) {
+  if (ndshot >= ESC_COUNT_MAX) return -1;
+  dshot[ndshot] = new BidirDShotX1(pin, speed);
+  return ndshot++;
+}
+
+void dshotSend(int h, uint16_t value) {
+  dshot[h]->sendThrottle(value);
+}
+
+void dshotCommand(int h, uint8_t cmd) {
+  // 11-bit value = command, then the telemetry request bit; the library adds the checksum
+  dshot[h]->sendRaw12Bit((uint16_t)(((uint16_t)cmd << 1) | 1u));
+}
+
+DshotTel dshotTelemetry(int h, uint32_t* value) {
+  switch (dshot[h]->getTelemetryPacket(value)) {
+    case BidirDshotTelemetryType::NO_PACKET:      return DSHOT_TEL_NONE;
+    case BidirDshotTelemetryType::CHECKSUM_ERROR: return DSHOT_TEL_CRC;
+    case BidirDshotTelemetryType::ERPM:           return DSHOT_TEL_ERPM;
+    case BidirDshotTelemetryType::TEMPERATURE:    return DSHOT_TEL_TEMP;
+    default:                                      return DSHOT_TEL_OTHER;
+  }
+}
+
+// ---------------- flash ----------------
+
+static uint32_t flashStart() { return (uint32_t)(uintptr_t)&_FS_start - XIP_BASE; }
+
+uint32_t flashSize() {
+  const uint32_t start = flashStart();
+  const uint32_t end = (uint32_t)(uintptr_t)&_FS_end - XIP_BASE;
+  if (end <= start || (start % FLASH_SECTOR) != 0) return 0;
+  return (end - start) & ~(FLASH_SECTOR - 1);
+}
+
+const uint8_t* flashData() {
+  return (const uint8_t*)(uintptr_t)(XIP_BASE + flashStart());
+}
+
+// Flash writes stop XIP: interrupts off and the other core parked, like EEPROM.commit().
+void flashErase(uint32_t off, uint32_t len) {
+  noInterrupts();
+  rp2040.idleOtherCore();
+  flash_range_erase(flashStart() + off, len);
+  rp2040.resumeOtherCore();
+  interrupts();
+}
+
+void flashProgram(uint32_t off, const uint8_t* data, uint32_t len) {
+  noInterrupts();
+  rp2040.idleOtherCore();
+  flash_range_program(flashStart() + off, data, len);
+  rp2040.resumeOtherCore();
+  interrupts();
+}
+
+// ---------------- watchdog ----------------
+
+void wdtBegin(uint32_t timeout_ms) { rp2040.wdt_begin(timeout_ms); }
+void wdtFeed() { rp2040.wdt_reset(); }
+bool wdtCausedReboot() { return watchdog_caused_reboot(); }
+
+// ---------------- benchmark clock ----------------
+
+uint64_t benchClockNs() { return time_us_64() * 1000ULL; }
+
+}  // namespace hal
+
+#endif  // ARDUINO_ARCH_RP2040
@@ -0,0 +1,306 @@
+#include "kvstore.h"
+#include "crc.h"
+#include "hal.h"
+#include <stddef.h>
+
+KvStore& kvStore() {
+  static KvStore store;
+  return store;
+}
+
+const uint8_t* KvStore::at_(uint32_t addr) const {
+  return hal::flashData() + addr;
+}
+
+bool KvStore::secHdrOk_(uint8_t s, SecHdr& h) const {
+  memcpy(&h, at_((uint32_t)s * hal::FLASH_SECTOR), sizeof(SecHdr));
+  return h.magic == MAGIC && h.schema == SCHEMA && h.crc == crc32Ieee(&h, offsetof(SecHdr, crc));
+}
+
+bool KvStore::secBlank_(uint8_t s) const {
+  const uint32_t* p = (const uint32_t*)at_((uint32_t)s * hal::FLASH_SECTOR);
+  for (uint32_t i = 0; i < hal::FLASH_SECTOR / 4; i++) {
+    if (p[i] != 0xFFFFFFFFUL) return false;
+  }
+  return true;
+}
+
+bool KvStore::recOk_(uint32_t addr, const RecHdr& h) const {
+  const uint32_t crc = crc32Ieee(&h, offsetof(RecHdr, crc));
+  return h.crc == crc32Ieee(at_(addr + sizeof(RecHdr)), h.len, crc);
+}
+
+bool KvStore::begin() {
+  if (nsec_) return true;
+
+  uint32_t n = hal::flashSize() / hal::FLASH_SECTOR;
+  if (n > KV_SECTORS_MAX) n = KV_SECTORS_MAX;
+  if (n < 2) return false;
+  nsec_ = (uint8_t)n;
+
+  // newest generation is the active sector
+  bool any = false;
+  SecHdr h;
+  for (uint8_t s = 0; s < nsec_; s++) {
+    if (!secHdrOk_(s, h)) continue;
+    if (!any || (int32_t)(h.gen - gen_) > 0) { gen_ = h.gen; active_ = s; }
+    any = true;
+  }
+
+  if (!any) {
+    // fresh (or foreign) region: start over
+    for (uint8_t s = 0; s < nsec_; s++) {
+      if (!secBlank_(s)) eraseSector_(s);
+    }
+    gen_ = 0;
+    return startSector_(0);
+  }
+
+  // ring order after the active sector = oldest first, so newer records override
+  for (uint8_t k = 1; k <= nsec_; k++) {
+    const uint8_t s = (uint8_t)((active_ + k) % nsec_);
+    if (secHdrOk_(s, h)) scanSector_(s, s == active_);
+  }
+
+  // the spare must be erased: finish a reclaim cut short by a reset. Only a sector without a
+  // valid header is erased outright; one whose reclaim fails keeps its live records and
+  // advance_() will not reuse it
+  const uint8_t spare = (uint8_t)((active_ + 1) % nsec_);
+  if (spare != active_ && !secBlank_(spare)) {
+    if (!secHdrOk_(spare, h)) {
+      eraseSector_(spare);
+    } else if (!reclaim_(spare)) {
+      Serial.print("ERR STORE reclaim sector="); Serial.println(spare);
+    }
+  }
+  return true;
+}
+
+void KvStore::scanSector_(uint8_t s, bool active) {
+  const uint32_t sec0 = (uint32_t)s * hal::FLASH_SECTOR;
+  uint32_t off = sizeof(SecHdr);
+  RecHdr h;
+  while (off + sizeof(RecHdr) <= hal::FLASH_SECTOR) {
+    memcpy(&h, at_(sec0 + off), sizeof(RecHdr));
+    if (h.key == 0xFFFF) break;
+    // torn header: nothing after it can be trusted
+    if (h.len > VALUE_MAX || off + recSize_(h.len) > hal::FLASH_SECTOR) { off = hal::FLASH_SECTOR; break; }
+    if (recOk_(sec0 + off, h)) setIdx_(h.key, sec0 + off);
+    off += recSize_(h.len);
+  }
+  if (!active) return;
+
+  // appends need erased flash: anything programmed past the end closes the sector
+  for (uint32_t i = off; i < hal::FLASH_SECTOR; i += 4) {
+    if (*(const uint32_t*)at_(sec0 + i) != 0xFFFFFFFFUL) { off = hal::FLASH_SECTOR; break; }
+  }
+  wr_ = (uint16_t)off;
+}
+
+int KvStore::findIdx_(uint16_t key) const {
+  for (uint8_t i = 0; i < nidx_; i++) {
+    if (idx_[i].key == key) return i;
+  }
+  return -1;
+}
+
+bool KvStore::setIdx_(uint16_t key, uint32_t addr) {
+  const int i = findIdx_(key);
+  if (i >= 0) { idx_[i].addr = addr; return true; }
+  if (nidx_ >= KV_KEYS_MAX) return false;
+  idx_[nidx_].key = key;
+  idx_[nidx_].addr = addr;
+  nidx_++;
+  return true;
+}
+
+void KvStore::dropIdx_(int i) {
+  idx_[i] = idx_[--nidx_];
+}
+
+int KvStore::findPend_(uint16_t key) const {
+  for (int i = (int)npend_ - 1; i >= 0; i--) {
+    if (pend_[i].key == key) return i;
+  }
+  return -1;
+}
+
+bool KvStore::get(uint16_t key, void* buf, uint16_t max, uint16_t* len, uint8_t* ver) {
+  const uint8_t* src = nullptr;
+  uint16_t n = 0;
+  uint8_t v = 0;
+
+  const int p = findPend_(key);
+  if (p >= 0) {
+    src = pool_ + pend_[p].off;
+    n = pend_[p].len;
+    v = pend_[p].ver;
+  } else {
+    const int i = findIdx_(key);
+    if (i < 0) return false;
+    RecHdr h;
+    memcpy(&h, at_(idx_[i].addr), sizeof(RecHdr));
+    src = at_(idx_[i].addr + sizeof(RecHdr));
+    n = h.len;
+    v = h.ver;
+  }
+  if (n == 0) return false;   // deleted
+
+  memcpy(buf, src, (n < max) ? n : max);
+  if (len) *len = n;
+  if (ver) *ver = v;
+  return true;
+}
+
+bool KvStore::has(uint16_t key) {
+  uint8_t dummy;
+  return get(key, &dummy, 0);
+}
+
+bool KvStore::put(uint16_t key, uint8_t ver, const void* data, uint16_t len) {
+  if (!nsec_ || key == 0xFFFF || len > VALUE_MAX || (len && !data)) return false;
+
+  // a newer value replaces the queued one (its pool bytes are freed by the next flush)
+  const int p = findPend_(key);
+  if (p >= 0) {
+    for (uint8_t i = (uint8_t)p; i + 1 < npend_; i++) pend_[i] = pend_[i + 1];
+    npend_--;
+  }
+
+  const uint16_t room = (uint16_t)((len + 3u) & ~3u);
+  if (npend_ >= KV_PENDING_MAX || pool_used_ + room > KV_PENDING_BYTES) return false;
+
+  Pend& e = pend_[npend_++];
+  e.key = key;
+  e.len = len;
+  e.off = pool_used_;
+  e.ver = ver;
+  if (len) memcpy(pool_ + pool_used_, data, len);
+  pool_used_ = (uint16_t)(pool_used_ + room);
+  return true;
+}
+
+void KvStore::service(bool motor_idle) {
+  if (!npend_ || !motor_idle) return;
+  flush_();
+}
+
+bool KvStore::flush_() {
+  bool ok = true;
+  for (uint8_t i = 0; i < npend_; i++) {
+    const Pend& e = pend_[i];
+    if (append_(e.key, e.ver, pool_ + e.off, e.len)) continue;
+    Serial.print("ERR STORE write key=0x"); Serial.println(e.key, HEX);
+    ok = false;
+  }
+  npend_ = 0;
+  pool_used_ = 0;
+  return ok;
+}
+
+bool KvStore::append_(uint16_t key, uint8_t ver, const uint8_t* data, uint16_t len) {
+  if (findIdx_(key) < 0 && nidx_ >= KV_KEYS_MAX) return false;
+
+  const uint16_t need = recSize_(len);
+  for (uint8_t tries = 0; wr_ + need > hal::FLASH_SECTOR; tries++) {
+    if (tries >= nsec_ || !advance_()) return false;
+  }
+
+  // header + value in RAM first: data may itself live in flash (reclaim)
+  static uint8_t rec[sizeof(RecHdr) + VALUE_MAX + 3];
+  RecHdr h{};
+  h.key = key;
+  h.len = len;
+  h.ver = ver;
+  h.crc = crc32Ieee(data, len, crc32Ieee(&h, offsetof(RecHdr, crc)));
+  memcpy(rec, &h, sizeof(RecHdr));
+  memcpy(rec + sizeof(RecHdr), data, len);
+  memset(rec + sizeof(RecHdr) + len, 0xFF, need - sizeof(RecHdr) - len);
+
+  const uint32_t addr = (uint32_t)active_ * hal::FLASH_SECTOR + wr_;
+  program_(addr, rec, need);
+  wr_ = (uint16_t)(wr_ + need);
+  return setIdx_(key, addr);
+}
+
+bool KvStore::startSector_(uint8_t s) {
+  if (!secBlank_(s)) eraseSector_(s);
+
+  SecHdr h{};
+  h.magic = MAGIC;
+  h.gen = gen_ + 1;
+  h.schema = SCHEMA;
+  h.crc = crc32Ieee(&h, offsetof(SecHdr, crc));
+  program_((uint32_t)s * hal::FLASH_SECTOR, (const uint8_t*)&h, sizeof(SecHdr));
+
+  gen_ = h.gen;
+  active_ = s;
+  wr_ = sizeof(SecHdr);
+  return true;
+}
+
+bool KvStore::advance_() {
+  const uint8_t next = (uint8_t)((active_ + 1) % nsec_);
+  // a spare still holding live records (failed reclaim) is never erased: writes fail instead
+  if (secLive_(next)) return false;
+  if (!startSector_(next)) return false;
+
+  // keep the sector after the active one erased: move the oldest one's live records forward
+  const uint8_t oldest = (uint8_t)((next + 1) % nsec_);
+  SecHdr h;
+  if (secHdrOk_(oldest, h)) return reclaim_(oldest);
+  if (!secBlank_(oldest)) eraseSector_(oldest);
+  return true;
+}
+
+bool KvStore::secLive_(uint8_t s) const {
+  const uint32_t lo = (uint32_t)s * hal::FLASH_SECTOR;
+  for (uint8_t i = 0; i < nidx_; i++) {
+    if (idx_[i].addr >= lo && idx_[i].addr < lo + hal::FLASH_SECTOR) return true;
+  }
+  return false;
+}
+
+bool KvStore::reclaim_(uint8_t s) {
+  const uint32_t lo = (uint32_t)s * hal::FLASH_SECTOR;
+  const uint32_t hi = lo + hal::FLASH_SECTOR;
+  RecHdr h;
+  for (uint8_t i = 0; i < nidx_; ) {
+    const uint32_t a = idx_[i].addr;
+    if (a < lo || a >= hi) { i++; continue; }
+    memcpy(&h, at_(a), sizeof(RecHdr));
+    // a delete in the oldest sector has nothing older left to hide
+    if (h.len == 0) { dropIdx_(i); continue; }
+    // one sector's live set always fits an empty sector; never advance from here
+    if (wr_ + recSize_(h.len) > hal::FLASH_SECTOR) return false;
+    if (!append_(h.key, h.ver, at_(a + sizeof(RecHdr)), h.len)) return false;
+    i++;
+  }
+  eraseSector_(s);
+  return true;
+}
+
+// Whole pages only; hal:: stalls XIP, interrupts and the other core while it programs.
+void KvStore::program_(uint32_t addr, const uint8_t* data, uint16_t len) {
+  static uint8_t page[hal::FLASH_PAGE];
+  while (len) {
+    const uint32_t pg = addr & ~(uint32_t)(hal::FLASH_PAGE - 1);
+    const uint16_t o = (uint16_t)(addr - pg);
+    uint16_t n = (uint16_t)(hal::FLASH_PAGE - o);
+    if (n > len) n = len;
+
+    // bytes outside the record stay 0xFF: programming never touches them
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page + o, data, n);
+    hal::flashProgram(pg, page, hal::FLASH_PAGE);
+
+    addr += n;
+    data += n;
+    len = (uint16_t)(len - n);
+  }
+}
+
+void KvStore::eraseSector_(uint8_t s) {
+  hal::flashErase((uint32_t)s * hal::FLASH_SECTOR, hal::FLASH_SECTOR);
+  erases_++;
+}
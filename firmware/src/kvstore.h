@@ -0,0 +1,116 @@
+#pragma once
+#include <Arduino.h>
+#include "cfg.h"
+
+// Record types; key = type << 8 | slot.
+enum KvType : uint8_t {
+  KV_SCHEMA = 0,   // store schema (written once BlobV1 data has been migrated)
+  KV_HXCAL  = 1,   // load cell calibration, slot = load cell
+  KV_THRCAL = 2,   // ESC throttle calibration, slot = ESC
+  KV_PROG   = 3,   // autotest program, slot = PROG slot
+  KV_SHUNT  = 4,   // INA226 shunt trim (reserved)
+  KV_PRESET = 5,   // motor / prop / ESC preset
+};
+static constexpr uint16_t kvKey(KvType t, uint8_t slot) { return (uint16_t)(((uint16_t)t << 8) | slot); }
+static constexpr KvType kvType(uint16_t key) { return (KvType)(key >> 8); }
+static constexpr uint8_t kvSlot(uint16_t key) { return (uint8_t)(key & 0xFF); }
+
+// Log-structured key/value store in the reserved flash region (hal::flashData(), the
+// "filesystem" area in platformio.ini; no filesystem is mounted there).
+//
+// Every put() appends a CRC-checked record to the active sector; the newest valid record of a
+// key wins, len 0 = deleted. Sectors are used as a ring with a generation number, so erases
+// rotate over the whole region (wear levelling). The sector after the active one is kept erased:
+// when the active one fills up, the next becomes active and the oldest sector's live records are
+// copied forward before it is erased as the new spare. A torn record fails its CRC and is skipped.
+//
+// Flash programming stops XIP (interrupts off, other core idled): put() only queues in RAM and
+// service() writes the queue while disarmed, so control never stalls on flash.
+// get() sees queued values immediately.
+class KvStore {
+public:
+  // scan the region and build the key index (idempotent)
+  bool begin();
+  bool mounted() const { return nsec_ != 0; }
+
+  // newest value of key (up to max bytes copied); false if absent or deleted
+  bool get(uint16_t key, void* buf, uint16_t max, uint16_t* len = nullptr, uint8_t* ver = nullptr);
+  bool has(uint16_t key);
+  // queue a record (ver = record layout version, for the owner's migrations); false if the
+  // queue is full or the record cannot fit in a sector
+  bool put(uint16_t key, uint8_t ver, const void* data, uint16_t len);
+  bool erase(uint16_t key) { return put(key, 0, nullptr, 0); }
+
+  // main loop: writes the queue when motor_idle (disarmed and stopped)
+  void service(bool motor_idle);
+  bool pending() const { return npend_ != 0; }
+
+  // diagnostics
+  uint8_t sectors() const { return nsec_; }
+  uint8_t keys() const { return nidx_; }
+  uint32_t generation() const { return gen_; }
+  uint32_t erases() const { return erases_; }   // since boot
+  uint16_t activeUsed() const { return wr_; }    // bytes used in the active sector
+
+  static constexpr uint16_t VALUE_MAX = 1024;   // largest record value
+
+private:
+  struct SecHdr {
+    uint32_t magic;
+    uint32_t gen;
+    uint16_t schema;
+    uint16_t rsvd;
+    uint32_t crc;
+  };
+  struct RecHdr {
+    uint16_t key;      // 0xFFFF = erased (end of the sector's log)
+    uint16_t len;
+    uint8_t  ver;
+    uint8_t  rsvd[3];
+    uint32_t crc;      // over key..rsvd and the value
+  };
+  struct Ent { uint16_t key; uint32_t addr; };   // addr = region offset of the newest record
+  struct Pend { uint16_t key; uint16_t len; uint16_t off; uint8_t ver; };
+
+  static constexpr uint32_t MAGIC = 0x3153564BUL;   // "KVS1"
+  static constexpr uint16_t SCHEMA = 2;             // 1 = BlobV1 EEPROM layout
+
+  const uint8_t* at_(uint32_t addr) const;
+  bool secHdrOk_(uint8_t s, SecHdr& h) const;
+  bool secBlank_(uint8_t s) const;
+  bool secLive_(uint8_t s) const;   // the index still points into sector s
+  bool recOk_(uint32_t addr, const RecHdr& h) const;
+  static uint16_t recSize_(uint16_t len) { return (uint16_t)(sizeof(RecHdr) + ((len + 3u) & ~3u)); }
+
+  void scanSector_(uint8_t s, bool active);
+  int findIdx_(uint16_t key) const;
+  bool setIdx_(uint16_t key, uint32_t addr);
+  void dropIdx_(int i);
+  int findPend_(uint16_t key) const;
+
+  bool flush_();
+  bool append_(uint16_t key, uint8_t ver, const uint8_t* data, uint16_t len);
+  bool advance_();
+  bool startSector_(uint8_t s);
+  bool reclaim_(uint8_t s);
+  void program_(uint32_t addr, const uint8_t* data, uint16_t len);
+  void eraseSector_(uint8_t s);
+
+private:
+  uint8_t nsec_ = 0;
+  uint8_t active_ = 0;
+  uint16_t wr_ = 0;        // append offset in the active sector
+  uint32_t gen_ = 0;
+  uint32_t erases_ = 0;
+
+  Ent idx_[KV_KEYS_MAX];
+  uint8_t nidx_ = 0;
+
+  Pend pend_[KV_PENDING_MAX];
+  uint8_t npend_ = 0;
+  uint16_t pool_used_ = 0;
+  uint8_t pool_[KV_PENDING_BYTES];
+};
+
+// one store shared by every CalStorage owner
+KvStore& kvStore();
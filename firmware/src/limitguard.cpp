@@ -0,0 +1,104 @@
+#include "limitguard.h"
+#include "esc_group.h"
+#include "sensors_ina226.h"
+#include "sensors_hx711.h"
+#include <math.h>
+
+static LimitGuard* g_limits = nullptr;   // for the ALERT interrupt
+
+const char* LimitGuard::kindReason(Kind k) {
+  switch (k) {
+    case K_CURRENT:    return "OVER_CURRENT";
+    case K_POWER:      return "OVER_POWER";
+    case K_THRUST:     return "OVER_THRUST";
+    case K_CURRENT_HW: return "OVER_CURRENT_HW";
+    default:           return "-";
+  }
+}
+
+void LimitGuard::begin(EscGroup* esc, SensorsIna226* ina, SensorsHx711* hx) {
+  esc_ = esc;
+  ina_ = ina;
+  hx_ = hx;
+  g_limits = this;
+  hx_count_ = hx_ ? hx_->sampleCount() : 0;
+
+  pinMode(PIN_INA_ALERT, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(PIN_INA_ALERT), onAlert_, FALLING);
+  setCurrentMax(i_max_A_);
+}
+
+bool LimitGuard::setCurrentMax(float a) {
+  i_max_A_ = (isfinite(a) && a > 0.0f) ? a : NAN;
+  hw_ok_ = ina_ && ina_->setOverCurrentAlert(i_max_A_) && isfinite(i_max_A_);
+  return hw_ok_;
+}
+
+// INA226 ALERT fell: the shunt is over the limit right now, cut without waiting for I2C
+void LimitGuard::onAlert_() {
+  LimitGuard* l = g_limits;
+  if (!l || !l->esc_ || !isfinite(l->i_max_A_)) return;
+  if (l->esc_->isFailsafe() || l->esc_->currentThrottlePct() <= 0.0f) return;
+  l->esc_->trip(kindReason(K_CURRENT_HW), l->ramp_ ? LIMIT_TRIP_RAMP_S : 0.0f);
+  l->hw_pending_ = true;
+}
+
+bool LimitGuard::over_(uint8_t& cnt, bool over) {
+  cnt = over ? (uint8_t)(cnt + 1) : 0;
+  return cnt >= LIMIT_CONFIRM;
+}
+
+void LimitGuard::trip_(Kind k, float value) {
+  if (k != K_CURRENT_HW) esc_->trip(kindReason(k), ramp_ ? LIMIT_TRIP_RAMP_S : 0.0f);
+  trips_++;
+  last_kind_ = k;
+  last_value_ = value;
+  n_i_ = n_p_ = n_t_ = 0;
+
+  Serial.print("ERR TRIP "); Serial.print(kindReason(k));
+  if (isfinite(value)) { Serial.print(' '); Serial.print(value, 2); }
+  Serial.println();
+}
+
+void LimitGuard::tick() {
+  if (!esc_) return;
+
+  if (hw_pending_) {
+    hw_pending_ = false;
+    trip_(K_CURRENT_HW, ina_ ? ina_->readCurrentA() : NAN);
+  }
+
+  // nothing to protect at rest or once tripped
+  if (esc_->isFailsafe() || esc_->currentThrottlePct() <= 0.0f) {
+    n_i_ = n_p_ = n_t_ = 0;
+    if (hx_) hx_count_ = hx_->sampleCount();
+    return;
+  }
+
+  // thrust: every new HX711 conversion
+  if (hx_ && hx_->sampleCount() != hx_count_) {
+    hx_count_ = hx_->sampleCount();
+    if (isfinite(thrust_max_g_) && hx_->calValid()) {
+      const float g = hx_->rawToGrams(hx_->lastRaw());
+      if (over_(n_t_, isfinite(g) && fabsf(g) > thrust_max_g_)) { trip_(K_THRUST, g); return; }
+    }
+  }
+
+  // current / power: fixed-rate shunt reads
+  if (!ina_ || (!isfinite(i_max_A_) && !isfinite(p_max_W_))) return;
+  const uint32_t now_us = (uint32_t)micros();
+  if ((uint32_t)(now_us - last_poll_us_) < LIMIT_POLL_US) return;
+  last_poll_us_ = now_us;
+
+  if (isfinite(p_max_W_) && (vbus_div_++ % LIMIT_VBUS_EVERY == 0 || !isfinite(vbus_V_))) {
+    vbus_V_ = ina_->readBusV();
+  }
+  const float i = ina_->readCurrentA();
+  if (!isfinite(i)) return;
+
+  if (isfinite(i_max_A_) && over_(n_i_, i > i_max_A_)) { trip_(K_CURRENT, i); return; }
+  if (isfinite(p_max_W_) && isfinite(vbus_V_)) {
+    const float p = i * vbus_V_;
+    if (over_(n_p_, p > p_max_W_)) trip_(K_POWER, p);
+  }
+}
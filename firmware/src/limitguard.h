@@ -0,0 +1,64 @@
+#pragma once
+#include <Arduino.h>
+#include "cfg.h"
+
+class EscGroup;
+class SensorsIna226;
+class SensorsHx711;
+
+// Over-current / over-power / over-thrust trip (LIMIT). While a motor spins, current is
+// read every LIMIT_POLL_US (bus voltage every LIMIT_VBUS_EVERY polls for power) and thrust
+// on every HX711 conversion; LIMIT_CONFIRM samples in a row over a limit latch the failsafe
+// OVER_CURRENT / OVER_POWER / OVER_THRUST. The INA226 ALERT pin adds a hardware
+// over-current trip (OVER_CURRENT_HW) straight from its interrupt. NaN = limit off.
+class LimitGuard {
+public:
+  enum Kind : uint8_t { K_NONE = 0, K_CURRENT, K_POWER, K_THRUST, K_CURRENT_HW };
+
+  void begin(EscGroup* esc, SensorsIna226* ina, SensorsHx711* hx);
+  void tick();   // main loop, every pass
+
+  bool setCurrentMax(float a);   // also reprograms the ALERT threshold
+  void setPowerMax(float w) { p_max_W_ = w; }
+  void setThrustMax(float g) { thrust_max_g_ = g; }
+  void setRamp(bool ramp) { ramp_ = ramp; }
+
+  float currentMax() const { return i_max_A_; }
+  float powerMax() const { return p_max_W_; }
+  float thrustMax() const { return thrust_max_g_; }
+  bool ramp() const { return ramp_; }
+  bool hwAlert() const { return hw_ok_; }
+
+  // last trip (kept until the next one)
+  uint32_t trips() const { return trips_; }
+  Kind lastKind() const { return last_kind_; }
+  float lastValue() const { return last_value_; }
+  static const char* kindReason(Kind k);   // failsafe reason string
+
+private:
+  static void onAlert_();
+  void trip_(Kind k, float value);
+  bool over_(uint8_t& cnt, bool over);
+
+private:
+  EscGroup* esc_ = nullptr;
+  SensorsIna226* ina_ = nullptr;
+  SensorsHx711* hx_ = nullptr;
+
+  float i_max_A_ = LIMIT_I_MAX_A_DEFAULT;
+  float p_max_W_ = NAN;
+  float thrust_max_g_ = NAN;
+  bool ramp_ = false;
+  bool hw_ok_ = false;
+
+  uint32_t last_poll_us_ = 0;
+  uint8_t vbus_div_ = 0;
+  float vbus_V_ = NAN;
+  uint32_t hx_count_ = 0;
+  uint8_t n_i_ = 0, n_p_ = 0, n_t_ = 0;
+
+  volatile bool hw_pending_ = false;   // set by the ALERT interrupt, reported by tick()
+  uint32_t trips_ = 0;
+  Kind last_kind_ = K_NONE;
+  float last_value_ = NAN;
+};
@@ -0,0 +1,46 @@
+#include "loopguard.h"
+#include "hal.h"
+
+static const char* const STAGE_NAME[LS_COUNT] = {
+  "ESC", "LIMITS", "HX", "AUTOTEST", "CLI", "RPMSTREAM", "FRAME", "INA", "CSV", "STORE",
+};
+
+const char* loopStageName(LoopStage s) {
+  return (s < LS_COUNT) ? STAGE_NAME[s] : "?";
+}
+
+void LoopGuard::begin() {
+  wdt_reboot_ = hal::wdtCausedReboot();
+  hal::wdtBegin(WDT_TIMEOUT_MS);
+  pass_t0_us_ = (uint32_t)micros();
+  stage_t0_us_ = pass_t0_us_;
+}
+
+void LoopGuard::beginPass() {
+  hal::wdtFeed();
+  pass_t0_us_ = (uint32_t)micros();
+  stage_t0_us_ = pass_t0_us_;
+  cur_ = LS_ESC;
+  worst_ = LS_ESC;
+  worst_us_ = 0;
+}
+
+void LoopGuard::stage(LoopStage s) {
+  const uint32_t now = (uint32_t)micros();
+  const uint32_t dt = (uint32_t)(now - stage_t0_us_);
+  if (dt > worst_us_) { worst_us_ = dt; worst_ = cur_; }
+  cur_ = s;
+  stage_t0_us_ = now;
+}
+
+void LoopGuard::endPass() {
+  stage(cur_);   // close the running stage
+  const uint32_t dt = (uint32_t)((uint32_t)micros() - pass_t0_us_);
+  if (dt > max_us_) max_us_ = dt;
+  if (dt > LOOP_OVERRUN_US) {
+    overruns_++;
+    last_stage_ = worst_;
+    last_us_ = dt;
+    last_ms_ = (uint32_t)millis();
+  }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <Arduino.h>
+#include "cfg.h"
+
+// Sections of one loop() pass, in order (stage() marks the start of each).
+enum LoopStage : uint8_t {
+  LS_ESC = 0,      // polled DShot fallback
+  LS_LIMITS,       // LIMIT trips (fast INA226 current reads)
+  LS_HX,           // HX711 conversion + window
+  LS_AUTOTEST,
+  LS_CLI,          // serial input + command handlers
+  LS_RPMSTREAM,
+  LS_FRAME,        // log frame: ESC telemetry, HX math, steady detector
+  LS_INA,          // INA226 I2C read
+  LS_CSV,          // CSV line out
+  LS_STORE,        // queued flash writes (motor stopped only)
+  LS_COUNT
+};
+
+const char* loopStageName(LoopStage s);
+
+// Loop supervision: feeds the RP2040 hardware watchdog once per pass and times every
+// stage. A pass longer than LOOP_OVERRUN_US counts as an overrun, blamed on its slowest
+// stage. (The motor side of a stuck pass is EscGroup's loop-stall monitor.)
+class LoopGuard {
+public:
+  // arms the watchdog; afterwards every pass must reach beginPass() within WDT_TIMEOUT_MS
+  void begin();
+  void beginPass();
+  void stage(LoopStage s);
+  void endPass();
+
+  bool wdtReboot() const { return wdt_reboot_; }      // last reset came from the watchdog
+  uint32_t overruns() const { return overruns_; }
+  LoopStage lastOverrunStage() const { return last_stage_; }
+  uint32_t lastOverrunUs() const { return last_us_; }
+  uint32_t lastOverrunMs() const { return last_ms_; }   // millis() of the last overrun, 0 = none
+  uint32_t maxPassUs() const { return max_us_; }
+
+private:
+  bool wdt_reboot_ = false;
+  uint32_t pass_t0_us_ = 0;
+  uint32_t stage_t0_us_ = 0;
+  LoopStage cur_ = LS_ESC;
+  LoopStage worst_ = LS_ESC;     // slowest stage of the current pass
+  uint32_t worst_us_ = 0;
+
+  uint32_t overruns_ = 0;
+  LoopStage last_stage_ = LS_ESC;
+  uint32_t last_us_ = 0;
+  uint32_t last_ms_ = 0;
+  uint32_t max_us_ = 0;
+};
@@ -2,21 +2,29 @@
 
 #include "cfg.h"
 #include "frame.h"
+#include "snapshot.h"
 #include "meta.h"
 #include "csv.h"
 
-#include "esc_bdshot.h"
+#include "esc_group.h"
 #include "sensors_hx711.h"
 #include "sensors_ina226.h"
 #include "cli.h"
 #include "autotest.h"
+#include "loopguard.h"
+#include "limitguard.h"
+#include "kvstore.h"
+#include "crc.h"
 
-static EscBdshot esc;
+static EscGroup escs;
 static SensorsHx711 hx;
 static SensorsIna226 ina;
 static CLI cli;
 static AutoTest autotest;
 static Meta meta;
+static FrameSnapshot live;   // latest frame for STATUS / queries / batch gate
+static LoopGuard guard;
+static LimitGuard limits;
 
 static uint32_t last_log_ms = 0;
 
@@ -26,32 +34,67 @@ static inline uint32_t ms_since(uint32_t t0) { return (uint32_t)(millis() - t0);
 // === Hardware ===
 static constexpr uint8_t HX_DOUT_GPIO = 6;
 static constexpr uint8_t HX_SCK_GPIO  = 7;
-static constexpr uint8_t ESC_GPIO     = 2;
 static constexpr uint8_t INA226_I2C_ADDR = 0x40;
 
 static uint32_t last_hx_sample_count = 0;
+static uint32_t rpm_stream_seq = 0;
+
+// Drain new full-rate eRPM samples to Serial (bounded per loop pass).
+static void serviceRpmStream() {
+  EscBdshot& esc = escs.primary();
+  const uint32_t head = esc.erpmHistSeq();
+  if (!cli.rpmStreamOn()) { rpm_stream_seq = head; return; }
+
+  // fell behind the ring: skip to the oldest retained sample
+  if ((uint32_t)(head - rpm_stream_seq) > ERPM_HIST_LEN) rpm_stream_seq = head - ERPM_HIST_LEN;
+
+  ErpmSample s;
+  uint8_t n = 0;
+  while (rpm_stream_seq != head && n < RPM_STREAM_MAX_PER_LOOP) {
+    if (esc.erpmHistAt(rpm_stream_seq, s)) printRpmStreamSample(s, esc.polePairs());
+    rpm_stream_seq++;
+    n++;
+  }
+}
 
 void setup() {
   Serial.begin(SERIAL_BAUD);
   delay(200);
+  if (!crcSelfTest()) Serial.println("ERR CRC self-test");
 
   hx.begin(HX_DOUT_GPIO, HX_SCK_GPIO);
   ina.begin(INA226_I2C_ADDR, SHUNT_OHMS, INA_EXPECTED_MAX_CURRENT_A);
 
-  esc.begin(ESC_GPIO, DSHOT_SPEED);
-  esc.setPolePairs(meta.pole_pairs);
+  escs.begin(PIN_DSHOT_LIST, ESC_COUNT_DEFAULT, DSHOT_SPEED);
+  escs.setPolePairs(meta.pole_pairs);
+  escs.startSendTimer(); // falls back to polled tickFast() if no alarm is free
+  limits.begin(&escs, &ina, &hx);
 
   cli.begin();
-  cli.bind(&esc, &hx, &ina, &meta, &autotest);
+  cli.bind(&escs, &hx, &ina, &meta, &autotest, &live, &guard, &limits);
+  cli.restorePreset();
 
   last_log_ms = now_ms();
+
+  // last in setup: from here on a stuck loop() pass ramps the motors down, then reboots
+  guard.begin();
 }
 
 void loop() {
-  // 1) ESC MUST tick fast (send throttle + pull telemetry)
-  esc.tickFast();
+  // 0) supervision: feed the watchdog and the ESC loop-stall monitor
+  guard.beginPass();
+  escs.loopBeat();
+
+  // 1) ESCs: hardware alarm sends + pulls telemetry; polled fallback only
+  guard.stage(LS_ESC);
+  escs.tickFast();
+
+  // 1b) over-current / power / thrust trips, between frames
+  guard.stage(LS_LIMITS);
+  limits.tick();
 
   // 2) HX tick fast
+  guard.stage(LS_HX);
   hx.tickFast();
 
   // push to rolling HX window only when NEW sample arrives
@@ -62,13 +105,19 @@ void loop() {
   }
 
   // 3) Other periodic logic
-  autotest.tick(esc);
+  guard.stage(LS_AUTOTEST);
+  autotest.tick(escs);
+  guard.stage(LS_CLI);
   cli.tick();
+  guard.stage(LS_RPMSTREAM);
+  serviceRpmStream();
 
-  // 4) Log/status update at LOG_PERIOD_MS
+  // 4) Log/status update at LOG_PERIOD_MS (SWEEP_LOG_PERIOD_MS during a sweep)
   const uint32_t now = now_ms();
-  if (ms_since(last_log_ms) >= LOG_PERIOD_MS) {
+  const uint32_t log_period_ms = autotest.sweepActive() ? SWEEP_LOG_PERIOD_MS : LOG_PERIOD_MS;
+  if (ms_since(last_log_ms) >= log_period_ms) {
     last_log_ms = now;
+    guard.stage(LS_FRAME);
 
     Frame f;
     f.t_ms = now;
@@ -80,21 +129,48 @@ void loop() {
       f.is_steady = autotest.isSteady() ? 1 : 0;
     }
 
-    // ESC telemetry
+    // ESC telemetry (motor 1 -> legacy columns)
+    EscBdshot& esc = escs.primary();
     auto tel = esc.getTelemetry();
     f.erpm = tel.erpm;
     f.rpm = tel.rpm;
     f.bdshot_err_pct = tel.bdshot_err_pct;
+    f.esc_temp_C = escs.maxTempC();
+
+    auto rs = esc.takeRpmStats();
+    if (rs.n > 0) {
+      f.rpm_mean = rs.rpm_mean;
+      f.rpm_min = rs.rpm_min;
+      f.rpm_max = rs.rpm_max;
+    }
+
+    if (esc.rpmMode()) {
+      f.rpm_sp = (float)esc.rpmSetpoint();
+      f.rpm_err = f.rpm_sp - esc.rpmFiltered();
+    }
+
+    // motors 2..N
+    for (uint8_t i = 1; i < escs.count(); i++) {
+      EscBdshot& m = escs.motor(i);
+      auto mt = m.getTelemetry();
+      auto mr = m.takeRpmStats();
+      f.aux[i - 1].throttle_pct = m.currentThrottlePct();
+      f.aux[i - 1].rpm = (mr.n > 0) ? mr.rpm_mean : (float)mt.rpm;
+      f.aux[i - 1].bdshot_err_pct = mt.bdshot_err_pct;
+    }
 
     // INA
+    guard.stage(LS_INA);
     InaSample is = ina.read();
     f.v_bus_V = is.v_bus_V;
     f.i_A = is.i_A;
     f.p_in_W = is.p_W;
+    guard.stage(LS_FRAME);
 
     // HX noise + thrust (ROLLING WINDOW, no reset here)
     auto nz = hx.windowNoise();
     f.hx_noise_pp = nz.valid ? nz.raw_pp : -1;
+    f.hx_raw = hx.lastRaw();
 
     int32_t raw_for_thrust = hx.lastRaw();
     if (hx.windowHasEnough(4)) {
@@ -110,25 +186,26 @@ void loop() {
       f.thrust_N = NAN;
     }
 
-    // efficiencies
-    if (isfinite(f.thrust_g) && isfinite(f.p_in_W) && f.p_in_W > 0.1f) f.eff_g_per_W = f.thrust_g / f.p_in_W;
-    if (isfinite(f.thrust_N) && isfinite(f.p_in_W) && f.p_in_W > 0.1f) f.eff_N_per_W = f.thrust_N / f.p_in_W;
-    if (isfinite(f.thrust_g) && isfinite(f.i_A) && fabsf(f.i_A) > 0.01f) f.eff_g_per_A = f.thrust_g / f.i_A;
+    frameDeriveEfficiency(f);
 
     f.throttle_pct = esc.currentThrottlePct();
 
-    // update CLI live snapshot for STATUS
-    cli.setLive(
-      f.thrust_g, f.thrust_N,
-      f.v_bus_V, f.i_A, f.p_in_W,
-      f.erpm, f.rpm, f.bdshot_err_pct,
-      hx.lastRaw(), hx.offset(), hx.scaleCountsPerG(),
-      hx.calValid(), hx.inverted(),
-      f.hx_noise_pp
-    );
+    // steady-state detector sees every frame, logged or not
+    autotest.feed(f);
+
+    // publish for STATUS / STAT? / GET / batch gate (readers copy it consistently)
+    live.publish(f);
 
     if (cli.csvOn()) {
-      printCsvFrame(f, meta, esc, cli.notes());
+      guard.stage(LS_CSV);
+      printCsvFrame(f, meta, cli.notes());
     }
   }
+
+  // 5) flash writes (SAVE, THRCAL SAVE, PROG SAVE, ...) only while disarmed and stopped: an
+  //    armed rig at 0 % (BATCH gap, between commands) still needs every DShot frame
+  guard.stage(LS_STORE);
+  kvStore().service(!cli.armed() && escs.currentThrottlePct() <= 0.0f && !autotest.active());
+
+  guard.endPass();
 }
@@ -1,14 +1,27 @@
 #pragma once
 #include <Arduino.h>
+#include "textbuf.h"
 
 // Metadata for CSV and status.
 // Keep defaults "NA"/-1 so CSV remains valid even without setmeta.
+// Text fields are fixed buffers: SETMETA never touches the heap.
 struct Meta {
-  String test_id   = "NA";
-  String motor_id  = "NA";
+  static constexpr uint8_t FIELD_LEN = 24;   // incl. terminator
+  char   test_id[FIELD_LEN]  = "NA";
+  char   motor_id[FIELD_LEN] = "NA";
   int    kv        = -1;
-  String prop      = "NA";
+  char   prop[FIELD_LEN]     = "NA";
   int    battery_s = -1;
-  String esc_fw    = "NA";
+  char   esc_fw[FIELD_LEN]   = "NA";
   uint8_t pole_pairs = 7;
 };
+
+// Longest text a Meta field holds (SETMETA / BATCH ADD reject longer values).
+static constexpr size_t META_TEXT_MAX = Meta::FIELD_LEN - 1;
+
+// Copy src into a Meta text field, always terminated. False if src was longer than
+// META_TEXT_MAX and got cut.
+static inline bool metaSet(char (&dst)[Meta::FIELD_LEN], const char* src) { return textCopy(dst, src); }
+
+// True if s fits a Meta text field.
+static inline bool metaFits(const char* s) { return s && strlen(s) <= META_TEXT_MAX; }
@@ -0,0 +1,67 @@
+#include "program.h"
+#include "textbuf.h"
+#include <math.h>
+
+bool atProgramNameValid(const char* name) {
+  if (!name || !name[0]) return false;
+  size_t n = 0;
+  for (const char* c = name; *c; c++, n++) {
+    if (n >= AtProgram::NAME_LEN - 1) return false;
+    const bool ok = isalnum((unsigned char)*c) || *c == '_' || *c == '-';
+    if (!ok) return false;
+  }
+  return true;
+}
+
+void atProgramSetName(AtProgram& p, const char* name) {
+  textCopy(p.name, name);
+}
+
+void atProgramFromTable(AtProgram& p, const char* name, const float* values, const float* hold_s,
+                        int n, float ramp_s, RampProfile prof, AtStepType type) {
+  atProgramSetName(p, name);
+  if (n < 0) n = 0;
+  if (n > AtProgram::MAX_STEPS) n = AtProgram::MAX_STEPS;
+  p.count = (uint8_t)n;
+  for (int i = 0; i < n; i++) {
+    AtStep& s = p.steps[i];
+    s.value = values[i];
+    s.ramp_s = ramp_s;
+    s.hold_s = hold_s[i];
+    s.type = (uint8_t)type;
+    s.prof = (uint8_t)prof;
+  }
+}
+
+const char* atStepValidate(const AtStep& s) {
+  if (!isfinite(s.value) || !isfinite(s.ramp_s) || !isfinite(s.hold_s)) return "nan";
+  if (s.type == AT_STEP_THROTTLE) {
+    if (s.value < 0.0f || s.value > 100.0f) return "throttle_range";
+  } else if (s.type == AT_STEP_RPM) {
+    if (s.value < 0.0f || s.value > AT_PROG_MAX_RPM) return "rpm_range";
+  } else {
+    return "type";
+  }
+  if (s.prof > RAMP_EXP) return "profile";
+  if (s.ramp_s < 0.0f || s.ramp_s > AT_PROG_MAX_RAMP_S) return "ramp_range";
+  if (s.hold_s <= 0.0f || s.hold_s > AT_PROG_MAX_HOLD_S) return "hold_range";
+  return nullptr;
+}
+
+const char* atProgramValidate(const AtProgram& p) {
+  if (!atProgramNameValid(p.name)) return "name";
+  if (p.count == 0) return "empty";
+  if (p.count > AtProgram::MAX_STEPS) return "too_many_steps";
+
+  for (uint8_t i = 0; i < p.count; i++) {
+    const char* err = atStepValidate(p.steps[i]);
+    if (err) return err;
+  }
+  return nullptr;
+}
+
+float atProgramDurationS(const AtProgram& p) {
+  float t = 0.0f;
+  for (uint8_t i = 0; i < p.count && i < AtProgram::MAX_STEPS; i++) t += p.steps[i].hold_s;
+  return t;
+}
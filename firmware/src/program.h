@@ -0,0 +1,42 @@
+#pragma once
+#include <Arduino.h>
+#include "ramp.h"
+
+// What a step value means.
+enum AtStepType : uint8_t {
+  AT_STEP_THROTTLE = 0,   // value = throttle %
+  AT_STEP_RPM      = 1,   // value = RPM setpoint (closed loop)
+};
+
+struct AtStep {
+  float   value  = 0.0f;   // throttle % or RPM (type)
+  float   ramp_s = 0.0f;   // ramp time to reach the step (full 0..100 % swing, like THROTTLE)
+  float   hold_s = 0.0f;   // step duration, ramp included
+  uint8_t type   = AT_STEP_THROTTLE;  // AtStepType
+  uint8_t prof   = RAMP_LINEAR;       // RampProfile (throttle steps)
+};
+
+// Fixed-size autotest program (no heap): streamed in via PROG, stored in flash, run by AutoTest.
+struct AtProgram {
+  static constexpr uint8_t NAME_LEN = 16;   // incl. terminator
+  static constexpr uint8_t MAX_STEPS = 64;
+  char name[NAME_LEN]{};
+  uint8_t count = 0;
+  AtStep steps[MAX_STEPS]{};
+};
+
+// limits checked by atProgramValidate()
+static constexpr float AT_PROG_MAX_RPM    = 60000.0f;
+static constexpr float AT_PROG_MAX_RAMP_S = 60.0f;
+static constexpr float AT_PROG_MAX_HOLD_S = 3600.0f;
+
+bool atProgramNameValid(const char* name);
+void atProgramSetName(AtProgram& p, const char* name);
+// Fill p from parallel tables (legacy profiles / AUTOTEST CORE).
+void atProgramFromTable(AtProgram& p, const char* name, const float* values, const float* hold_s,
+                        int n, float ramp_s, RampProfile prof, AtStepType type);
+// nullptr if the step is valid, else a short reason
+const char* atStepValidate(const AtStep& s);
+// nullptr if p is runnable, else a short reason for "ERR PROG ..."
+const char* atProgramValidate(const AtProgram& p);
+float atProgramDurationS(const AtProgram& p);
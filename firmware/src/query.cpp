@@ -0,0 +1,67 @@
+#include "query.h"
+#include <math.h>
+
+static const char* const KEY_NAMES[QK_COUNT] = {
+  "fseq", "t_ms", "armed", "log", "mode", "thr", "thr_tgt", "rpm", "erpm", "rpm_sp",
+  "bdshot_err", "temp_c", "v", "i", "p", "thrust_g", "thrust_n", "hx_raw", "hx_noise",
+  "failsafe", "fs_reason", "overruns", "at", "step", "steady", "job",
+};
+
+const char* queryKeyName(QueryKey k) {
+  return (k < QK_COUNT) ? KEY_NAMES[k] : "";
+}
+
+int queryKeyFind(const char* name, size_t len) {
+  for (uint8_t k = 0; k < QK_COUNT; k++) {
+    const char* kn = KEY_NAMES[k];
+    size_t i = 0;
+    while (i < len && kn[i] && (char)tolower((unsigned char)name[i]) == kn[i]) i++;
+    if (i == len && kn[i] == '\0') return k;
+  }
+  return -1;
+}
+
+void QueryLine::add(char c) {
+  if (len + 1 >= QUERY_LINE_MAX) { overflow = true; return; }
+  buf[len++] = c;
+}
+
+void QueryLine::add(const char* s) {
+  while (s && *s) add(*s++);
+}
+
+void QueryLine::addUInt(uint32_t v) {
+  char tmp[10];
+  uint8_t n = 0;
+  do { tmp[n++] = (char)('0' + v % 10); v /= 10; } while (v);
+  while (n) add(tmp[--n]);
+}
+
+void QueryLine::addInt(int32_t v) {
+  if (v < 0) { add('-'); addUInt((uint32_t)(-(int64_t)v)); }
+  else addUInt((uint32_t)v);
+}
+
+void QueryLine::addFloat(float v, uint8_t prec) {
+  if (!isfinite(v) || fabsf(v) >= 4.0e9f) { add("NaN"); return; }
+  if (prec > 6) prec = 6;
+  uint32_t scale = 1;
+  for (uint8_t i = 0; i < prec; i++) scale *= 10;
+
+  const bool neg = v < 0.0f;
+  const double a = fabs((double)v);
+  uint64_t fixed = (uint64_t)(a * (double)scale + 0.5);
+  if (neg && fixed != 0) add('-');
+  addUInt((uint32_t)(fixed / scale));
+  if (prec == 0) return;
+  add('.');
+  uint32_t frac = (uint32_t)(fixed % scale);
+  for (uint32_t d = scale / 10; d > 0; d /= 10) { add((char)('0' + frac / d)); frac %= d; }
+}
+
+void QueryLine::send() {
+  buf[len] = '\n';
+  (out ? *out : (Print&)Serial).write((const uint8_t*)buf, len + 1);
+  len = 0;
+  overflow = false;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <Arduino.h>
+#include "cfg.h"
+
+// Keys of the STAT? / GET query protocol (order = STAT? line order).
+enum QueryKey : uint8_t {
+  QK_FSEQ = 0,      // live frame sequence (increments per log frame)
+  QK_T_MS,          // device time of the reply
+  QK_ARMED,
+  QK_LOG,
+  QK_MODE,          // THR | RPM
+  QK_THR,           // throttle % (primary)
+  QK_THR_TGT,
+  QK_RPM,
+  QK_ERPM,
+  QK_RPM_SP,        // NaN in throttle mode
+  QK_BDSHOT_ERR,
+  QK_TEMP_C,        // hottest EDT temperature
+  QK_V,
+  QK_I,
+  QK_P,
+  QK_THRUST_G,
+  QK_THRUST_N,
+  QK_HX_RAW,
+  QK_HX_NOISE,
+  QK_FAILSAFE,
+  QK_FS_REASON,
+  QK_OVERRUNS,      // loop() passes over LOOP_OVERRUN_US since boot
+  QK_AT,            // autotest running
+  QK_STEP,
+  QK_STEADY,
+  QK_JOB,           // exclusive job (THRCAL / STEPRESP / BATCH) or "-"
+  QK_COUNT
+};
+
+const char* queryKeyName(QueryKey k);
+// key by name (case-insensitive), -1 if unknown
+int queryKeyFind(const char* name, size_t len);
+
+// Fixed reply line: built in RAM, sent with one write (no heap, no printf).
+struct QueryLine {
+  char buf[QUERY_LINE_MAX];
+  uint16_t len = 0;
+  bool overflow = false;
+  Print* out = nullptr;   // nullptr = Serial
+
+  void add(const char* s);
+  void add(char c);
+  void addUInt(uint32_t v);
+  void addInt(int32_t v);
+  void addFloat(float v, uint8_t prec);   // "NaN" if not finite
+  void send();                            // + "\n"
+};
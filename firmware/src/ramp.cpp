@@ -0,0 +1,81 @@
+#include "ramp.h"
+
+// (1 - e^(-4x)) / (1 - e^(-4)) at x = i/32, Q16
+static const uint16_t EXP_LUT_Q16[33] = {
+  0, 7844, 14767, 20876, 26268, 31025, 35224, 38930, 42200, 45085, 47632,
+  49879, 51863, 53613, 55158, 56521, 57724, 58786, 59722, 60549, 61279, 61923,
+  62491, 62992, 63435, 63826, 64170, 64474, 64743, 64980, 65189, 65373, 65535
+};
+
+const char* rampProfileName(RampProfile p) {
+  switch (p) {
+    case RAMP_SCURVE: return "SCURVE";
+    case RAMP_EXP:    return "EXP";
+    default:          return "LIN";
+  }
+}
+
+bool rampProfileParse(const char* s, RampProfile& out) {
+  if (!s) return false;
+  if (!strcasecmp(s, "lin") || !strcasecmp(s, "linear")) { out = RAMP_LINEAR; return true; }
+  if (!strcasecmp(s, "s") || !strcasecmp(s, "scurve"))   { out = RAMP_SCURVE; return true; }
+  if (!strcasecmp(s, "exp"))                             { out = RAMP_EXP; return true; }
+  return false;
+}
+
+// shape s(x), x and result in Q16 [0..65536]
+static int32_t shapeQ16(RampProfile p, uint32_t x) {
+  switch (p) {
+    case RAMP_SCURVE: {
+      // 6x^5 - 15x^4 + 10x^3 = x^3 * (10 - 15x + 6x^2)
+      const int64_t x2 = ((int64_t)x * x) >> 16;
+      const int64_t x3 = (x2 * x) >> 16;
+      const int64_t inner = ((int64_t)10 << 16) - 15 * (int64_t)x + 6 * x2;
+      return (int32_t)((x3 * inner) >> 16);
+    }
+    case RAMP_EXP: {
+      const uint32_t i = x >> 11;           // 32 segments
+      if (i >= 32) return 65536;
+      const uint32_t f = x & 0x7FF;         // fraction within segment (Q11)
+      const int32_t a = EXP_LUT_Q16[i];
+      const int32_t b = EXP_LUT_Q16[i + 1];
+      return a + (int32_t)(((int64_t)(b - a) * f) >> 11);
+    }
+    default:
+      return (int32_t)x;
+  }
+}
+
+void RampGen::reset(int32_t value_cpct) {
+  v_q16_ = value_cpct << 16;
+  v0_q16_ = v_q16_;
+  v1_q16_ = v_q16_;
+  dur_us_ = 0;
+  active_ = false;
+}
+
+void RampGen::start(int32_t target_cpct, uint32_t duration_us, RampProfile prof, uint32_t now_us) {
+  // new segment always starts from the current output (bumpless retarget mid-ramp)
+  v0_q16_ = v_q16_;
+  v1_q16_ = target_cpct << 16;
+  t0_us_ = now_us;
+  dur_us_ = duration_us;
+  prof_ = prof;
+  active_ = (duration_us > 0 && v0_q16_ != v1_q16_);
+  if (!active_) v_q16_ = v1_q16_;
+}
+
+int32_t RampGen::tick(uint32_t now_us) {
+  if (active_) {
+    const uint32_t el = (uint32_t)(now_us - t0_us_);  // wrap-safe
+    if (el >= dur_us_) {
+      v_q16_ = v1_q16_;
+      active_ = false;
+    } else {
+      const uint32_t x = (uint32_t)(((uint64_t)el << 16) / dur_us_);
+      const int64_t d = (int64_t)v1_q16_ - (int64_t)v0_q16_;
+      v_q16_ = v0_q16_ + (int32_t)((d * shapeQ16(prof_, x)) >> 16);
+    }
+  }
+  return value();
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <Arduino.h>
+
+// Throttle ramp shapes.
+enum RampProfile : uint8_t {
+  RAMP_LINEAR = 0,   // constant rate
+  RAMP_SCURVE = 1,   // quintic smootherstep: zero velocity/accel at both ends (bounded jerk)
+  RAMP_EXP    = 2,   // first-order approach (tau = T/4), normalized to land exactly at T
+};
+
+const char* rampProfileName(RampProfile p);
+bool rampProfileParse(const char* s, RampProfile& out);
+
+// Fixed-point, time-parameterized ramp segment (value in 0.01 % units, Q16 internally).
+// tick() evaluates the profile at absolute µs time, so the result does not depend
+// on how often it is called (no dt accumulation / stair-steps).
+class RampGen {
+public:
+  void reset(int32_t value_cpct);
+  void start(int32_t target_cpct, uint32_t duration_us, RampProfile prof, uint32_t now_us);
+  int32_t tick(uint32_t now_us);
+
+  int32_t value() const { return (int32_t)(v_q16_ >> 16); }
+  int32_t target() const { return (int32_t)(v1_q16_ >> 16); }
+  RampProfile profile() const { return prof_; }
+  bool done() const { return !active_; }
+
+private:
+  int32_t v_q16_ = 0;
+  int32_t v0_q16_ = 0;
+  int32_t v1_q16_ = 0;
+  uint32_t t0_us_ = 0;
+  uint32_t dur_us_ = 0;
+  RampProfile prof_ = RAMP_LINEAR;
+  bool active_ = false;
+};
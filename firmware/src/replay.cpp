@@ -0,0 +1,384 @@
+// Host log replay: recorded frames go back through the same code as main.cpp's log step
+// (efficiencies, steady-state detector, eRPM outlier filter + frame stats, CSV printer) and the
+// regenerated columns are diffed against the recording. Native build only.
+#if !defined(ARDUINO_ARCH_RP2040)
+
+#include <Arduino.h>
+#include <float.h>
+#include "replay.h"
+#include "frame.h"
+#include "meta.h"
+#include "csv.h"
+#include "steady.h"
+#include "esc_bdshot.h"
+
+// csv.cpp column order; the legacy 24-column log is the first 23 plus notes
+enum Col : uint8_t {
+  C_T_MS = 0, C_TEST_ID, C_MOTOR_ID, C_KV, C_PROP, C_BATTERY_S, C_ESC_FW, C_POLE_PAIRS,
+  C_STEP_ID, C_THROTTLE, C_STEP_TIME, C_IS_STEADY, C_ERPM, C_RPM, C_V_BUS, C_I, C_P_IN,
+  C_THRUST_N, C_THRUST_G, C_EFF_G_W, C_EFF_N_W, C_EFF_G_A, C_BDSHOT_ERR,
+  C_RPM_MEAN, C_RPM_MIN, C_RPM_MAX, C_RPM_SP, C_RPM_ERR,
+  C_AUX,                       // m2..m4: throttle_pct, RPM, bdshot_err_pct
+  C_NOTES = C_AUX + 3 * (ESC_COUNT_MAX - 1),
+  C_COUNT,
+  C_NONE = 0xFF,
+};
+static_assert(C_COUNT == 38, "replay columns must follow csv.cpp");
+
+static const char* const COL_NAMES[C_COUNT] = {
+  "t_ms", "test_id", "motor_id", "kv", "prop", "battery_s", "esc_fw", "pole_pairs",
+  "step_id", "throttle_pct", "step_time_s", "is_steady", "eRPM", "RPM", "V_bus_V", "I_A", "P_in_W",
+  "thrust_N", "thrust_g", "eff_g_per_W", "eff_N_per_W", "eff_g_per_A", "bdshot_err_pct",
+  "RPM_mean", "RPM_min", "RPM_max", "RPM_sp", "RPM_err",
+  "m2_throttle_pct", "m2_RPM", "m2_bdshot_err_pct",
+  "m3_throttle_pct", "m3_RPM", "m3_bdshot_err_pct",
+  "m4_throttle_pct", "m4_RPM", "m4_bdshot_err_pct",
+  "notes",
+};
+static constexpr uint8_t LEGACY_COLS = 24;
+
+// columns the replay recomputes (the rest are inputs, copied through)
+static const Col REGEN[] = { C_IS_STEADY, C_EFF_G_W, C_EFF_N_W, C_EFF_G_A, C_RPM_MEAN, C_RPM_MIN, C_RPM_MAX };
+static constexpr uint8_t REGEN_COUNT = sizeof(REGEN) / sizeof(REGEN[0]);
+static constexpr uint8_t REGEN_RPM_FIRST = 4;   // RPM stats: only with RPMSTREAM samples
+
+static constexpr size_t REPLAY_LINE_MAX = 1024;
+
+struct ColDiff {
+  uint32_t n = 0;
+  uint32_t diff = 0;
+  uint32_t first_t_ms = 0;
+  double first_old = NAN, first_new = NAN;
+  double max_abs = 0.0;
+};
+
+struct Replay {
+  uint8_t map[C_COUNT];       // input field -> Col
+  uint8_t fields = 0;         // 0 = layout not known yet
+  bool header = false;
+
+  Frame prev;
+  bool have_prev = false;
+  bool ramp_done = false;
+  SteadyDetector det;
+
+  EscBdshot esc;              // eRPM filter + frame stats only (never begin()-ed)
+  uint32_t erpm_samples = 0;
+
+  // a frame line waits for the RPMSTREAM samples printed after it but taken before it
+  char pending[REPLAY_LINE_MAX];
+  bool have_pending = false;
+  uint32_t pending_end_us = 0;
+
+  uint32_t frames = 0;
+  uint32_t meta_cut = 0;      // frames with a meta text longer than a Meta field holds
+  ColDiff diff[REGEN_COUNT];
+};
+
+// "hh:mm:ss.mmm > " (monitor_filters = time) and a bare "> "
+static char* stripPrefix(char* s) {
+  if (strlen(s) > 12 && s[2] == ':' && s[5] == ':' && s[8] == '.') {
+    char* gt = strchr(s, '>');
+    if (gt) s = gt + 1;
+  } else if (s[0] == '>') {
+    s++;
+  }
+  while (*s == ' ') s++;
+  char* e = s + strlen(s);
+  while (e > s && (e[-1] == '\n' || e[-1] == '\r')) *--e = '\0';
+  return s;
+}
+
+static uint8_t splitFields(char* s, char** out, uint8_t max) {
+  uint8_t n = 0;
+  for (;;) {
+    if (n == max) return max + 1;   // too many
+    out[n++] = s;
+    char* c = strchr(s, ',');
+    if (!c) return n;
+    *c = '\0';
+    s = c + 1;
+  }
+}
+
+static void setLayout(Replay& r, uint8_t n) {
+  r.fields = n;
+  for (uint8_t i = 0; i < n; i++) {
+    r.map[i] = (n == LEGACY_COLS && i == LEGACY_COLS - 1) ? (uint8_t)C_NOTES : i;
+  }
+}
+
+static bool mapHeader(Replay& r, char** f, uint8_t n) {
+  if (n > C_COUNT) return false;
+  for (uint8_t i = 0; i < n; i++) {
+    r.map[i] = C_NONE;
+    for (uint8_t c = 0; c < C_COUNT; c++) {
+      if (strcmp(f[i], COL_NAMES[c]) == 0) r.map[i] = c;
+    }
+  }
+  r.fields = n;
+  r.header = true;
+  return true;
+}
+
+// printed decimals of a recorded value: the comparison tolerance is half its last digit
+static double halfUlp(const char* s) {
+  const char* dot = strchr(s, '.');
+  if (!dot) return 0.5;
+  int d = 0;
+  for (const char* p = dot + 1; *p >= '0' && *p <= '9'; p++) d++;
+  return 0.5 * pow(10.0, -d);
+}
+
+static double colValue(const Frame& f, Col c) {
+  switch (c) {
+    case C_IS_STEADY: return f.is_steady;
+    case C_EFF_G_W: return f.eff_g_per_W;
+    case C_EFF_N_W: return f.eff_N_per_W;
+    case C_EFF_G_A: return f.eff_g_per_A;
+    case C_RPM_MEAN: return f.rpm_mean;
+    case C_RPM_MIN: return f.rpm_min;
+    case C_RPM_MAX: return f.rpm_max;
+    default: return NAN;
+  }
+}
+
+// RPM the steady detector sees (AutoTest::feed)
+static float frameRpm(const Frame& f) { return isfinite(f.rpm_mean) ? f.rpm_mean : (float)f.rpm; }
+
+// relative rounding of a recorded value (0 if not finite or zero)
+static double relRound(const char* tok, float v) {
+  return (tok && isfinite(v) && v != 0.0f) ? halfUlp(tok) / fabs((double)v) : 0.0;
+}
+
+// false if a meta text had to be cut to fit its Meta field
+static bool parseInto(Frame& f, Meta& m, char** fld, const uint8_t* map, uint8_t n) {
+  bool fits = true;
+  for (uint8_t i = 0; i < n; i++) {
+    const char* s = fld[i];
+    const float v = strtof(s, nullptr);
+    const long iv = strtol(s, nullptr, 10);
+    const uint8_t c = map[i];
+    switch (c) {
+      case C_T_MS: f.t_ms = (uint32_t)strtoul(s, nullptr, 10); break;
+      case C_TEST_ID: if (!metaSet(m.test_id, s)) fits = false; break;
+      case C_MOTOR_ID: if (!metaSet(m.motor_id, s)) fits = false; break;
+      case C_KV: m.kv = (int)iv; break;
+      case C_PROP: if (!metaSet(m.prop, s)) fits = false; break;
+      case C_BATTERY_S: m.battery_s = (int)iv; break;
+      case C_ESC_FW: if (!metaSet(m.esc_fw, s)) fits = false; break;
+      case C_POLE_PAIRS: m.pole_pairs = (uint8_t)iv; break;
+      case C_STEP_ID: f.step_id = (int32_t)iv; break;
+      case C_THROTTLE: f.throttle_pct = v; break;
+      case C_STEP_TIME: f.step_time_s = v; break;
+      case C_IS_STEADY: f.is_steady = (uint8_t)iv; break;
+      case C_ERPM: f.erpm = (uint32_t)iv; break;
+      case C_RPM: f.rpm = (uint32_t)iv; break;
+      case C_V_BUS: f.v_bus_V = v; break;
+      case C_I: f.i_A = v; break;
+      case C_P_IN: f.p_in_W = v; break;
+      case C_THRUST_N: f.thrust_N = v; break;
+      case C_THRUST_G: f.thrust_g = v; break;
+      case C_EFF_G_W: f.eff_g_per_W = v; break;
+      case C_EFF_N_W: f.eff_N_per_W = v; break;
+      case C_EFF_G_A: f.eff_g_per_A = v; break;
+      case C_BDSHOT_ERR: f.bdshot_err_pct = v; break;
+      case C_RPM_MEAN: f.rpm_mean = v; break;
+      case C_RPM_MIN: f.rpm_min = (uint32_t)iv; break;
+      case C_RPM_MAX: f.rpm_max = (uint32_t)iv; break;
+      case C_RPM_SP: f.rpm_sp = v; break;
+      case C_RPM_ERR: f.rpm_err = v; break;
+      default:
+        if (c >= C_AUX && c < C_NOTES) {
+          Frame::MotorAux& a = f.aux[(c - C_AUX) / 3];
+          const uint8_t k = (c - C_AUX) % 3;
+          if (k == 0) a.throttle_pct = v;
+          else if (k == 1) a.rpm = v;
+          else a.bdshot_err_pct = v;
+        }
+        break;
+    }
+  }
+  return fits;
+}
+
+// Steady flag as AutoTest sets it: the detector restarts with each step once the ramp is done
+// and flags the frame from the frames before it. The log does not record the ramp, so it counts
+// as done from the first frame of a level that the next frame repeats (throttle, or the RPM
+// setpoint in RPM steps); a step that starts at the previous level is done at once.
+static void regenSteady(Replay& r, Frame& f) {
+  const bool same_step = r.have_prev && f.step_id == r.prev.step_id;
+  if (!same_step) {
+    r.ramp_done = false;
+    r.det.reset();
+  }
+  if (f.step_id < 0) {
+    f.is_steady = 0;
+    return;
+  }
+  const float lvl = isfinite(f.rpm_sp) ? f.rpm_sp : f.throttle_pct;
+  const float prev_lvl = isfinite(r.prev.rpm_sp) ? r.prev.rpm_sp : r.prev.throttle_pct;
+  if (!r.ramp_done && r.have_prev && lvl == prev_lvl) {
+    r.ramp_done = true;
+    r.det.reset();
+    if (same_step) r.det.push(r.prev.thrust_g, frameRpm(r.prev), r.prev.i_A);
+  }
+  f.is_steady = (r.ramp_done && r.det.steady()) ? 1 : 0;
+  if (r.ramp_done) r.det.push(f.thrust_g, frameRpm(f), f.i_A);
+}
+
+// derived columns inherit the rounding of the recorded inputs they come from
+static double inputRel(Col c, const char* const* tok, const Frame& f) {
+  switch (c) {
+    case C_EFF_G_W: return relRound(tok[C_THRUST_G], f.thrust_g) + relRound(tok[C_P_IN], f.p_in_W);
+    case C_EFF_N_W: return relRound(tok[C_THRUST_N], f.thrust_N) + relRound(tok[C_P_IN], f.p_in_W);
+    case C_EFF_G_A: return relRound(tok[C_THRUST_G], f.thrust_g) + relRound(tok[C_I], f.i_A);
+    default: return 0.0;
+  }
+}
+
+static void replayFrame(Replay& r, char** fld) {
+  Frame f;
+  Meta m;
+  const char* tok[C_COUNT] = {};
+  if (!parseInto(f, m, fld, r.map, r.fields)) r.meta_cut++;
+  for (uint8_t i = 0; i < r.fields; i++) {
+    if (r.map[i] < C_COUNT) tok[r.map[i]] = fld[i];
+  }
+  const char* notes = tok[C_NOTES] ? tok[C_NOTES] : "NA";
+  const Frame rec = f;
+
+  // regenerate
+  r.esc.setPolePairs(m.pole_pairs);
+  if (r.erpm_samples) {
+    const EscRpmStats rs = r.esc.takeRpmStats();
+    f.rpm_mean = rs.n ? rs.rpm_mean : NAN;
+    f.rpm_min = rs.n ? rs.rpm_min : 0;
+    f.rpm_max = rs.n ? rs.rpm_max : 0;
+  }
+  f.eff_g_per_W = NAN;
+  f.eff_N_per_W = NAN;
+  f.eff_g_per_A = NAN;
+  frameDeriveEfficiency(f);
+  regenSteady(r, f);
+
+  printCsvFrame(f, m, notes);
+
+  // diff against the recorded tokens
+  for (uint8_t i = 0; i < r.fields; i++) {
+    for (uint8_t k = 0; k < REGEN_COUNT; k++) {
+      if (r.map[i] != REGEN[k]) continue;
+      if (k >= REGEN_RPM_FIRST && !r.erpm_samples) continue;
+      ColDiff& d = r.diff[k];
+      const double a = colValue(rec, REGEN[k]);
+      const double b = colValue(f, REGEN[k]);
+      d.n++;
+      const bool nan_a = !isfinite(a), nan_b = !isfinite(b);
+      if (nan_a && nan_b) continue;
+      const double ad = (nan_a || nan_b) ? INFINITY : fabs(a - b);
+      // float math on top of the inputs' rounding
+      const double rel = inputRel(REGEN[k], tok, rec) + 4.0 * FLT_EPSILON;
+      if (ad <= halfUlp(fld[i]) + fabs(b) * rel) continue;
+      if (d.diff++ == 0) {
+        d.first_t_ms = f.t_ms;
+        d.first_old = a;
+        d.first_new = b;
+      }
+      if (ad > d.max_abs) d.max_abs = ad;
+    }
+  }
+
+  r.prev = f;
+  r.have_prev = true;
+  r.frames++;
+}
+
+static void flushPending(Replay& r, char** fld) {
+  if (!r.have_pending) return;
+  r.have_pending = false;
+  splitFields(r.pending, fld, C_COUNT);
+  replayFrame(r, fld);
+}
+
+int replayRun(const char* path) {
+  FILE* in = fopen(path, "r");
+  if (!in) {
+    fprintf(stderr, "REPLAY cannot read %s\n", path);
+    return 2;
+  }
+  static Replay r;   // big (eRPM ring): not on the stack
+  char line[REPLAY_LINE_MAX];
+  char tmp[REPLAY_LINE_MAX];
+  char* fld[C_COUNT + 1];
+
+  while (fgets(line, sizeof(line), in)) {
+    char* s = stripPrefix(line);
+
+    // RPMSTREAM sample: RPM,<t_us>,<erpm>,<rpm>
+    if (strncmp(s, "RPM,", 4) == 0) {
+      char* end = nullptr;
+      const uint32_t t_us = (uint32_t)strtoul(s + 4, &end, 10);
+      if (!end || *end != ',') continue;
+      if (r.have_pending && (int32_t)(t_us - r.pending_end_us) > 0) flushPending(r, fld);
+      r.esc.acceptErpm(t_us, (uint32_t)strtoul(end + 1, nullptr, 10));
+      r.erpm_samples++;
+      continue;
+    }
+
+    strcpy(tmp, s);
+    const uint8_t n = splitFields(tmp, fld, C_COUNT);
+    if (n > C_COUNT) continue;
+    if (strcmp(fld[0], "t_ms") == 0) {
+      flushPending(r, fld);
+      mapHeader(r, fld, n);
+      continue;
+    }
+    // data row: numeric t_ms and the layout's field count (header, else 24 / 38 columns)
+    if (!fld[0][0] || strspn(fld[0], "0123456789") != strlen(fld[0])) continue;
+    if (!r.fields && (n == LEGACY_COLS || n == C_COUNT)) setLayout(r, n);
+    if (n != r.fields) continue;
+
+    flushPending(r, fld);
+    strcpy(r.pending, s);
+    r.have_pending = true;
+    // the frame's stats cover samples up to the end of its millisecond
+    r.pending_end_us = (uint32_t)strtoul(s, nullptr, 10) * 1000u + 999u;
+  }
+  flushPending(r, fld);
+  fclose(in);
+  fflush(stdout);
+
+  if (r.frames == 0) {
+    fprintf(stderr, "REPLAY %s: no frames\n", path);
+    return 2;
+  }
+  fprintf(stderr, "REPLAY %s: %lu frames, %u columns%s, %lu eRPM samples\n", path,
+          (unsigned long)r.frames, (unsigned)r.fields, r.header ? "" : " (no header)",
+          (unsigned long)r.erpm_samples);
+  if (r.meta_cut) {
+    fprintf(stderr, "  meta text cut to %u chars in %lu frames\n", (unsigned)META_TEXT_MAX,
+            (unsigned long)r.meta_cut);
+  }
+
+  uint8_t differ = 0;
+  for (uint8_t k = 0; k < REGEN_COUNT; k++) {
+    const ColDiff& d = r.diff[k];
+    if (d.n == 0) continue;
+    fprintf(stderr, "  %-12s %lu/%lu frames differ", COL_NAMES[REGEN[k]], (unsigned long)d.diff,
+            (unsigned long)d.n);
+    if (d.diff) {
+      differ++;
+      fprintf(stderr, "  first t_ms=%lu %g -> %g  max |d|=%g", (unsigned long)d.first_t_ms, d.first_old,
+              d.first_new, d.max_abs);
+    }
+    fputc('\n', stderr);
+  }
+  if (!differ) {
+    fprintf(stderr, "REPLAY OK\n");
+    return 0;
+  }
+  fprintf(stderr, "REPLAY DIFF %u column(s)\n", (unsigned)differ);
+  return 1;
+}
+
+#endif
@@ -20,33 +20,57 @@ bool SensorsIna226::begin(uint8_t addr, float shunt_ohms, float expected_max_cur
   return g_ina->begin();
 }
 
-InaSample SensorsIna226::read() {
+InaSample inaSampleFrom(float v_bus_V, float v_shunt_V, float shunt_ohms) {
   InaSample s;
-  if (!g_ina) return s;
-
-  const float v = g_ina->getBusVoltage(); // V
-
-  if (isnan(v) || v < VBAT_PRESENT_THRESHOLD_V) {
-    s.present = false;
-    s.v_bus_V = v;
-    s.i_A = NAN;
-    s.p_W = NAN;
-    return s;
-  }
+  s.v_bus_V = v_bus_V;
+  if (isnan(v_bus_V) || v_bus_V < VBAT_PRESENT_THRESHOLD_V) return s;
 
   s.present = true;
-  s.v_bus_V = v;
+  if (isnan(v_shunt_V)) return s;
 
   // Prefer current from shunt voltage: I = Vshunt / Rshunt
-  const float vsh = g_ina->getShuntVoltage(); // (should be in V in this lib)
-  if (isnan(vsh)) {
-    s.i_A = NAN;
-    s.p_W = NAN;
-    return s;
-  }
-
-  const float i = vsh / shunt_ohms_;
+  const float i = v_shunt_V / shunt_ohms;
   s.i_A = i;
-  s.p_W = v * i;
+  s.p_W = v_bus_V * i;
   return s;
 }
+
+InaSample SensorsIna226::read() {
+  if (!g_ina) return InaSample{};
+
+  const float v = g_ina->getBusVoltage(); // V
+  if (isnan(v) || v < VBAT_PRESENT_THRESHOLD_V) return inaSampleFrom(v, NAN, shunt_ohms_);
+
+  // shunt only with a supply present (should be in V in this lib)
+  return inaSampleFrom(v, g_ina->getShuntVoltage(), shunt_ohms_);
+}
+
+void SensorsIna226::setFastMode(bool fast) {
+  if (!g_ina) return;
+  g_ina->setAverage(INA226_1_SAMPLE);
+  g_ina->setBusVoltageConversionTime(fast ? INA226_140_us : INA226_1100_us);
+  g_ina->setShuntVoltageConversionTime(fast ? INA226_140_us : INA226_1100_us);
+}
+
+float SensorsIna226::readBusV() {
+  if (!g_ina) return NAN;
+  return g_ina->getBusVoltage();
+}
+
+bool SensorsIna226::setOverCurrentAlert(float i_max_A) {
+  if (!g_ina) return false;
+  if (!isfinite(i_max_A) || i_max_A <= 0.0f) return g_ina->setAlertRegister(0);
+
+  // shunt voltage limit register: 2.5 uV / LSB, signed 16 bit
+  float lsb = i_max_A * shunt_ohms_ / 2.5e-6f;
+  if (lsb > 32767.0f) lsb = 32767.0f;
+  if (!g_ina->setAlertLimit((uint16_t)lrintf(lsb))) return false;
+  return g_ina->setAlertRegister(INA226_SHUNT_OVER_VOLTAGE);
+}
+
+float SensorsIna226::readCurrentA() {
+  if (!g_ina) return NAN;
+  const float vsh = g_ina->getShuntVoltage();
+  if (isnan(vsh)) return NAN;
+  return vsh / shunt_ohms_;
+}
@@ -8,12 +8,26 @@ struct InaSample {
   float p_W = NAN;
 };
 
+// Bus + shunt voltage -> sample: supply present above VBAT_PRESENT_THRESHOLD_V, I = Vshunt / Rshunt,
+// P = V * I (NaN where an input is NaN)
+InaSample inaSampleFrom(float v_bus_V, float v_shunt_V, float shunt_ohms);
+
 class SensorsIna226 {
 public:
   // MUST match main.cpp call
   bool begin(uint8_t addr, float shunt_ohms, float expected_max_current_A);
   InaSample read();
 
+  // Fast mode: no averaging, shortest conversion times (~3.5 kHz) for step captures.
+  // Off = power-on defaults (1.1 ms conversions).
+  void setFastMode(bool fast);
+  float readCurrentA();   // shunt only (one register read), NaN if absent
+  float readBusV();       // bus only (one register read), NaN if absent
+
+  // Hardware over-current: ALERT asserts (open drain, low) while the shunt voltage is over
+  // i_max_A (transparent mode, checked every conversion). NaN / <= 0 disables it.
+  bool setOverCurrentAlert(float i_max_A);
+
   uint8_t addr() const { return addr_; }
 
 private:
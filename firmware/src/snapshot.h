@@ -0,0 +1,42 @@
+#pragma once
+#include <Arduino.h>
+#include <string.h>
+#include "frame.h"
+
+// Latest log frame, published by one writer (main loop) and read by any number of readers
+// (STATUS, STAT?/GET, batch gate, ...) on either RP2040 core. Seqlock: seq_ is odd while a
+// write is in progress; a reader copies the whole Frame and retries if seq_ was odd or moved.
+// No locks and no IRQ masking, so the writer never waits on a reader.
+class FrameSnapshot {
+public:
+  void publish(const Frame& f) {
+    seq_ = seq_ + 1;          // odd: writing
+    __sync_synchronize();
+    memcpy(&frame_, &f, sizeof(Frame));
+    __sync_synchronize();
+    seq_ = seq_ + 1;          // even: stable
+  }
+
+  // Consistent copy of the latest frame; false (out untouched) before the first publish or
+  // if the writer kept overlapping the copy.
+  bool read(Frame& out) const {
+    for (uint8_t tries = 0; tries < SNAPSHOT_READ_TRIES; tries++) {
+      const uint32_t s0 = seq_;
+      if (s0 == 0) return false;
+      if (s0 & 1u) continue;
+      __sync_synchronize();
+      memcpy(&out, &frame_, sizeof(Frame));
+      __sync_synchronize();
+      if (seq_ == s0) return true;
+    }
+    return false;
+  }
+
+  // frames published so far (changes once per log frame)
+  uint32_t frames() const { return seq_ >> 1; }
+
+private:
+  static constexpr uint8_t SNAPSHOT_READ_TRIES = 64;
+  volatile uint32_t seq_ = 0;
+  Frame frame_;
+};
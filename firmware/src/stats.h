@@ -0,0 +1,58 @@
+#pragma once
+#include <Arduino.h>
+#include <math.h>
+
+// Streaming mean/std/min/max (Welford), constant memory. NaN samples are skipped.
+struct RunningStat {
+  uint32_t n = 0;
+  float mean = 0.0f;
+  float m2 = 0.0f;
+  float min = NAN;
+  float max = NAN;
+
+  void reset() { *this = RunningStat{}; }
+
+  void push(float x) {
+    if (!isfinite(x)) return;
+    n++;
+    const float d = x - mean;
+    mean += d / (float)n;
+    m2 += d * (x - mean);
+    if (n == 1 || x < min) min = x;
+    if (n == 1 || x > max) max = x;
+  }
+
+  float meanOrNan() const { return n ? mean : NAN; }
+  float std() const { return (n > 1) ? sqrtf(m2 / (float)(n - 1)) : NAN; }
+};
+
+// Mean, sample std and least-squares drift (|slope| * span) of a full ring of n finite samples,
+// oldest at ring[head]. Used by the steady-state detector and the batch cooldown gate.
+struct WindowFit {
+  float mean = NAN;
+  float std = NAN;
+  float drift = NAN;
+};
+
+static inline WindowFit windowFit(const float* ring, uint8_t n, uint8_t head) {
+  WindowFit w;
+  if (n < 2) return w;
+
+  // x = 0..N-1 (oldest..newest), centred so sum(x) = 0
+  const float xm = ((float)n - 1.0f) * 0.5f;
+  float sum = 0.0f;
+  for (uint8_t k = 0; k < n; k++) sum += ring[k];
+  w.mean = sum / (float)n;
+
+  float var = 0.0f, sxx = 0.0f, sxy = 0.0f;
+  for (uint8_t k = 0; k < n; k++) {
+    const float x = (float)k - xm;
+    const float d = ring[(uint8_t)((head + k) % n)] - w.mean;  // oldest first
+    var += d * d;
+    sxx += x * x;
+    sxy += x * d;
+  }
+  w.std = sqrtf(var / ((float)n - 1.0f));
+  w.drift = fabsf(sxy / sxx) * ((float)n - 1.0f);
+  return w;
+}
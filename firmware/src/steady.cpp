@@ -0,0 +1,57 @@
+#include "steady.h"
+#include "stats.h"
+#include <math.h>
+
+static const float TOL_ABS[SteadyDetector::CH_COUNT] = {
+  STEADY_THRUST_TOL_G, STEADY_RPM_TOL, STEADY_CURRENT_TOL_A
+};
+static const float TOL_REL[SteadyDetector::CH_COUNT] = {
+  STEADY_THRUST_TOL_REL, STEADY_RPM_TOL_REL, STEADY_CURRENT_TOL_REL
+};
+
+void SteadyDetector::reset() {
+  head_ = 0;
+  count_ = 0;
+  usable_mask_ = 0;
+  steady_mask_ = 0;
+  for (uint8_t c = 0; c < CH_COUNT; c++) { std_[c] = NAN; drift_[c] = NAN; }
+}
+
+void SteadyDetector::push(float thrust_g, float rpm, float i_A) {
+  buf_[CH_THRUST][head_] = thrust_g;
+  buf_[CH_RPM][head_] = rpm;
+  buf_[CH_CURRENT][head_] = i_A;
+  head_ = (uint8_t)((head_ + 1) % STEADY_WIN);
+  if (count_ < STEADY_WIN) count_++;
+
+  if (full()) evaluate_();
+}
+
+void SteadyDetector::evaluate_() {
+  usable_mask_ = 0;
+  steady_mask_ = 0;
+  for (uint8_t c = 0; c < CH_COUNT; c++) {
+    uint8_t finite = 0;
+    for (uint8_t k = 0; k < STEADY_WIN; k++) {
+      if (isfinite(buf_[c][k])) finite++;
+    }
+    std_[c] = NAN;
+    drift_[c] = NAN;
+    if (finite == 0) continue;                 // sensor absent: ignore channel
+    usable_mask_ |= (uint8_t)(1u << c);
+    if (finite < STEADY_WIN) continue;         // dropouts: not steady
+
+    const WindowFit w = windowFit(buf_[c], STEADY_WIN, head_);
+    std_[c] = w.std;
+    drift_[c] = w.drift;
+
+    float tol = TOL_REL[c] * fabsf(w.mean);
+    if (tol < TOL_ABS[c]) tol = TOL_ABS[c];
+    if (std_[c] <= tol && drift_[c] <= tol) steady_mask_ |= (uint8_t)(1u << c);
+  }
+}
+
+bool SteadyDetector::steady() const {
+  if (!full() || usable_mask_ == 0) return false;
+  return (steady_mask_ & usable_mask_) == usable_mask_;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <Arduino.h>
+#include "cfg.h"
+
+// Rolling-window steady-state test on thrust, RPM and current (one sample per log frame).
+// A channel is steady when its std and its drift over the window (least-squares slope * span)
+// are both within max(abs_tol, rel_tol * |mean|). Channels that are NaN for the whole window
+// (sensor missing) are ignored; a partly-NaN channel is never steady.
+class SteadyDetector {
+public:
+  enum Channel : uint8_t { CH_THRUST = 0, CH_RPM = 1, CH_CURRENT = 2, CH_COUNT = 3 };
+
+  void reset();
+  void push(float thrust_g, float rpm, float i_A);
+
+  bool full() const { return count_ >= STEADY_WIN; }
+  // false until the window is full or when no channel is usable
+  bool steady() const;
+
+  // last evaluated per-channel figures (diagnostics)
+  float stdOf(Channel c) const { return std_[c]; }
+  float driftOf(Channel c) const { return drift_[c]; }
+
+private:
+  void evaluate_();
+
+private:
+  float buf_[CH_COUNT][STEADY_WIN]{};
+  uint8_t head_ = 0;
+  uint8_t count_ = 0;
+
+  float std_[CH_COUNT]{};
+  float drift_[CH_COUNT]{};
+  uint8_t usable_mask_ = 0;
+  uint8_t steady_mask_ = 0;
+};
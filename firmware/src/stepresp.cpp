@@ -0,0 +1,235 @@
+#include "stepresp.h"
+#include "esc_group.h"
+#include "sensors_ina226.h"
+#include "sensors_hx711.h"
+#include <math.h>
+
+static inline uint32_t ms_now() { return (uint32_t)millis(); }
+static inline uint32_t ms_age(uint32_t t0) { return (uint32_t)(ms_now() - t0); }
+
+static constexpr float STEPRESP_APPROACH_RAMP_S = 3.0f;
+static const char CH_TAG[StepResp::CH_COUNT] = { 'R', 'I', 'T' };
+
+void StepResp::Ring::push(uint32_t t_us, float v) {
+  buf[head].t_us = t_us;
+  buf[head].v = v;
+  head = (uint16_t)((head + 1) % len);
+  if (count < len) count++;
+}
+
+const SrPoint& StepResp::Ring::at(uint16_t i) const {
+  const uint16_t oldest = (uint16_t)((head + len - count) % len);
+  return buf[(oldest + i) % len];
+}
+
+bool StepResp::start(EscGroup& g, float from_pct, float to_pct) {
+  if (active()) return false;
+  if (!isfinite(from_pct) || !isfinite(to_pct)) return false;
+  if (from_pct < 0.0f || from_pct > 100.0f || to_pct < 0.0f || to_pct > 100.0f) return false;
+  if (fabsf(to_pct - from_pct) < 1.0f) return false;
+  if (g.isFailsafe()) return false;
+
+  ring_[CH_RPM].buf = rpm_buf_;        ring_[CH_RPM].len = STEPRESP_RPM_LEN;
+  ring_[CH_I].buf = i_buf_;            ring_[CH_I].len = STEPRESP_I_LEN;
+  ring_[CH_THRUST].buf = thrust_buf_;  ring_[CH_THRUST].len = STEPRESP_THRUST_LEN;
+  for (uint8_t c = 0; c < CH_COUNT; c++) { ring_[c].reset(); met_[c] = SrMetrics{}; }
+
+  from_pct_ = from_pct;
+  to_pct_ = to_pct;
+  err_ = "";
+  capture_done_ = false;
+  g.setTargetThrottlePct(from_pct_, STEPRESP_APPROACH_RAMP_S, RAMP_LINEAR);
+  phase_t0_ms_ = ms_now();
+  state_ = PREP;
+  return true;
+}
+
+void StepResp::abort(SensorsIna226* ina) {
+  if (!active()) return;
+  if (ina) ina->setFastMode(false);
+  err_ = "ABORT";
+  state_ = IDLE;
+}
+
+bool StepResp::takeCaptureDone() {
+  const bool d = capture_done_;
+  capture_done_ = false;
+  return d;
+}
+
+StepResp::State StepResp::takeResult() {
+  const State s = state_;
+  if (s == DONE || s == FAIL) state_ = IDLE;
+  return s;
+}
+
+void StepResp::fail_(SensorsIna226* ina, const char* why) {
+  if (ina) ina->setFastMode(false);
+  err_ = why;
+  capture_done_ = true;   // caller releases the motor
+  state_ = FAIL;
+}
+
+void StepResp::capture_(EscGroup& g, SensorsIna226* ina, SensorsHx711* hx) {
+  // RPM: drain the primary ESC's accepted eRPM history (full send rate)
+  EscBdshot& esc = g.primary();
+  const uint32_t head = esc.erpmHistSeq();
+  if ((uint32_t)(head - rpm_seq_) > ERPM_HIST_LEN) rpm_seq_ = head - ERPM_HIST_LEN;
+  const uint8_t pp = esc.polePairs();
+  ErpmSample s;
+  while (rpm_seq_ != head) {
+    if (esc.erpmHistAt(rpm_seq_, s)) ring_[CH_RPM].push(s.t_us, (float)s.erpm / (float)(pp ? pp : 1));
+    rpm_seq_++;
+  }
+
+  // current: fixed-rate shunt reads
+  const uint32_t now_us = (uint32_t)micros();
+  if (ina && (uint32_t)(now_us - last_ina_us_) >= STEPRESP_INA_PERIOD_US) {
+    last_ina_us_ = now_us;
+    ring_[CH_I].push(now_us, ina->readCurrentA());
+  }
+
+  // thrust: every new HX711 conversion
+  if (hx && hx->sampleCount() != hx_count_) {
+    hx_count_ = hx->sampleCount();
+    ring_[CH_THRUST].push(now_us, hx->calValid() ? hx->rawToGrams(hx->lastRaw()) : (float)hx->lastRaw());
+  }
+}
+
+void StepResp::computeMetrics_(const Ring& r, SrMetrics& m) const {
+  m = SrMetrics{};
+  const int32_t pre_us = -(int32_t)(STEPRESP_PRE_MS * 1000UL);
+  const int32_t tail_us = (int32_t)(STEPRESP_POST_MS * 800UL);   // last 20 % of the window
+
+  float s0 = 0.0f, sf = 0.0f;
+  uint16_t n0 = 0, nf = 0;
+  for (uint16_t i = 0; i < r.count; i++) {
+    const SrPoint& p = r.at(i);
+    if (!isfinite(p.v)) continue;
+    const int32_t t = (int32_t)(p.t_us - t_trig_us_);
+    if (t >= pre_us && t < 0) { s0 += p.v; n0++; }
+    if (t >= tail_us) { sf += p.v; nf++; }
+  }
+  if (n0 == 0 || nf == 0) return;
+  m.y0 = s0 / (float)n0;
+  m.yf = sf / (float)nf;
+
+  const float dy = m.yf - m.y0;
+  if (fabsf(dy) < 1e-6f) return;
+
+  int32_t t10 = -1, t90 = -1, t_out = -1;
+  float r_max = -INFINITY;
+  bool after_out = false;
+  for (uint16_t i = 0; i < r.count; i++) {
+    const SrPoint& p = r.at(i);
+    if (!isfinite(p.v)) continue;
+    const int32_t t = (int32_t)(p.t_us - t_trig_us_);
+    if (t < 0) continue;
+
+    const float rn = (p.v - m.y0) / dy;   // 0 -> 1 over the step
+    if (t10 < 0 && rn >= 0.1f) t10 = t;
+    if (t90 < 0 && rn >= 0.9f) t90 = t;
+    if (rn > r_max) r_max = rn;
+
+    // settling time = first sample after the last excursion out of the band
+    if (fabsf(rn - 1.0f) > STEPRESP_SETTLE_BAND) { t_out = t; after_out = true; }
+    else if (after_out) { t_out = t; after_out = false; }
+  }
+
+  if (t10 >= 0) m.delay_ms = (float)t10 * 0.001f;
+  if (t10 >= 0 && t90 >= 0) m.rise_ms = (float)(t90 - t10) * 0.001f;
+  if (isfinite(r_max)) m.overshoot_pct = (r_max > 1.0f) ? (r_max - 1.0f) * 100.0f : 0.0f;
+  if (!after_out) m.settle_ms = (t_out < 0) ? 0.0f : (float)t_out * 0.001f;   // NaN = never settled
+}
+
+void StepResp::streamSome_() {
+  if (!st_hdr_) {
+    Serial.print("SRHDR,ch,t_us,value  (R=RPM I=I_A T=thrust_g) from=");
+    Serial.print(from_pct_, 2); Serial.print(" to="); Serial.println(to_pct_, 2);
+    st_hdr_ = true;
+    return;
+  }
+
+  const int32_t pre_us = -(int32_t)(STEPRESP_PRE_MS * 1000UL);
+  uint8_t lines = 0;
+  while (st_ch_ < CH_COUNT && lines < STEPRESP_STREAM_PER_LOOP) {
+    const Ring& r = ring_[st_ch_];
+    if (st_idx_ >= r.count) { st_ch_++; st_idx_ = 0; continue; }
+
+    const SrPoint& p = r.at(st_idx_++);
+    const int32_t t = (int32_t)(p.t_us - t_trig_us_);
+    if (t < pre_us) continue;
+
+    Serial.print("SR,"); Serial.print(CH_TAG[st_ch_]); Serial.print(',');
+    Serial.print(t); Serial.print(',');
+    if (!isfinite(p.v)) Serial.println("NaN");
+    else Serial.println(p.v, (st_ch_ == CH_RPM) ? 0 : 3);
+    lines++;
+  }
+  if (st_ch_ < CH_COUNT) return;
+
+  for (uint8_t c = 0; c < CH_COUNT; c++) {
+    const SrMetrics& m = met_[c];
+    Serial.print("STEPRESP "); Serial.print(CH_TAG[c]);
+    Serial.print(" n="); Serial.print(ring_[c].count);
+    Serial.print(" y0="); if (isfinite(m.y0)) Serial.print(m.y0, 3); else Serial.print("NaN");
+    Serial.print(" yf="); if (isfinite(m.yf)) Serial.print(m.yf, 3); else Serial.print("NaN");
+    Serial.print(" delay_ms="); if (isfinite(m.delay_ms)) Serial.print(m.delay_ms, 1); else Serial.print("NaN");
+    Serial.print(" rise_ms="); if (isfinite(m.rise_ms)) Serial.print(m.rise_ms, 1); else Serial.print("NaN");
+    Serial.print(" overshoot_pct="); if (isfinite(m.overshoot_pct)) Serial.print(m.overshoot_pct, 1); else Serial.print("NaN");
+    Serial.print(" settle_ms="); if (isfinite(m.settle_ms)) Serial.println(m.settle_ms, 1); else Serial.println("NaN");
+  }
+  state_ = DONE;
+}
+
+void StepResp::tick(EscGroup& g, SensorsIna226* ina, SensorsHx711* hx) {
+  if (!active()) return;
+
+  if (state_ != STREAM && g.isFailsafe()) { fail_(ina, "FAILSAFE"); return; }
+
+  switch (state_) {
+    case PREP:
+      if (g.rampDone()) {
+        // start filling the pre-trigger rings
+        EscBdshot& esc = g.primary();
+        rpm_seq_ = esc.erpmHistSeq();
+        hx_count_ = hx ? hx->sampleCount() : 0;
+        last_ina_us_ = (uint32_t)micros();
+        if (ina) ina->setFastMode(true);
+        phase_t0_ms_ = ms_now();
+        state_ = SETTLE;
+      }
+      break;
+
+    case SETTLE:
+      capture_(g, ina, hx);
+      if (ms_age(phase_t0_ms_) >= STEPRESP_SETTLE_MS) {
+        // step: no ramp, takes effect at the next DShot frame
+        t_trig_us_ = (uint32_t)micros();
+        g.setTargetThrottlePct(to_pct_, 0.0f, RAMP_LINEAR);
+        phase_t0_ms_ = ms_now();
+        state_ = POST;
+      }
+      break;
+
+    case POST:
+      capture_(g, ina, hx);
+      if (ms_age(phase_t0_ms_) >= STEPRESP_POST_MS) {
+        if (ina) ina->setFastMode(false);
+        for (uint8_t c = 0; c < CH_COUNT; c++) computeMetrics_(ring_[c], met_[c]);
+        capture_done_ = true;
+        st_ch_ = 0;
+        st_idx_ = 0;
+        st_hdr_ = false;
+        state_ = STREAM;
+      }
+      break;
+
+    case STREAM:
+      streamSome_();
+      break;
+
+    default:
+      break;
+  }
+}
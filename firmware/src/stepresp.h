@@ -0,0 +1,86 @@
+#pragma once
+#include <Arduino.h>
+#include "cfg.h"
+
+class EscGroup;
+class SensorsIna226;
+class SensorsHx711;
+
+struct SrPoint {
+  uint32_t t_us = 0;   // micros() at capture
+  float v = NAN;
+};
+
+// Step metrics on one channel, times relative to the step (trigger).
+struct SrMetrics {
+  float y0 = NAN;             // mean before the step
+  float yf = NAN;             // mean over the last 20 % of the post window
+  float delay_ms = NAN;       // step -> 10 %
+  float rise_ms = NAN;        // 10 % -> 90 %
+  float overshoot_pct = NAN;  // peak beyond yf, % of the step
+  float settle_ms = NAN;      // step -> last exit from +/- STEPRESP_SETTLE_BAND
+};
+
+// STEPRESP: hold <from>, keep full-rate rings of RPM (every accepted eRPM decode),
+// current (INA226 fast mode) and thrust (every HX711 conversion), step to <to>,
+// fill the post-trigger window, then stream the block and the metrics out.
+// Non-blocking; the capture never allocates.
+class StepResp {
+public:
+  enum State : uint8_t { IDLE = 0, PREP = 1, SETTLE = 2, POST = 3, STREAM = 4, DONE = 5, FAIL = 6 };
+  enum Channel : uint8_t { CH_RPM = 0, CH_I = 1, CH_THRUST = 2, CH_COUNT = 3 };
+
+  bool start(EscGroup& g, float from_pct, float to_pct);
+  void abort(SensorsIna226* ina);
+  void tick(EscGroup& g, SensorsIna226* ina, SensorsHx711* hx);
+
+  bool active() const { return state_ >= PREP && state_ <= STREAM; }
+  // one-shot: capture finished (motor may be released)
+  bool takeCaptureDone();
+  // DONE/FAIL are reported once; returns the state and moves to IDLE
+  State takeResult();
+  const char* error() const { return err_; }
+  const SrMetrics& metrics(Channel c) const { return met_[c]; }
+
+private:
+  struct Ring {
+    SrPoint* buf = nullptr;
+    uint16_t len = 0;
+    uint16_t head = 0;
+    uint16_t count = 0;
+    void reset() { head = 0; count = 0; }
+    void push(uint32_t t_us, float v);
+    const SrPoint& at(uint16_t i) const;   // 0 = oldest
+  };
+
+  void capture_(EscGroup& g, SensorsIna226* ina, SensorsHx711* hx);
+  void fail_(SensorsIna226* ina, const char* why);
+  void computeMetrics_(const Ring& r, SrMetrics& m) const;
+  void streamSome_();
+
+private:
+  State state_ = IDLE;
+  const char* err_ = "";
+  float from_pct_ = 0.0f;
+  float to_pct_ = 0.0f;
+  uint32_t phase_t0_ms_ = 0;
+  uint32_t t_trig_us_ = 0;
+  bool capture_done_ = false;
+
+  // capture cursors
+  uint32_t rpm_seq_ = 0;
+  uint32_t hx_count_ = 0;
+  uint32_t last_ina_us_ = 0;
+
+  SrPoint rpm_buf_[STEPRESP_RPM_LEN];
+  SrPoint i_buf_[STEPRESP_I_LEN];
+  SrPoint thrust_buf_[STEPRESP_THRUST_LEN];
+  Ring ring_[CH_COUNT];
+
+  SrMetrics met_[CH_COUNT];
+
+  // streaming cursor: channel, index in ring, metrics printed
+  uint8_t st_ch_ = 0;
+  uint16_t st_idx_ = 0;
+  bool st_hdr_ = false;
+};
@@ -1,71 +1,352 @@
 #include "storage.h"
 #include <EEPROM.h>
+#include "crc.h"
+#include "textbuf.h"
 
-uint32_t CalStorage::crc32_ieee(const uint8_t *data, size_t len) {
-  uint32_t crc = 0xFFFFFFFFUL;
-  for (size_t i = 0; i < len; i++) {
-    crc ^= data[i];
-    for (int b = 0; b < 8; b++) {
-      uint32_t mask = -(crc & 1U);
-      crc = (crc >> 1) ^ (0xEDB88320UL & mask);
-    }
-  }
-  return ~crc;
-}
+CalStorage::ProgRec CalStorage::prog_rec_;
+CalStorage::BlobProgV1 CalStorage::prog_blob_;
+CalStorage::PresetRec CalStorage::preset_rec_;
 
 bool CalStorage::begin() {
-  EEPROM.begin(EEPROM_SIZE);
+  // several owners (HX711 cal, ESC throttle cal, programs) share one store
+  KvStore &kv = kvStore();
+  if (kv.mounted()) return true;
+  if (!kv.begin()) return false;
+  if (!kv.has(kvKey(KV_SCHEMA, 0))) migrateV1();
+  return true;
+}
+
+bool CalStorage::save(const CalData &cal, uint8_t cell) {
+  if (cell >= HX_CELLS) return false;
+  HxCalRec r{};
+  r.offset = cal.offset;
+  r.scale  = cal.scale;
+  r.invert = cal.invert ? 1 : 0;
+  r.valid  = cal.valid ? 1 : 0;
+  return kvStore().put(kvKey(KV_HXCAL, cell), HXCAL_VER, &r, sizeof(r));
+}
+
+bool CalStorage::load(CalData &cal, uint8_t cell) {
+  if (cell >= HX_CELLS) return false;
+  HxCalRec r{};
+  uint16_t len = 0;
+  uint8_t ver = 0;
+  if (!kvStore().get(kvKey(KV_HXCAL, cell), &r, sizeof(r), &len, &ver)) return false;
+  if (ver != HXCAL_VER || len != sizeof(r)) return false;
+
+  cal.offset = r.offset;
+  cal.scale  = r.scale;
+  cal.invert = (r.invert != 0);
+  cal.valid  = (r.valid != 0);
   return true;
 }
 
-bool CalStorage::save(const CalData &cal) {
-  BlobV1 b{};
-  b.magic   = MAGIC;
-  b.version = VERSION;
-  b.size    = sizeof(BlobV1);
-  b.offset  = cal.offset;
-  b.scale   = cal.scale;
-  b.invert  = cal.invert ? 1 : 0;
-  b.valid   = cal.valid ? 1 : 0;
+bool CalStorage::reset(uint8_t cell) {
+  // this load cell only; throttle calibration and programs are kept
+  if (cell >= HX_CELLS) return false;
+  return kvStore().erase(kvKey(KV_HXCAL, cell));
+}
+
+void CalStorage::thrToRec(const ThrCalData &tc, ThrCalRec &r) {
+  r.start_dshot = tc.start_dshot;
+  for (uint8_t i = 0; i < ThrCalData::RPM_PTS; i++) r.rpm_at[i] = tc.rpm_at[i];
+  r.valid = tc.valid ? 1 : 0;
+  r.rsvd = 0;
+}
+
+void CalStorage::thrFromRec(const ThrCalRec &r, ThrCalData &tc) {
+  tc.valid = (r.valid != 0);
+  tc.start_dshot = r.start_dshot;
+  for (uint8_t i = 0; i < ThrCalData::RPM_PTS; i++) tc.rpm_at[i] = r.rpm_at[i];
+}
+
+bool CalStorage::saveThrCal(uint8_t slot, const ThrCalData &tc) {
+  if (slot >= THRCAL_SLOTS) return false;
+  ThrCalRec r{};
+  thrToRec(tc, r);
+  return kvStore().put(kvKey(KV_THRCAL, slot), THRCAL_VER, &r, sizeof(r));
+}
+
+bool CalStorage::loadThrCal(uint8_t slot, ThrCalData &tc) {
+  if (slot >= THRCAL_SLOTS) return false;
+  ThrCalRec r{};
+  uint16_t len = 0;
+  uint8_t ver = 0;
+  if (!kvStore().get(kvKey(KV_THRCAL, slot), &r, sizeof(r), &len, &ver)) return false;
+  if (ver != THRCAL_VER || len != sizeof(r)) return false;
+
+  thrFromRec(r, tc);
+  return true;
+}
 
-  b.crc32 = 0;
-  b.crc32 = crc32_ieee(reinterpret_cast<const uint8_t*>(&b),
-                       sizeof(BlobV1) - sizeof(uint32_t));
+static uint16_t toDs(float s) {
+  long v = lrintf(s * 10.0f);
+  if (v < 0) v = 0;
+  if (v > 0xFFFF) v = 0xFFFF;
+  return (uint16_t)v;
+}
 
-  if (sizeof(BlobV1) > EEPROM_SIZE) return false;
+bool CalStorage::readProg(uint8_t slot, ProgRec &r) {
+  if (slot >= PROG_SLOTS) return false;
+  uint16_t len = 0;
+  uint8_t ver = 0;
+  if (!kvStore().get(kvKey(KV_PROG, slot), &r, sizeof(r), &len, &ver)) return false;
+  if (ver != PROG_VER || len < PROG_REC_HDR) return false;
+  if (r.count == 0 || r.count > AtProgram::MAX_STEPS) return false;
+  if (len != PROG_REC_HDR + r.count * sizeof(ProgStepV1)) return false;
 
-  const uint8_t *p = reinterpret_cast<const uint8_t*>(&b);
-  for (size_t i = 0; i < sizeof(BlobV1); i++) EEPROM.write(EEPROM_ADDR + (int)i, p[i]);
-  EEPROM.commit();
+  r.name[AtProgram::NAME_LEN - 1] = '\0';
   return true;
 }
 
-bool CalStorage::load(CalData &cal) {
-  if (sizeof(BlobV1) > EEPROM_SIZE) return false;
+bool CalStorage::writeProg(uint8_t slot, const ProgRec &r) {
+  const uint16_t len = (uint16_t)(PROG_REC_HDR + r.count * sizeof(ProgStepV1));
+  return kvStore().put(kvKey(KV_PROG, slot), PROG_VER, &r, len);
+}
+
+bool CalStorage::saveProgram(const AtProgram &p) {
+  if (p.count == 0 || p.count > AtProgram::MAX_STEPS) return false;
 
-  BlobV1 b{};
-  uint8_t *p = reinterpret_cast<uint8_t*>(&b);
-  for (size_t i = 0; i < sizeof(BlobV1); i++) p[i] = EEPROM.read(EEPROM_ADDR + (int)i);
+  // same name -> overwrite, else first free (or unreadable) slot
+  ProgRec &r = prog_rec_;
+  int slot = -1;
+  int free_slot = -1;
+  for (uint8_t i = 0; i < PROG_SLOTS; i++) {
+    if (!readProg(i, r)) { if (free_slot < 0) free_slot = i; continue; }
+    if (strncmp(r.name, p.name, AtProgram::NAME_LEN) == 0) { slot = i; break; }
+  }
+  if (slot < 0) slot = free_slot;
+  if (slot < 0) return false;
 
-  if (b.magic != MAGIC) return false;
-  if (b.version != VERSION) return false;
-  if (b.size != sizeof(BlobV1)) return false;
+  memset(&r, 0, sizeof(r));
+  textCopy(r.name, p.name);
+  r.count = p.count;
+  for (uint8_t i = 0; i < p.count; i++) {
+    const AtStep &s = p.steps[i];
+    r.steps[i].value = s.value;
+    r.steps[i].ramp_ds = toDs(s.ramp_s);
+    r.steps[i].hold_ds = toDs(s.hold_s);
+    if (r.steps[i].hold_ds == 0) r.steps[i].hold_ds = 1;
+    r.steps[i].type = s.type;
+    r.steps[i].prof = s.prof;
+  }
+  return writeProg((uint8_t)slot, r);
+}
 
-  uint32_t crc = b.crc32;
-  b.crc32 = 0;
-  uint32_t calc = crc32_ieee(reinterpret_cast<const uint8_t*>(&b),
-                             sizeof(BlobV1) - sizeof(uint32_t));
-  if (crc != calc) return false;
+bool CalStorage::loadProgramSlot(uint8_t slot, AtProgram &p) {
+  ProgRec &r = prog_rec_;
+  if (!readProg(slot, r)) return false;
 
-  cal.offset = b.offset;
-  cal.scale  = b.scale;
-  cal.invert = (b.invert != 0);
-  cal.valid  = (b.valid != 0);
+  atProgramSetName(p, r.name);
+  p.count = r.count;
+  for (uint8_t i = 0; i < r.count; i++) {
+    AtStep &s = p.steps[i];
+    s.value = r.steps[i].value;
+    s.ramp_s = (float)r.steps[i].ramp_ds * 0.1f;
+    s.hold_s = (float)r.steps[i].hold_ds * 0.1f;
+    s.type = r.steps[i].type;
+    s.prof = r.steps[i].prof;
+  }
   return true;
 }
 
-bool CalStorage::reset() {
-  for (int i = 0; i < (int)EEPROM_SIZE; i++) EEPROM.write(i, 0xFF);
-  EEPROM.commit();
+bool CalStorage::loadProgram(const char *name, AtProgram &p) {
+  if (!name) return false;
+  for (uint8_t i = 0; i < PROG_SLOTS; i++) {
+    if (!loadProgramSlot(i, p)) continue;
+    if (strncmp(p.name, name, AtProgram::NAME_LEN) == 0) return true;
+  }
+  return false;
+}
+
+bool CalStorage::deleteProgram(const char *name) {
+  if (!name) return false;
+  ProgRec &r = prog_rec_;
+  for (uint8_t i = 0; i < PROG_SLOTS; i++) {
+    if (!readProg(i, r)) continue;
+    if (strncmp(r.name, name, AtProgram::NAME_LEN) != 0) continue;
+    return kvStore().erase(kvKey(KV_PROG, i));
+  }
+  return false;
+}
+
+// ---------------- presets ----------------
+
+// FNV-1a: spreads similar names ("2306_a", "2306_b") over the slots
+static uint8_t presetHome(const char *name) {
+  uint32_t h = 2166136261UL;
+  for (const char *c = name; *c; c++) h = (h ^ (uint8_t)*c) * 16777619UL;
+  return (uint8_t)(h % CalStorage::PRESET_SLOTS);
+}
+
+bool CalStorage::readPreset(uint8_t slot, PresetRec &r, bool &tomb) {
+  tomb = false;
+  uint16_t len = 0;
+  uint8_t ver = 0;
+  if (!kvStore().get(kvKey(KV_PRESET, slot), &r, sizeof(r), &len, &ver)) return false;
+  if (ver != PRESET_VER || len != sizeof(r)) return false;
+  r.name[PresetData::NAME_LEN - 1] = '\0';
+  tomb = (r.name[0] == '\0');
   return true;
 }
+
+int CalStorage::findPreset(const char *name, int *free_slot) {
+  if (free_slot) *free_slot = -1;
+  if (!name || !name[0]) return -1;
+
+  PresetRec &r = preset_rec_;
+  const uint8_t home = presetHome(name);
+  for (uint8_t k = 0; k < PRESET_SLOTS; k++) {
+    const uint8_t slot = (uint8_t)((home + k) % PRESET_SLOTS);
+    bool tomb = false;
+    if (!readPreset(slot, r, tomb)) {
+      // never used (or unreadable): end of the chain
+      if (free_slot && *free_slot < 0) *free_slot = slot;
+      return -1;
+    }
+    if (tomb) { if (free_slot && *free_slot < 0) *free_slot = slot; continue; }
+    if (strncmp(r.name, name, PresetData::NAME_LEN) == 0) return slot;
+  }
+  return -1;
+}
+
+bool CalStorage::savePreset(const PresetData &p) {
+  if (!atProgramNameValid(p.name)) return false;
+  int free_slot = -1;
+  int slot = findPreset(p.name, &free_slot);
+  if (slot < 0) slot = free_slot;
+  if (slot < 0) return false;
+
+  PresetRec &r = preset_rec_;
+  memset(&r, 0, sizeof(r));
+  textCopy(r.name, p.name);
+  textCopy(r.motor_id, p.motor_id);
+  textCopy(r.prop, p.prop);
+  textCopy(r.esc_fw, p.esc_fw);
+  r.kv = p.kv;
+  r.battery_s = (int16_t)p.battery_s;
+  r.pole_pairs = p.pole_pairs;
+  r.esc_count = p.esc_count;
+  for (uint8_t i = 0; i < ESC_COUNT_MAX; i++) thrToRec(p.thr[i], r.thr[i]);
+  return kvStore().put(kvKey(KV_PRESET, (uint8_t)slot), PRESET_VER, &r, sizeof(r));
+}
+
+bool CalStorage::loadPresetSlot(uint8_t slot, PresetData &p) {
+  if (slot >= PRESET_SLOTS) return false;
+  PresetRec &r = preset_rec_;
+  bool tomb = false;
+  if (!readPreset(slot, r, tomb) || tomb) return false;
+
+  textCopy(p.name, r.name);
+  textCopy(p.motor_id, r.motor_id);
+  textCopy(p.prop, r.prop);
+  textCopy(p.esc_fw, r.esc_fw);
+  p.kv = (int)r.kv;
+  p.battery_s = (int)r.battery_s;
+  p.pole_pairs = r.pole_pairs;
+  p.esc_count = r.esc_count;
+  for (uint8_t i = 0; i < ESC_COUNT_MAX; i++) thrFromRec(r.thr[i], p.thr[i]);
+  return true;
+}
+
+bool CalStorage::loadPreset(const char *name, PresetData &p) {
+  const int slot = findPreset(name, nullptr);
+  return slot >= 0 && loadPresetSlot((uint8_t)slot, p);
+}
+
+bool CalStorage::deletePreset(const char *name) {
+  const int slot = findPreset(name, nullptr);
+  if (slot < 0) return false;
+  PresetRec &r = preset_rec_;
+  memset(&r, 0, sizeof(r));
+  return kvStore().put(kvKey(KV_PRESET, (uint8_t)slot), PRESET_VER, &r, sizeof(r));
+}
+
+bool CalStorage::setActivePreset(const char *name) {
+  const uint16_t key = kvKey(KV_PRESET, PRESET_ACTIVE_SLOT);
+  if (!name || !name[0]) return kvStore().erase(key);
+  char buf[PresetData::NAME_LEN]{};
+  textCopy(buf, name);
+  return kvStore().put(key, PRESET_VER, buf, sizeof(buf));
+}
+
+bool CalStorage::activePreset(char (&name)[PresetData::NAME_LEN]) {
+  name[0] = '\0';
+  uint16_t len = 0;
+  if (!kvStore().get(kvKey(KV_PRESET, PRESET_ACTIVE_SLOT), name, sizeof(name), &len)) return false;
+  name[PresetData::NAME_LEN - 1] = '\0';
+  return len == sizeof(name) && name[0] != '\0';
+}
+
+// ---------------- BlobV1 (EEPROM emulation) migration ----------------
+
+bool CalStorage::readBlobV1(int addr, void *blob, size_t size, uint32_t magic) {
+  if (addr + size > EEPROM_SIZE) return false;
+  uint8_t *p = reinterpret_cast<uint8_t*>(blob);
+  for (size_t i = 0; i < size; i++) p[i] = EEPROM.read(addr + (int)i);
+
+  // every V1 blob: magic, version, size first, crc32 of the rest last
+  uint32_t m, crc;
+  uint16_t ver, sz;
+  memcpy(&m, p, 4);
+  memcpy(&ver, p + 4, 2);
+  memcpy(&sz, p + 6, 2);
+  memcpy(&crc, p + size - 4, 4);
+  if (m != magic || ver != VERSION || sz != size) return false;
+
+  memset(p + size - 4, 0, 4);
+  return crc == crc32Ieee(p, size - sizeof(uint32_t));
+}
+
+void CalStorage::migrateV1() {
+  KvStore &kv = kvStore();
+  uint8_t n = 0;
+
+  // records are flushed one by one: the queue is smaller than the old layout (boot, motor stopped)
+  EEPROM.begin(EEPROM_SIZE);
+
+  BlobV1 b;
+  if (readBlobV1(EEPROM_ADDR, &b, sizeof(b), MAGIC)) {
+    CalData cal;
+    cal.offset = b.offset;
+    cal.scale  = b.scale;
+    cal.invert = (b.invert != 0);
+    cal.valid  = (b.valid != 0);
+    if (save(cal, 0)) n++;
+    kv.service(true);
+  }
+
+  BlobThrV1 t;
+  for (uint8_t s = 0; s < V1_THRCAL_SLOTS; s++) {
+    if (!readBlobV1(EEPROM_ADDR_THRCAL + (int)s * (int)sizeof(BlobThrV1), &t, sizeof(t), MAGIC_THRCAL)) continue;
+    ThrCalData tc;
+    tc.valid = (t.valid != 0);
+    tc.start_dshot = t.start_dshot;
+    for (uint8_t i = 0; i < ThrCalData::RPM_PTS; i++) tc.rpm_at[i] = t.rpm_at[i];
+    if (saveThrCal(s, tc)) n++;
+    kv.service(true);
+  }
+
+  BlobProgV1 &pb = prog_blob_;
+  for (uint8_t s = 0; s < V1_PROG_SLOTS; s++) {
+    if (!readBlobV1(EEPROM_ADDR_PROG + (int)s * (int)sizeof(BlobProgV1), &pb, sizeof(pb), MAGIC_PROG)) continue;
+    if (pb.count == 0 || pb.count > AtProgram::MAX_STEPS) continue;
+    ProgRec &r = prog_rec_;
+    memset(&r, 0, sizeof(r));
+    memcpy(r.name, pb.name, AtProgram::NAME_LEN);
+    r.name[AtProgram::NAME_LEN - 1] = '\0';
+    r.count = pb.count;
+    memcpy(r.steps, pb.steps, pb.count * sizeof(ProgStepV1));
+    if (writeProg(s, r)) n++;
+    kv.service(true);
+  }
+
+  EEPROM.end();
+
+  // marker: never migrate again (the old EEPROM sector is left as it was)
+  const uint16_t schema = 2;
+  kv.put(kvKey(KV_SCHEMA, 0), 1, &schema, sizeof(schema));
+  kv.service(true);
+
+  if (n) { Serial.print("OK STORE migrated "); Serial.print(n); Serial.println(" BlobV1 records"); }
+}
@@ -1,5 +1,7 @@
 #pragma once
 #include <Arduino.h>
+#include "program.h"
+#include "kvstore.h"
 
 struct CalData {
   int32_t offset = 0;
@@ -8,18 +10,148 @@ struct CalData {
   bool    valid  = false;
 };
 
+// Per-ESC throttle calibration (THRCAL): >0 % starts at spin-up, expected RPM per 5 %.
+struct ThrCalData {
+  static constexpr uint8_t RPM_PTS = 21;  // 0, 5, .., 100 %
+  bool     valid = false;
+  uint16_t start_dshot = 0;               // library units (0..DSHOT_MAX)
+  uint16_t rpm_at[RPM_PTS]{};             // expected RPM, 0 = not measured
+};
+
+// Named rig preset (PRESET): motor / prop / ESC metadata, ESC count, pole pairs and the
+// throttle calibration of every ESC, applied together by PRESET LOAD. test_id stays per run.
+struct PresetData {
+  static constexpr uint8_t NAME_LEN = AtProgram::NAME_LEN;   // same rules as PROG names
+  static constexpr uint8_t FIELD_LEN = 24;                   // = Meta::FIELD_LEN
+  char     name[NAME_LEN]{};
+  char     motor_id[FIELD_LEN]{};
+  int      kv = -1;
+  char     prop[FIELD_LEN]{};
+  int      battery_s = -1;
+  char     esc_fw[FIELD_LEN]{};
+  uint8_t  pole_pairs = 7;
+  uint8_t  esc_count = 1;
+  ThrCalData thr[ESC_COUNT_MAX];
+};
+
+// Typed records on top of the flash key/value store (kvStore()). Saves are queued and reach
+// flash once the rig is disarmed and stopped; loads see them at once. The first begin() after an update
+// copies the old BlobV1 EEPROM layout into the store.
 class CalStorage {
 public:
   bool begin();
-  bool save(const CalData &cal);
-  bool load(CalData &cal);
-  bool reset();
+
+  // load cell calibration, one slot per load cell
+  static constexpr uint8_t HX_CELLS = 4;
+  bool save(const CalData &cal, uint8_t cell = 0);
+  bool load(CalData &cal, uint8_t cell = 0);
+  bool reset(uint8_t cell = 0);
+
+  // throttle calibration, one slot per ESC
+  static constexpr uint8_t THRCAL_SLOTS = 4;
+  bool saveThrCal(uint8_t slot, const ThrCalData &tc);
+  bool loadThrCal(uint8_t slot, ThrCalData &tc);
+
+  // named autotest programs (PROG), fixed slots; times stored in 0.1 s
+  static constexpr uint8_t PROG_SLOTS = 8;
+  bool saveProgram(const AtProgram &p);   // overwrites same name, else first free slot
+  bool loadProgram(const char *name, AtProgram &p);
+  bool loadProgramSlot(uint8_t slot, AtProgram &p);
+  bool deleteProgram(const char *name);
+
+  // named presets: slot = hash(name), linear probing, so a load is one record read unless
+  // names collide; deleted presets leave a tombstone to keep probe chains intact
+  static constexpr uint8_t PRESET_SLOTS = 16;
+  bool savePreset(const PresetData &p);   // overwrites same name
+  bool loadPreset(const char *name, PresetData &p);
+  bool loadPresetSlot(uint8_t slot, PresetData &p);
+  bool deletePreset(const char *name);
+  // preset applied at boot ("" = none)
+  bool setActivePreset(const char *name);
+  bool activePreset(char (&name)[PresetData::NAME_LEN]);
 
 private:
+  // store records (value layouts, version = record ver)
+  static constexpr uint8_t HXCAL_VER = 1;
+  static constexpr uint8_t THRCAL_VER = 1;
+  static constexpr uint8_t PROG_VER = 1;
+  static constexpr uint8_t PRESET_VER = 1;
+  static constexpr uint8_t PRESET_ACTIVE_SLOT = 0xFF;   // KV_PRESET slot of the boot preset name
+
+  struct HxCalRec {
+    int32_t offset;
+    float   scale;
+    uint8_t invert;
+    uint8_t valid;
+    uint8_t rsvd[2];
+  };
+
+  struct ThrCalRec {
+    uint16_t start_dshot;
+    uint16_t rpm_at[ThrCalData::RPM_PTS];
+    uint8_t  valid;
+    uint8_t  rsvd;
+  };
+
+  static void thrToRec(const ThrCalData &tc, ThrCalRec &r);
+  static void thrFromRec(const ThrCalRec &r, ThrCalData &tc);
+
+  struct ProgStepV1 {
+    float    value;
+    uint16_t ramp_ds;
+    uint16_t hold_ds;
+    uint8_t  type;
+    uint8_t  prof;
+    uint8_t  rsvd0;
+    uint8_t  rsvd1;
+  };
+
+  // stored with only `count` steps
+  struct ProgRec {
+    char     name[AtProgram::NAME_LEN];
+    uint8_t  count;
+    uint8_t  rsvd[3];
+    ProgStepV1 steps[AtProgram::MAX_STEPS];
+  };
+  static constexpr uint16_t PROG_REC_HDR = (uint16_t)offsetof(ProgRec, steps);
+  static_assert(sizeof(ProgRec) <= KvStore::VALUE_MAX, "ProgRec exceeds a store record");
+
+  // name[0] == 0: tombstone
+  struct PresetRec {
+    char     name[PresetData::NAME_LEN];
+    char     motor_id[PresetData::FIELD_LEN];
+    char     prop[PresetData::FIELD_LEN];
+    char     esc_fw[PresetData::FIELD_LEN];
+    int32_t  kv;
+    int16_t  battery_s;
+    uint8_t  pole_pairs;
+    uint8_t  esc_count;
+    ThrCalRec thr[ESC_COUNT_MAX];
+  };
+  static_assert(sizeof(PresetRec) <= KvStore::VALUE_MAX, "PresetRec exceeds a store record");
+  static_assert(PRESET_SLOTS < PRESET_ACTIVE_SLOT, "preset slots overlap the boot preset key");
+
+  bool readPreset(uint8_t slot, PresetRec &r, bool &tomb);
+  // probe chain of name: found slot, else first reusable slot (-1 if none) in free_slot
+  int findPreset(const char *name, int *free_slot);
+  static PresetRec preset_rec_;
+
+  bool readProg(uint8_t slot, ProgRec &r);
+  bool writeProg(uint8_t slot, const ProgRec &r);
+  static ProgRec prog_rec_;       // ~800 B scratch, kept off the stack
+
+  // --- legacy EEPROM emulation layout (schema 1), read once by migrateV1() ---
   static constexpr uint32_t MAGIC   = 0x48583731UL; // "HX71"
   static constexpr uint16_t VERSION = 1;
-  static constexpr size_t EEPROM_SIZE = 128;
+  static constexpr size_t EEPROM_SIZE = 4096;
   static constexpr int EEPROM_ADDR = 0;
+  static constexpr int EEPROM_ADDR_THRCAL = 64;
+  static constexpr int EEPROM_ADDR_PROG = 512;
+  static constexpr uint8_t V1_THRCAL_SLOTS = 4;
+  static constexpr uint8_t V1_PROG_SLOTS = 4;
+
+  static constexpr uint32_t MAGIC_THRCAL = 0x54484331UL; // "THC1"
+  static constexpr uint32_t MAGIC_PROG   = 0x50524731UL; // "PRG1"
 
   struct BlobV1 {
     uint32_t magic;
@@ -34,5 +166,33 @@ private:
     uint32_t crc32;
   };
 
-  static uint32_t crc32_ieee(const uint8_t *data, size_t len);
+  struct BlobThrV1 {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    uint16_t start_dshot;
+    uint16_t rpm_at[ThrCalData::RPM_PTS];
+    uint8_t  valid;
+    uint8_t  rsvd0;
+    uint32_t crc32;
+  };
+
+  struct BlobProgV1 {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    char     name[AtProgram::NAME_LEN];
+    uint8_t  count;
+    uint8_t  rsvd[3];
+    ProgStepV1 steps[AtProgram::MAX_STEPS];
+    uint32_t crc32;
+  };
+
+  static_assert(CalStorage::THRCAL_SLOTS >= V1_THRCAL_SLOTS, "THRCAL slots lost in migration");
+  static_assert(CalStorage::PROG_SLOTS >= V1_PROG_SLOTS, "PROG slots lost in migration");
+
+  void migrateV1();
+  // magic / version / size header and trailing crc32 of a legacy blob
+  static bool readBlobV1(int addr, void *blob, size_t size, uint32_t magic);
+  static BlobProgV1 prog_blob_;   // migration scratch
 };
@@ -0,0 +1,39 @@
+#include "sweep.h"
+#include <math.h>
+
+void SweepHysteresis::reset() {
+  memset(sum_, 0, sizeof(sum_));
+  memset(cnt_, 0, sizeof(cnt_));
+  memset(n_, 0, sizeof(n_));
+}
+
+void SweepHysteresis::push(uint8_t leg, float throttle_pct, float thrust_g, float rpm, float i_A) {
+  if (leg > 1 || !isfinite(throttle_pct)) return;
+  const long b = lrintf(throttle_pct);
+  if (b < 0 || b >= BINS) return;
+  if (n_[leg][b] == 0xFFFF) return;
+
+  const float v[CH_COUNT] = { thrust_g, rpm, i_A };
+  for (uint8_t c = 0; c < CH_COUNT; c++) {
+    if (!isfinite(v[c])) continue;
+    sum_[leg][b][c] += v[c];
+    cnt_[leg][b][c]++;
+  }
+  n_[leg][b]++;
+}
+
+float SweepHysteresis::mean(uint8_t leg, uint8_t bin, Channel c) const {
+  if (leg > 1 || bin >= BINS || cnt_[leg][bin][c] == 0) return NAN;
+  return sum_[leg][bin][c] / (float)cnt_[leg][bin][c];
+}
+
+float SweepHysteresis::maxDiff(Channel c, int& bin) const {
+  float best = NAN;
+  bin = -1;
+  for (uint8_t b = 0; b < BINS; b++) {
+    const float d = fabsf(mean(0, b, c) - mean(1, b, c));
+    if (!isfinite(d)) continue;
+    if (!isfinite(best) || d > best) { best = d; bin = b; }
+  }
+  return best;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <Arduino.h>
+
+// Up/down sweep hysteresis: thrust, RPM and current binned by throttle (1 % bins)
+// separately for the first leg and the return leg. Constant memory.
+class SweepHysteresis {
+public:
+  static constexpr uint8_t BINS = 101;     // 0..100 %
+  enum Channel : uint8_t { CH_THRUST = 0, CH_RPM = 1, CH_I = 2, CH_COUNT = 3 };
+
+  void reset();
+  void push(uint8_t leg, float throttle_pct, float thrust_g, float rpm, float i_A);
+
+  // mean of a channel in a bin for a leg (NaN if the bin saw no sample)
+  float mean(uint8_t leg, uint8_t bin, Channel c) const;
+  bool binHasBoth(uint8_t bin) const { return n_[0][bin] > 0 && n_[1][bin] > 0; }
+
+  // largest |leg0 - leg1| over bins seen on both legs; bin = -1 if none
+  float maxDiff(Channel c, int& bin) const;
+
+private:
+  float sum_[2][BINS][CH_COUNT]{};
+  uint16_t cnt_[2][BINS][CH_COUNT]{};
+  uint16_t n_[2][BINS]{};
+};
@@ -0,0 +1,18 @@
+#pragma once
+#include <Arduino.h>
+
+// Copy src into an n-byte text field, always terminated (nullptr = ""). False if src is
+// longer than n-1 chars: the field then holds the first n-1. Use this, not strncpy: it leaves
+// a cut field unterminated.
+static inline bool textCopy(char* dst, size_t n, const char* src) {
+  if (!src) src = "";
+  const size_t len = strnlen(src, n);
+  const bool fits = len < n;
+  const size_t k = fits ? len : n - 1;
+  memcpy(dst, src, k);
+  dst[k] = '\0';
+  return fits;
+}
+
+template <size_t N>
+static inline bool textCopy(char (&dst)[N], const char* src) { return textCopy(dst, N, src); }
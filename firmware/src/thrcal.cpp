@@ -0,0 +1,147 @@
+#include "thrcal.h"
+#include <math.h>
+
+static inline uint32_t ms_now() { return (uint32_t)millis(); }
+
+bool ThrottleCal::start(EscGroup& g, uint8_t motor, float max_pct) {
+  if (active() || motor >= g.count()) return false;
+  if (!isfinite(max_pct)) return false;
+  if (max_pct < 10.0f) max_pct = 10.0f;
+  if (max_pct > 100.0f) max_pct = 100.0f;
+
+  EscBdshot& m = g.motor(motor);
+  if (m.isFailsafe() || m.currentThrottlePct() > 0.5f) return false;  // sweep must start from stop
+
+  motor_ = motor;
+  max_pct_ = max_pct;
+  err_ = "";
+  spun_ = false;
+  spin_t0_ms_ = 0;
+  spin_cand_pct_ = NAN;
+  spin_pct_ = NAN;
+  for (uint8_t i = 0; i <= 100; i++) { rpm_sum_[i] = 0; rpm_n_[i] = 0; }
+
+  // sweep in raw (uncalibrated) units
+  prev_ = m.throttleCal();
+  m.setThrottleCal(ThrCalData{});
+  m.setTargetThrottlePct(max_pct_, 100.0f / THRCAL_SWEEP_PCT_PER_S, RAMP_LINEAR);
+
+  state_ = SWEEP;
+  return true;
+}
+
+void ThrottleCal::abort(EscGroup& g) {
+  if (!active()) return;
+  // throttle is handled by the caller (soft stop / ESTOP)
+  if (motor_ < g.count()) g.motor(motor_).setThrottleCal(prev_);
+  err_ = "ABORT";
+  state_ = IDLE;
+}
+
+ThrottleCal::State ThrottleCal::takeResult() {
+  const State s = state_;
+  if (s == DONE || s == FAIL) state_ = IDLE;
+  return s;
+}
+
+void ThrottleCal::fail_(EscGroup& g, const char* why) {
+  EscBdshot& m = g.motor(motor_);
+  m.setTargetThrottlePct(0.0f, 100.0f / THRCAL_SWEEP_PCT_PER_S / 5.0f, RAMP_LINEAR);
+  m.setThrottleCal(prev_);
+  err_ = why;
+  state_ = FAIL;
+}
+
+float ThrottleCal::bucketRpm_(const uint32_t* sum, const uint16_t* n, float raw_pct) {
+  // bucket i holds samples with raw throttle in [i, i+1) -> centre i+0.5
+  const float x = raw_pct - 0.5f;
+  int i0 = (int)floorf(x);
+  if (i0 < 0) i0 = 0;
+  if (i0 > 100) i0 = 100;
+  const int i1 = (i0 < 100) ? i0 + 1 : 100;
+
+  const bool v0 = n[i0] > 0;
+  const bool v1 = n[i1] > 0;
+  const float r0 = v0 ? (float)sum[i0] / (float)n[i0] : 0.0f;
+  const float r1 = v1 ? (float)sum[i1] / (float)n[i1] : 0.0f;
+  if (v0 && v1) {
+    float f = x - (float)i0;
+    if (f < 0.0f) f = 0.0f;
+    if (f > 1.0f) f = 1.0f;
+    return r0 + (r1 - r0) * f;
+  }
+  if (v0) return r0;
+  if (v1) return r1;
+  return 0.0f;
+}
+
+void ThrottleCal::finish_(EscBdshot& m) {
+  const float s = spin_pct_;
+
+  ThrCalData tc;
+  tc.valid = true;
+  tc.start_dshot = (uint16_t)lrintf(s / 100.0f * (float)DSHOT_MAX);
+
+  // expected RPM on the calibrated 5 % grid, up to the swept maximum
+  tc.rpm_at[0] = 0;
+  for (uint8_t k = 1; k < ThrCalData::RPM_PTS; k++) {
+    const float cal_pct = 5.0f * (float)k;
+    const float raw_pct = s + cal_pct / 100.0f * (100.0f - s);
+    if (raw_pct > max_pct_ + 0.5f) { tc.rpm_at[k] = 0; continue; }
+    float r = bucketRpm_(rpm_sum_, rpm_n_, raw_pct);
+    if (r > 65535.0f) r = 65535.0f;
+    tc.rpm_at[k] = (uint16_t)lrintf(r);
+  }
+
+  res_ = tc;
+  m.setTargetThrottlePct(0.0f, 100.0f / THRCAL_SWEEP_PCT_PER_S / 5.0f, RAMP_LINEAR);
+  state_ = RAMPDOWN;
+}
+
+void ThrottleCal::tick(EscGroup& g) {
+  if (!active()) return;
+  if (motor_ >= g.count()) { state_ = FAIL; err_ = "ESCS"; return; }
+
+  EscBdshot& m = g.motor(motor_);
+  if (m.isFailsafe()) { fail_(g, "FAILSAFE"); return; }
+
+  const float pct = m.currentThrottlePct();
+
+  if (state_ == RAMPDOWN) {
+    if (pct <= 0.0f) {
+      m.setThrottleCal(res_);
+      state_ = DONE;
+    }
+    return;
+  }
+
+  const float rpm = m.rpmFiltered();
+  const uint32_t now = ms_now();
+
+  if (!spun_) {
+    if (rpm >= (float)THRCAL_SPIN_RPM) {
+      if (!isfinite(spin_cand_pct_)) {
+        spin_cand_pct_ = pct;   // first crossing = spin-up point
+        spin_t0_ms_ = now;
+      } else if ((uint32_t)(now - spin_t0_ms_) >= THRCAL_SPIN_HOLD_MS) {
+        spun_ = true;
+        spin_pct_ = spin_cand_pct_;
+      }
+    } else {
+      spin_cand_pct_ = NAN;
+    }
+  }
+
+  if (spun_) {
+    const int b = (int)pct;
+    if (b >= 0 && b <= 100 && rpm_n_[b] < 0xFFFF) {
+      rpm_sum_[b] += (uint32_t)lrintf(rpm);
+      rpm_n_[b]++;
+    }
+  }
+
+  if (pct >= max_pct_ - 0.01f) {
+    if (spun_) finish_(m);
+    else fail_(g, "NO_SPINUP");
+  }
+}
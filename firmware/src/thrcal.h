@@ -0,0 +1,49 @@
+#pragma once
+#include <Arduino.h>
+#include "esc_group.h"
+
+// THRCAL: slow open-loop sweep of one ESC (raw linear mapping) that finds the
+// spin-up throttle from eRPM and records RPM along the way. The result becomes
+// the ESC's throttle LUT: 0 % = stop, >0 % starts at spin-up, 100 % = full.
+// Non-blocking, serviced from the main loop.
+class ThrottleCal {
+public:
+  enum State : uint8_t { IDLE = 0, SWEEP = 1, RAMPDOWN = 2, DONE = 3, FAIL = 4 };
+
+  bool start(EscGroup& g, uint8_t motor, float max_pct);
+  void abort(EscGroup& g);
+  void tick(EscGroup& g);
+
+  bool active() const { return state_ == SWEEP || state_ == RAMPDOWN; }
+  // DONE/FAIL are reported once; returns the state and moves to IDLE
+  State takeResult();
+
+  uint8_t motor() const { return motor_; }
+  float spinPct() const { return spin_pct_; }
+  const char* error() const { return err_; }
+  const ThrCalData& result() const { return res_; }
+
+private:
+  void finish_(EscBdshot& m);
+  static float bucketRpm_(const uint32_t* sum, const uint16_t* n, float raw_pct);
+  void fail_(EscGroup& g, const char* why);
+
+private:
+  State state_ = IDLE;
+  uint8_t motor_ = 0;
+  float max_pct_ = 100.0f;
+  const char* err_ = "";
+
+  // spin-up detection
+  bool spun_ = false;
+  uint32_t spin_t0_ms_ = 0;
+  float spin_cand_pct_ = NAN;
+  float spin_pct_ = NAN;
+
+  // RPM per raw 1 % bucket
+  uint32_t rpm_sum_[101]{};
+  uint16_t rpm_n_[101]{};
+
+  ThrCalData prev_;   // restored on abort/failure
+  ThrCalData res_;   // applied once the motor is back at 0 (no LUT jump while spinning)
+};
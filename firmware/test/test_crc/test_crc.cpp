@@ -0,0 +1,64 @@
+// pio test -e native -f test_crc
+// slice-by-4 table CRC against a bitwise reference: random lengths, alignments, chaining
+#include <unity.h>
+#include <stdlib.h>
+#include "crc.h"
+
+static uint32_t crcBitwise(const uint8_t* p, size_t len, uint32_t crc = 0) {
+  crc = ~crc;
+  while (len--) {
+    crc ^= *p++;
+    for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320UL & (0u - (crc & 1u)));
+  }
+  return ~crc;
+}
+
+static uint8_t buf[4096 + 8];
+
+void setUp() {
+  srand(12345);
+  for (size_t i = 0; i < sizeof(buf); i++) buf[i] = (uint8_t)rand();
+}
+
+void tearDown() {}
+
+static void test_check_value() {
+  TEST_ASSERT_EQUAL_HEX32(0xCBF43926UL, crc32IeeeTable("123456789", 9));
+  TEST_ASSERT_EQUAL_HEX32(0xCBF43926UL, crc32Ieee("123456789", 9));
+  TEST_ASSERT_EQUAL_HEX32(0, crc32IeeeTable(buf, 0));
+}
+
+static void test_table_matches_bitwise() {
+  for (int n = 0; n < 2000; n++) {
+    const size_t off = (size_t)(rand() % 8);
+    const size_t len = (n < 64) ? (size_t)n : (size_t)(rand() % 4096);
+    const uint32_t ref = crcBitwise(buf + off, len);
+    TEST_ASSERT_EQUAL_HEX32(ref, crc32IeeeTable(buf + off, len));
+    TEST_ASSERT_EQUAL_HEX32(ref, crc32Ieee(buf + off, len));
+  }
+}
+
+static void test_chaining() {
+  for (int n = 0; n < 500; n++) {
+    const size_t off = (size_t)(rand() % 8);
+    const size_t len = (size_t)(rand() % 4096);
+    const size_t cut = len ? (size_t)rand() % len : 0;
+    const uint32_t ref = crcBitwise(buf + off, len);
+    TEST_ASSERT_EQUAL_HEX32(ref, crc32IeeeTable(buf + off + cut, len - cut, crc32IeeeTable(buf + off, cut)));
+    TEST_ASSERT_EQUAL_HEX32(ref, crcBitwise(buf + off + cut, len - cut, crcBitwise(buf + off, cut)));
+  }
+}
+
+static void test_self_test() {
+  TEST_ASSERT_TRUE(crcSelfTest());
+  TEST_ASSERT_TRUE(crcSelfTestPassed());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_check_value);
+  RUN_TEST(test_table_matches_bitwise);
+  RUN_TEST(test_chaining);
+  RUN_TEST(test_self_test);
+  return UNITY_END();
+}
@@ -0,0 +1,82 @@
+// pio test -e native -f test_preset
+// PRESET vs THRCAL slots across a reboot: each boot is a fresh EscGroup / Meta / CLI set up in
+// main.cpp's order. The store is one instance per process; with its queue flushed its index is
+// what the next boot would read back from flash.
+#include <unity.h>
+#include "cli.h"
+#include "esc_group.h"
+#include "meta.h"
+#include "kvstore.h"
+#include "textbuf.h"
+
+struct Boot {
+  EscGroup escs;
+  Meta meta;
+  CLI cli;
+
+  Boot() {
+    escs.begin(PIN_DSHOT_LIST, ESC_COUNT_DEFAULT, DSHOT_SPEED);
+    escs.setPolePairs(meta.pole_pairs);
+    cli.begin();
+    cli.bind(&escs, nullptr, nullptr, &meta, nullptr, nullptr, nullptr, nullptr);
+    cli.restorePreset();
+  }
+
+  void cmd(const char* s) {
+    char line[96];
+    textCopy(line, s);
+    cli.handleLine(line);
+  }
+
+  uint16_t calStart() const { return escs.motor(0).throttleCal().start_dshot; }
+
+  void setCal(uint16_t start_dshot) {
+    ThrCalData tc;
+    tc.valid = true;
+    tc.start_dshot = start_dshot;
+    for (uint8_t k = 0; k < ThrCalData::RPM_PTS; k++) tc.rpm_at[k] = (uint16_t)(1000u * k);
+    escs.motor(0).setThrottleCal(tc);
+  }
+};
+
+static void flush() {
+  while (kvStore().pending()) kvStore().service(true);
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_thrcal_saved_after_preset_survives_reboot() {
+  {
+    Boot b;
+    b.cmd("preset save p1");            // no calibration yet
+    b.setCal(120);
+    b.cmd("thrcal save 1");
+    flush();
+  }
+  Boot b;
+  TEST_ASSERT_TRUE(b.escs.motor(0).throttleCal().valid);
+  TEST_ASSERT_EQUAL(120, b.calStart());
+}
+
+static void test_preset_load_survives_reboot() {
+  {
+    Boot b;
+    b.setCal(150);
+    b.cmd("preset save p2");
+    b.setCal(90);
+    b.cmd("thrcal save 1");
+    b.cmd("preset load p2");            // back to the preset's 150
+    TEST_ASSERT_EQUAL(150, b.calStart());
+    flush();
+  }
+  Boot b;
+  TEST_ASSERT_EQUAL(150, b.calStart());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_thrcal_saved_after_preset_survives_reboot);
+  RUN_TEST(test_preset_load_survives_reboot);
+  return UNITY_END();
+}